@@ -31,7 +31,17 @@
 #define ANALYZE_H
 
 #include <regex.h>
+#include <stdbool.h>
+
+#include "policy.h"
 
 int subc_exec_analyze (int argc, char *argv[]);
 
+void analyze_print_report (const char *convention, bool strict, const char *location, 
+                           bool changed_since, unsigned long matches, unsigned long non_matches);
+
+void analyze_print_policy_report (const struct Policy *policies, int n_policies, 
+                                  unsigned long non_policy_entries, const char *policy_path,
+                                  const char *location, bool changed_since);
+
 #endif // ANALYZE_H
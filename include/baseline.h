@@ -0,0 +1,67 @@
+/**********************************************************************************************
+*
+*   baseline - Saved sets of violations, suppressed by later scans.
+*
+*   LICENSE: zlib/libpng 
+*
+*   Copyright (c) 2024-2025 Josh Hayden (@BlinkDynamo)
+*
+*   This software is provided ‘as-is’, without any express or implied
+*   warranty. In no event will the authors be held liable for any damages
+*   arising from the use of this software.
+*
+*   Permission is granted to anyone to use this software for any purpose,
+*   including commercial applications, and to alter it and redistribute it
+*   freely, subject to the following restrictions:
+*
+*   1. The origin of this software must not be misrepresented; you must not
+*   claim that you wrote the original software. If you use this software
+*   in a product, an acknowledgment in the product documentation would be
+*   appreciated but is not required.
+*
+*   2. Altered source versions must be plainly marked as such, and must not be
+*   misrepresented as being the original software.
+*
+*   3. This notice may not be removed or altered from any source
+*   distribution. 
+*
+*********************************************************************************************/
+
+#ifndef BASELINE_H
+#define BASELINE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// A baseline file is BASELINE_MAGIC, the number of hashes as a uint64_t, then the sorted and
+// unique 64-bit hashes of the relative paths of every violation, in host byte order.
+#define BASELINE_MAGIC      "NCSBASE1"
+#define BASELINE_MAGIC_LEN  8
+
+// A baseline mapped into memory by baseline_load().
+struct Baseline {
+    void *map;
+    size_t map_size;
+    const uint64_t *hashes;
+    size_t n_hashes;
+};
+
+// The hashes of a baseline being recorded by a scan.
+struct BaselineWriter {
+    uint64_t *hashes;
+    size_t n_hashes;
+    size_t capacity;
+};
+
+bool baseline_load (struct Baseline *baseline, const char *path);
+
+bool baseline_contains (const struct Baseline *baseline, uint64_t hash);
+
+void baseline_unload (struct Baseline *baseline);
+
+void baseline_add (struct BaselineWriter *writer, uint64_t hash);
+
+bool baseline_write (struct BaselineWriter *writer, const char *path);
+
+#endif // BASELINE_H
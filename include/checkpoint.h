@@ -0,0 +1,84 @@
+/**********************************************************************************************
+*
+*   checkpoint - Saving the frontier of a scan, so that an interrupted scan can be resumed.
+*
+*   LICENSE: zlib/libpng 
+*
+*   Copyright (c) 2024-2025 Josh Hayden (@BlinkDynamo)
+*
+*   This software is provided ‘as-is’, without any express or implied
+*   warranty. In no event will the authors be held liable for any damages
+*   arising from the use of this software.
+*
+*   Permission is granted to anyone to use this software for any purpose,
+*   including commercial applications, and to alter it and redistribute it
+*   freely, subject to the following restrictions:
+*
+*   1. The origin of this software must not be misrepresented; you must not
+*   claim that you wrote the original software. If you use this software
+*   in a product, an acknowledgment in the product documentation would be
+*   appreciated but is not required.
+*
+*   2. Altered source versions must be plainly marked as such, and must not be
+*   misrepresented as being the original software.
+*
+*   3. This notice may not be removed or altered from any source
+*   distribution. 
+*
+*********************************************************************************************/
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <sys/types.h>
+
+#include "policy.h"
+#include "traverse.h"
+
+// The first line of every checkpoint file.
+#define CHECKPOINT_MAGIC "nc-scout-checkpoint 1"
+
+#define CHECKPOINT_DEFAULT_INTERVAL 60.0
+
+// A "key value" line of a checkpoint file.
+struct CheckpointField {
+    char *key;
+    char *value;
+};
+
+// A checkpoint file read by checkpoint_read().
+struct Checkpoint {
+    const char *path;
+    struct CheckpointField *fields;
+    int n_fields;
+    struct TraversePending *pending;
+    size_t n_pending;
+};
+
+bool checkpoint_start (const char *path, double interval_seconds, 
+                       void (*write_state)(FILE *file));
+
+void checkpoint_frontier (const struct TraversePending *pending, size_t n_pending);
+
+void checkpoint_finish (bool completed);
+
+bool checkpoint_read (struct Checkpoint *checkpoint, const char *path);
+
+const char *checkpoint_get (const struct Checkpoint *checkpoint, const char *key);
+
+bool checkpoint_expect (const struct Checkpoint *checkpoint, const char *key, const char *value);
+
+void checkpoint_save_counters (FILE *file, const struct PolicyTable *table, unsigned long matches,
+                               unsigned long non_matches, unsigned long non_policy_entries);
+
+bool checkpoint_restore_counters (const struct Checkpoint *checkpoint, struct PolicyTable *table,
+                                  unsigned long *matches, unsigned long *non_matches,
+                                  unsigned long *non_policy_entries);
+
+bool checkpoint_save_output (FILE *file, FILE *output);
+
+bool checkpoint_restore_output (const struct Checkpoint *checkpoint, FILE *output);
+
+#endif // CHECKPOINT_H
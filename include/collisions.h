@@ -0,0 +1,35 @@
+/**********************************************************************************************
+*
+*   collisions - nc-scout collisions handling, operation, and output.
+*
+*   LICENSE: zlib/libpng 
+*
+*   Copyright (c) 2024-2025 Josh Hayden (@BlinkDynamo)
+*
+*   This software is provided ‘as-is’, without any express or implied
+*   warranty. In no event will the authors be held liable for any damages
+*   arising from the use of this software.
+*
+*   Permission is granted to anyone to use this software for any purpose,
+*   including commercial applications, and to alter it and redistribute it
+*   freely, subject to the following restrictions:
+*
+*   1. The origin of this software must not be misrepresented; you must not
+*   claim that you wrote the original software. If you use this software
+*   in a product, an acknowledgment in the product documentation would be
+*   appreciated but is not required.
+*
+*   2. Altered source versions must be plainly marked as such, and must not be
+*   misrepresented as being the original software.
+*
+*   3. This notice may not be removed or altered from any source
+*   distribution. 
+*
+*********************************************************************************************/
+
+#ifndef COLLISIONS_H
+#define COLLISIONS_H
+
+int subc_exec_collisions (int argc, char *argv[]);
+
+#endif // COLLISIONS_H
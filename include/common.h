@@ -30,8 +30,21 @@
 #ifndef COMMON_H
 #define COMMON_H
 
+#include <stddef.h>
+#include <stdint.h>
+
 const char *get_relative_path (const char *abs_initial_path, const char *abs_current_path);
 
-double percentage(int num_a, int num_b);
+double percentage(unsigned long num_a, unsigned long num_b);
+
+uint64_t hash_string (const char *str);
+
+uint64_t random_next (uint64_t *state);
+
+void out_of_memory (void);
+
+void *xrealloc (void *ptr, size_t size);
+
+void *xcalloc (size_t n, size_t size);
 
 #endif // COMMON_H
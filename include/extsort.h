@@ -0,0 +1,68 @@
+/**********************************************************************************************
+*
+*   extsort - Sorting lines within a memory budget, spilling sorted runs to temporary files.
+*
+*   LICENSE: zlib/libpng 
+*
+*   Copyright (c) 2024-2025 Josh Hayden (@BlinkDynamo)
+*
+*   This software is provided ‘as-is’, without any express or implied
+*   warranty. In no event will the authors be held liable for any damages
+*   arising from the use of this software.
+*
+*   Permission is granted to anyone to use this software for any purpose,
+*   including commercial applications, and to alter it and redistribute it
+*   freely, subject to the following restrictions:
+*
+*   1. The origin of this software must not be misrepresented; you must not
+*   claim that you wrote the original software. If you use this software
+*   in a product, an acknowledgment in the product documentation would be
+*   appreciated but is not required.
+*
+*   2. Altered source versions must be plainly marked as such, and must not be
+*   misrepresented as being the original software.
+*
+*   3. This notice may not be removed or altered from any source
+*   distribution. 
+*
+*********************************************************************************************/
+
+#ifndef EXTSORT_H
+#define EXTSORT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+// The memory --sort may use before spilling to disk, unless --sort-memory is given.
+#define EXTSORT_DEFAULT_BUDGET  (64 * 1024 * 1024)
+
+// The most runs kept on disk at once. Reaching it merges them into one run.
+#define EXTSORT_MAX_RUNS        64
+
+// How many runs of the same level are merged into one run of the next level.
+#define EXTSORT_MERGE_WIDTH     8
+
+// Lines added in any order, written out in byte order (strcmp(), whatever the locale).
+struct ExtSort {
+    size_t budget;
+    char *bytes;                    // The lines held in memory, each ended by '\0'.
+    size_t n_bytes;
+    size_t bytes_capacity;
+    size_t *lines;                  // Offsets of the lines held in memory into bytes.
+    size_t n_lines;
+    size_t lines_capacity;
+    FILE *runs[EXTSORT_MAX_RUNS];   // Sorted temporary files, each line after its length.
+    int levels[EXTSORT_MAX_RUNS];   // How many merges the lines of each run went through.
+    int n_runs;
+};
+
+void extsort_start (struct ExtSort *sort, size_t budget);
+
+void extsort_add (struct ExtSort *sort, const char *line);
+
+bool extsort_finish (struct ExtSort *sort, FILE *out);
+
+bool extsort_merge (FILE **inputs, int n_inputs, FILE *out);
+
+#endif // EXTSORT_H
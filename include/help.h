@@ -44,6 +44,10 @@
 "Commands:\n" \
 "  search           Searches a directory for files that do not match a naming convention.\n" \
 "  analyze          Displays the percentage of files that follow a naming convention in a directory.\n" \
+"  scan             Lists the matches or non-matches of a search, followed by an analyze of them.\n" \
+"  collisions       Finds names in a directory that differ only in case or word separators.\n" \
+"  lint-identifiers Checks the names of functions, variables, types and macros in source files.\n" \
+"  merge            Combines the --partial results of the shards of a search or analyze.\n" \
 "\n" \
 "\n" \
 ""
@@ -51,6 +55,7 @@
 // The help message displayed for `nc-scout search --help`, `nc-scout search -h` exactly.
 #define HELP_SEARCH \
 "Usage: nc-scout search <OPTIONS> [CONVENTION] [LOCATION]\n" \
+"       nc-scout search <OPTIONS> --policy FILE [LOCATION]\n" \
 "\n" \
 "Searches a directory for files and directories that do not match a naming convention.\n" \
 "\n" \
@@ -60,7 +65,140 @@
 "  -n, --non-matches    Display non-matches to the convention instead of matches.\n" \
 "  -s, --strict         Enforce the naming convention strictly.\n" \
 "  -R, --recursive      Recursively search through subdirectories.\n" \
+"  -u, --unicode        Accept non-ASCII (UTF-8) letters and digits in the convention.\n" \
+"  --policy FILE        Check each entry against the convention of the policy in FILE that\n" \
+"                       applies to its extension, type and path, instead of one convention.\n" \
+"                       The name of the policy is displayed after each entry.\n" \
+"  --progress[=SECS]    Report progress and an ETA to stderr every SECS seconds (default: 1).\n" \
+"  --changed-since TIME Only display entries whose ctime is at or after TIME (seconds since\n" \
+"                       the epoch, or YYYY-MM-DD[THH:MM:SS]). Subdirectories are still searched.\n" \
+"  --type TYPES         Only display entries of TYPES: f (files), d (directories), l (symlinks),\n" \
+"                       or a list such as f,l. Subdirectories are still searched.\n" \
+"  --max-depth N        Do not search deeper than N levels below LOCATION (1: only LOCATION).\n" \
+"  --min-size SIZE      Only display regular files of at least SIZE bytes (K, M, G, T suffixes).\n" \
+"  --owner USER         Only display entries owned by USER (a name or user ID).\n" \
+"  --metrics-file FILE  Write counts and timings of the search to FILE, for the textfile\n" \
+"                       collector of the Prometheus node_exporter.\n" \
+"  --write-baseline FILE\n" \
+"                       Save the non-matches found to FILE, as hashes of their paths.\n" \
+"  --baseline FILE      Ignore non-matches saved in FILE by --write-baseline, so only new\n" \
+"                       non-matches are displayed.\n" \
+"  --check-components   Check every component of the path below LOCATION, not only the name.\n" \
+"                       Non-matches are followed by the first component that does not match.\n" \
+"  --show-owner         Display the owner of each entry after it, reading the owners of the\n" \
+"                       entries of a directory together.\n" \
+"  --sort               Display the entries sorted by their bytes, the same on every filesystem.\n" \
+"  --sort-memory SIZE   Sort up to SIZE bytes of output in memory, and the rest in temporary\n" \
+"                       files (K, M, G, T suffixes; default: 64M).\n" \
+""
+
+// The options of `nc-scout search` for large or slow trees, printed after HELP_SEARCH.
+#define HELP_SEARCH_LARGE_TREES \
+"  --max-iops N         Issue at most N filesystem operations per second.\n" \
+"  --max-dirs-per-sec N Open at most N directories per second.\n" \
+"  --inode-order        Enter subdirectories in the order of their inode numbers, which cuts\n" \
+"                       seeking on spinning disks with cold caches. Entries are displayed in\n" \
+"                       another order, but the same entries are displayed.\n" \
+"  --locate-db FILE     Read the entries from an mlocate or LOCATE02 database written by\n" \
+"                       updatedb instead of the filesystem.\n" \
+"  --pipeline           Read directories, match names and write the output on three threads\n" \
+"                       at once, so the slowest of them sets the pace instead of all three.\n" \
+"  --adaptive           Slow down while filesystem operations take much longer than usual,\n" \
+"                       and speed back up (to at most --max-iops) once they recover.\n" \
+"  --shard I/N          Only search slice I of N of the tree, split by the paths of the entries\n" \
+"                       at --shard-depth. Run each slice on its own machine or process.\n" \
+"  --shard-depth K      The depth at which --shard splits the tree (default: 1).\n" \
+"  --partial FILE       Save the output to FILE for `nc-scout merge` instead of displaying it.\n" \
+"  --checkpoint FILE    Save where the search is to FILE every --checkpoint-interval seconds,\n" \
+"                       and when interrupted. The output must be written to a file.\n" \
+"  --checkpoint-interval SECS\n" \
+"                       The time between checkpoints (default: 60).\n" \
+"  --resume FILE        Continue the search saved in the checkpoint FILE, appending to its\n" \
+"                       output (`>> FILE`) without repeating any of it.\n" \
+"\n" \
+""
+
+// The help message displayed for `nc-scout analyze --help`, `nc-scout analyze -h` exactly.
+#define HELP_ANALYZE \
+"Usage: nc-scout analyze <OPTIONS> [CONVENTION] [LOCATION]\n" \
+"       nc-scout analyze <OPTIONS> --policy FILE [LOCATION]\n" \
+"\n" \
+"Displays the percentage of files that follow a naming convention in a directory.\n" \
+"\n" \
+"<OPTIONS>:\n" \
+"  -h, --help       Show this help message.\n" \
+"  -s, --strict     Enforce the naming convention strictly.\n" \
+"  -R, --recursive  Analyze all subdirectories recursively.\n" \
+"  -u, --unicode    Accept non-ASCII (UTF-8) letters and digits in the convention.\n" \
+"  --policy FILE    Check each entry against the convention of the policy in FILE that\n" \
+"                   applies to its extension, type and path, reporting each policy.\n" \
+"  --progress[=SECS]\n" \
+"                   Report progress and an ETA to stderr every SECS seconds (default: 1).\n" \
+"  -e, --estimate   Estimate the percentage from random walks of the tree instead of reading\n" \
+"                   all of it. Implies --recursive.\n" \
+"  --seed N         Seed of the random walks of --estimate (default: time and process id).\n" \
+"  --deadline SECS  Stop --estimate after SECS seconds and report the best estimate so far.\n" \
+"  --probes N       Number of random walks of --estimate (default: 1000, or unlimited with\n" \
+"                   --deadline).\n" \
+"  --changed-since TIME\n" \
+"                   Only count entries whose ctime is at or after TIME (seconds since the\n" \
+"                   epoch, or YYYY-MM-DD[THH:MM:SS]). Subdirectories are still analyzed.\n" \
+"  --type TYPES     Only count entries of TYPES: f (files), d (directories), l (symlinks, with\n" \
+"                   --policy), or a list such as f,d. Subdirectories are still analyzed.\n" \
+"  --max-depth N    Do not analyze deeper than N levels below LOCATION (1: only LOCATION).\n" \
+"  --min-size SIZE  Only count regular files of at least SIZE bytes (K, M, G, T suffixes).\n" \
+"  --owner USER     Only count entries owned by USER (a name or user ID).\n" \
+"  --metrics-file FILE\n" \
+"                   Write counts and timings of the analyze to FILE, for the textfile\n" \
+"                   collector of the Prometheus node_exporter.\n" \
+"  --max-iops N     Issue at most N filesystem operations per second.\n" \
+"  --max-dirs-per-sec N\n" \
+"                   Open at most N directories per second.\n" \
+"  --inode-order    Enter subdirectories in the order of their inode numbers, which cuts\n" \
+"                   seeking on spinning disks with cold caches.\n" \
+"  --by-owner       Also report the non-matches of each owner, reading the owners of the\n" \
+"                   non-matches of a directory together.\n" \
+"  --locate-db FILE Read the entries from an mlocate or LOCATE02 database written by\n" \
+"                   updatedb instead of the filesystem.\n" \
+"  --adaptive       Slow down while filesystem operations take much longer than usual, and\n" \
+"                   speed back up (to at most --max-iops) once they recover.\n" \
+"  --stats-detail[=K]\n" \
+"                   Also report name lengths, depths, matches per extension, and the K\n" \
+"                   directories with the most non-matches (default: 10).\n" \
+"  --shard I/N      Only analyze slice I of N of the tree, split by the paths of the entries\n" \
+"                   at --shard-depth. Run each slice on its own machine or process.\n" \
+"  --shard-depth K  The depth at which --shard splits the tree (default: 1).\n" \
+"  --partial FILE   Save the counts to FILE for `nc-scout merge` instead of reporting them.\n" \
+"  --checkpoint FILE\n" \
+"                   Save where the analyze is to FILE every --checkpoint-interval seconds,\n" \
+"                   and when interrupted.\n" \
+"  --checkpoint-interval SECS\n" \
+"                   The time between checkpoints (default: 60).\n" \
+"  --resume FILE    Continue the analyze saved in the checkpoint FILE.\n" \
+"\n" \
+""
+
+// The help message displayed for `nc-scout scan --help`, `nc-scout scan -h` exactly.
+#define HELP_SCAN \
+"Usage: nc-scout scan <OPTIONS> [CONVENTION] [LOCATION]\n" \
+"       nc-scout scan <OPTIONS> --policy FILE [LOCATION]\n" \
+"\n" \
+"Searches a directory as `nc-scout search` does, then reports the percentage of its files that\n" \
+"follow the naming convention as `nc-scout analyze` does, reading the directory only once.\n" \
+"Symlinks are listed as by `nc-scout search`, but only counted in the report with --policy,\n" \
+"as in `nc-scout analyze`.\n" \
 "\n" \
+"<OPTIONS>:\n" \
+"  The options of `nc-scout search`, except --partial, --checkpoint, --checkpoint-interval\n" \
+"  and --resume.\n" \
+"\n" \
+""
+
+// HELP_SEARCH and HELP_ANALYZE are printed in pieces, as they would otherwise be longer than the
+// 4095 characters C99 compilers must support in a string literal.
+
+// Printed after the options of HELP_SEARCH and HELP_ANALYZE.
+#define HELP_CONVENTION_LOCATION \
 "[CONVENTION]:\n" \
 "  flatcase         examplefilename.txt\n" \
 "  camelcase        exampleFileName.txt\n" \
@@ -75,10 +213,18 @@
 "  ~/Documents/     Variable paths to directories.\n" \
 "  ../Homework/     Relative paths to directories.\n" \
 "\n" \
+""
+
+// Printed after HELP_CONVENTION_LOCATION by `nc-scout search --help`.
+#define HELP_SEARCH_LOCATION_NOTE \
 "  It should be noted that a search will only be done on contents within a specified location.\n" \
 "  A command such as `nc-scout search -m pascalcase ~/Documents/` would not output 'Documents',\n" \
 "  even though 'Documents' is a pascalcase match.\n" \
 "\n" \
+""
+
+// Printed last by `nc-scout search --help` and `nc-scout analyze --help`.
+#define HELP_STRICT_LENIENT \
 "Strict vs. Lenient:\n" \
 "  The default enforcement of naming conventions for a search is lenient, although, using\n" \
 "  the -s or --strict option, you can strictly enforce the naming convention for that search.\n" \
@@ -100,49 +246,80 @@
 "\n" \
 ""
 
-// The help message displayed for `nc-scout analyze --help`, `nc-scout analyze -h` exactly.
-#define HELP_ANALYZE \
-"Usage: nc-scout analyze <OPTIONS> [CONVENTION] [LOCATION]\n" \
+// The help message displayed for `nc-scout collisions --help`, `nc-scout collisions -h` exactly.
+#define HELP_COLLISIONS \
+"Usage: nc-scout collisions <OPTIONS> [LOCATION]\n" \
 "\n" \
-"Displays the percentage of files that follow a naming convention in a directory.\n" \
+"Finds files and directories that share a directory and differ only in case or word separators,\n" \
+"such as 'fooBar.txt', 'FooBar.txt', and 'foo_bar.TXT'. Each group of colliding names is\n" \
+"printed on one line, separated by tabs.\n" \
 "\n" \
 "<OPTIONS>:\n" \
-"  -h, --help       Show this help message.\n" \
-"  -s, --strict     Enforce the naming convention strictly.\n" \
-"  -R, --recursive  Analyze all subdirectories recursively.\n" \
-"\n" \
-"[CONVENTION]:\n" \
-"  flatcase         examplefilename.txt\n" \
-"  camelcase        exampleFileName.txt\n" \
-"  pascalcase       ExampleFileName.txt\n" \
-"  snakecase        example_file_name.txt\n" \
-"  constantcase     EXAMPLE_FILE_NAME.txt\n" \
-"  kebabcase        example-file-name.txt\n" \
-"  cobolcase        EXAMPLE-FILE-NAME.txt\n" \
+"  -h, --help           Show this help message.\n" \
+"  -f, --full-path      Display the colliding files/directories as full-paths.\n" \
+"  -R, --recursive      Recursively search the directory.\n" \
 "\n" \
 "[LOCATION]:\n" \
 "  /var/lib/        Absolute paths to directories.\n" \
 "  ~/Documents/     Variable paths to directories.\n" \
 "  ../Homework/     Relative paths to directories.\n" \
 "\n" \
-"Strict vs. Lenient:\n" \
-"  The default enforcement of naming conventions for a search is lenient, although, using\n" \
-"  the -s or --strict option, you can strictly enforce the naming convention for that search.\n" \
+""
+
+// The help message displayed for `nc-scout merge --help`, `nc-scout merge -h` exactly.
+#define HELP_MERGE \
+"Usage: nc-scout merge <OPTIONS> [FILE]...\n" \
 "\n" \
-"  Strict enforcement means that the naming convention MUST be present in it's entirety, while\n" \
-"  lenient enforcement means that the naming convention COULD be present in it's entirety if more\n" \
-"  text is added, but not removed or changed.\n" \
+"Combines the files saved by `--shard I/N --partial FILE` for every slice of a search or analyze,\n" \
+"displaying what the search or analyze would have without --shard. Every slice from 1 to N\n" \
+"must be given exactly once, in any order.\n" \
 "\n" \
-"  Example:\n" \
-"    example.txt\n" \
+"<OPTIONS>:\n" \
+"  -h, --help       Show this help message.\n" \
 "\n" \
-"    Matches strictly:\n" \
-"      flatcase - Exactly matches the convention in it's entirety\n" \
+"Example:\n" \
+"  nc-scout analyze -R --shard 1/2 --partial a.part snakecase /srv/\n" \
+"  nc-scout analyze -R --shard 2/2 --partial b.part snakecase /srv/\n" \
+"  nc-scout merge a.part b.part\n" \
 "\n" \
-"    Matches leniently:\n" \
-"      kebabcase - Could be extended to example-file.txt to match the convention in it's entirety\n" \
-"      snakecase - Could be extended to example_file.txt to match the convention in it's entirety\n" \
-"      camelcase - Could be extended to exampleFile.txt to match the convention in it's entirety\n" \
+""
+
+// The help message displayed for `nc-scout lint-identifiers --help`, `nc-scout lint-identifiers -h`.
+#define HELP_LINT_IDENTIFIERS \
+"Usage: nc-scout lint-identifiers <OPTIONS> [CONVENTION] [LOCATION]\n" \
+"\n" \
+"Checks the identifiers declared in the C (.c, .h), Python (.py) and shell (.sh, .bash) files\n" \
+"of a directory against a naming convention, displaying every identifier that does not match\n" \
+"as 'path:line: kind identifier', followed by a report per kind of identifier. Leading and\n" \
+"trailing underscores are ignored.\n" \
+"\n" \
+"<OPTIONS>:\n" \
+"  -h, --help           Show this help message.\n" \
+"  -f, --full-path      Display the files as full-paths.\n" \
+"  -s, --strict         Enforce the naming conventions strictly.\n" \
+"  -R, --recursive      Recursively lint the files of subdirectories.\n" \
+"  -u, --unicode        Accept non-ASCII (UTF-8) letters and digits in the conventions.\n" \
+"  -q, --quiet          Only display the report.\n" \
+"  -j, --jobs N         Lint N files at a time (default: the number of processors).\n" \
+"  --functions CONV     The convention of functions, instead of CONVENTION.\n" \
+"  --variables CONV     The convention of variables and parameters, instead of CONVENTION.\n" \
+"  --types CONV         The convention of structs, unions, enums, typedefs and classes,\n" \
+"                       instead of CONVENTION.\n" \
+"  --macros CONV        The convention of C macros, instead of CONVENTION.\n" \
+"\n" \
+"[CONVENTION]:\n" \
+"  flatcase         examplefilename\n" \
+"  camelcase        exampleFileName\n" \
+"  pascalcase       ExampleFileName\n" \
+"  snakecase        example_file_name\n" \
+"  constantcase     EXAMPLE_FILE_NAME\n" \
+"  kebabcase        example-file-name\n" \
+"  cobolcase        EXAMPLE-FILE-NAME\n" \
+"\n" \
+"[LOCATION]:\n" \
+"  /var/lib/        Absolute paths to directories.\n" \
+"  ~/Documents/     Variable paths to directories.\n" \
+"  ../Homework/     Relative paths to directories.\n" \
 "\n" \
 ""
 
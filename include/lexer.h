@@ -0,0 +1,60 @@
+/**********************************************************************************************
+*
+*   lexer - Extraction and classification of the identifiers declared in source files.
+*
+*   LICENSE: zlib/libpng 
+*
+*   Copyright (c) 2024-2025 Josh Hayden (@BlinkDynamo)
+*
+*   This software is provided ‘as-is’, without any express or implied
+*   warranty. In no event will the authors be held liable for any damages
+*   arising from the use of this software.
+*
+*   Permission is granted to anyone to use this software for any purpose,
+*   including commercial applications, and to alter it and redistribute it
+*   freely, subject to the following restrictions:
+*
+*   1. The origin of this software must not be misrepresented; you must not
+*   claim that you wrote the original software. If you use this software
+*   in a product, an acknowledgment in the product documentation would be
+*   appreciated but is not required.
+*
+*   2. Altered source versions must be plainly marked as such, and must not be
+*   misrepresented as being the original software.
+*
+*   3. This notice may not be removed or altered from any source
+*   distribution. 
+*
+*********************************************************************************************/
+
+#ifndef LEXER_H
+#define LEXER_H
+
+#include <stddef.h>
+
+// The kinds of identifiers that are reported.
+enum IdentifierKind {
+    IDENTIFIER_FUNCTION,
+    IDENTIFIER_VARIABLE,
+    IDENTIFIER_TYPE,
+    IDENTIFIER_MACRO,
+    N_IDENTIFIER_KINDS
+};
+
+enum Language {
+    LANGUAGE_NONE,
+    LANGUAGE_C,
+    LANGUAGE_PYTHON,
+    LANGUAGE_SHELL
+};
+
+enum Language lexer_language (const char *filename);
+
+const char *lexer_kind_name (enum IdentifierKind kind);
+
+void lexer_scan (enum Language language, const char *text, size_t len,
+                 void (*found)(const char *identifier, size_t len, enum IdentifierKind kind,
+                               unsigned long line, void *context),
+                 void *context);
+
+#endif // LEXER_H
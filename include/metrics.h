@@ -0,0 +1,67 @@
+/**********************************************************************************************
+*
+*   metrics - Metrics of a scan, written as a Prometheus textfile.
+*
+*   LICENSE: zlib/libpng 
+*
+*   Copyright (c) 2024-2025 Josh Hayden (@BlinkDynamo)
+*
+*   This software is provided ‘as-is’, without any express or implied
+*   warranty. In no event will the authors be held liable for any damages
+*   arising from the use of this software.
+*
+*   Permission is granted to anyone to use this software for any purpose,
+*   including commercial applications, and to alter it and redistribute it
+*   freely, subject to the following restrictions:
+*
+*   1. The origin of this software must not be misrepresented; you must not
+*   claim that you wrote the original software. If you use this software
+*   in a product, an acknowledgment in the product documentation would be
+*   appreciated but is not required.
+*
+*   2. Altered source versions must be plainly marked as such, and must not be
+*   misrepresented as being the original software.
+*
+*   3. This notice may not be removed or altered from any source
+*   distribution. 
+*
+*********************************************************************************************/
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// The phases of a traversal that are timed while metrics are enabled.
+enum MetricsPhase {
+    METRICS_PHASE_OPEN,             // Opening directories.
+    METRICS_PHASE_READ,             // Reading their entries.
+    METRICS_PHASE_STAT,             // Reading the metadata of directories and entries.
+    METRICS_PHASE_VISIT,            // Checking the entries against the conventions.
+    N_METRICS_PHASES
+};
+
+extern bool metrics_enabled;
+extern uint64_t metrics_phase_ns[N_METRICS_PHASES];
+
+uint64_t metrics_clock (void);
+
+// Times a phase, as `uint64_t started = METRICS_START(); ...; METRICS_STOP(phase, started);`.
+// Without metrics, this is a test of metrics_enabled and no clock is read.
+#define METRICS_START() ((metrics_enabled) ? metrics_clock() : 0)
+#define METRICS_STOP(phase, started) \
+    do { \
+        if (metrics_enabled) { \
+            metrics_phase_ns[phase] += metrics_clock() - (started); \
+        } \
+    } while (0)
+
+void metrics_start (void);
+
+void metrics_add_result (const char *convention, const char *policy, unsigned long matches, 
+                         unsigned long violations);
+
+bool metrics_write (const char *path, const char *command, const char *location);
+
+#endif // METRICS_H
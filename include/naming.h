@@ -31,12 +31,32 @@
 #define NAMING_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <regex.h>
 
+// A convention prepared by naming_compile_rule().
+struct NamingRule {
+    regex_t regex;      // Only compiled when unicode is false.
+    int convention;
+    bool strict;
+    bool unicode;
+};
+
 bool naming_set_expression (const char *arg_naming_convention, const char **ptr_search_expression, bool strict_flag);
 
 bool naming_compile_regex (regex_t *regex, const char *search_expression);
 
 bool naming_match_regex (regex_t regex, const char *filename);
 
+const char *naming_get_convention_name (int index);
+
+bool naming_match_native (int convention_index, bool strict, bool unicode, const char *filename);
+
+bool naming_compile_rule (struct NamingRule *rule, const char *arg_naming_convention, 
+                          bool strict_flag, bool unicode_flag);
+
+bool naming_match_rule (const struct NamingRule *rule, const char *filename);
+
+size_t naming_normalize (const char *filename, char *buf, size_t size);
+
 #endif // NAMING_H
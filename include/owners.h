@@ -0,0 +1,83 @@
+/**********************************************************************************************
+*
+*   owners - Reading the owners of entries a directory at a time, and counting them by owner.
+*
+*   LICENSE: zlib/libpng 
+*
+*   Copyright (c) 2024-2025 Josh Hayden (@BlinkDynamo)
+*
+*   This software is provided ‘as-is’, without any express or implied
+*   warranty. In no event will the authors be held liable for any damages
+*   arising from the use of this software.
+*
+*   Permission is granted to anyone to use this software for any purpose,
+*   including commercial applications, and to alter it and redistribute it
+*   freely, subject to the following restrictions:
+*
+*   1. The origin of this software must not be misrepresented; you must not
+*   claim that you wrote the original software. If you use this software
+*   in a product, an acknowledgment in the product documentation would be
+*   appreciated but is not required.
+*
+*   2. Altered source versions must be plainly marked as such, and must not be
+*   misrepresented as being the original software.
+*
+*   3. This notice may not be removed or altered from any source
+*   distribution. 
+*
+*********************************************************************************************/
+
+#ifndef OWNERS_H
+#define OWNERS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <sys/types.h>
+
+#include "traverse.h"
+
+// An entry of the directory being read whose owner is wanted.
+struct OwnerRequest {
+    const char *name;               // Valid until the next directory is read.
+    ino_t ino;
+    char *tag;                      // A copy of the tag given with the entry, or NULL.
+    uid_t uid;
+    bool found;                     // False if the owner could not be read.
+};
+
+// The requests of one directory, answered together by owners_stat() before it is closed.
+struct OwnerBatch {
+    struct OwnerRequest *requests;
+    size_t n_requests;
+    size_t capacity;
+    size_t *order;                  // Indexes of requests, sorted by inode.
+};
+
+struct OwnerCount {
+    bool used;
+    uid_t uid;
+    unsigned long count;
+    char *name;                     // Resolved once, on first use.
+};
+
+// Open addressing table of the owners seen, keyed by uid.
+struct OwnerTable {
+    struct OwnerCount *slots;
+    size_t size;
+    size_t used;
+    unsigned long unknown;          // Entries whose owner could not be read.
+};
+
+void owners_request (struct OwnerBatch *batch, const struct TraverseEntry *entry, const char *tag);
+
+void owners_stat (struct OwnerBatch *batch, const struct TraverseDir *dir);
+
+void owners_clear (struct OwnerBatch *batch);
+
+void owners_count (struct OwnerTable *table, const struct OwnerRequest *request);
+
+const char *owners_name (struct OwnerTable *table, const struct OwnerRequest *request);
+
+void owners_print (struct OwnerTable *table, const char *what);
+
+#endif // OWNERS_H
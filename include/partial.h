@@ -0,0 +1,67 @@
+/**********************************************************************************************
+*
+*   partial - Partial results of one shard of a scan, combined by the merge subcommand.
+*
+*   LICENSE: zlib/libpng 
+*
+*   Copyright (c) 2024-2025 Josh Hayden (@BlinkDynamo)
+*
+*   This software is provided ‘as-is’, without any express or implied
+*   warranty. In no event will the authors be held liable for any damages
+*   arising from the use of this software.
+*
+*   Permission is granted to anyone to use this software for any purpose,
+*   including commercial applications, and to alter it and redistribute it
+*   freely, subject to the following restrictions:
+*
+*   1. The origin of this software must not be misrepresented; you must not
+*   claim that you wrote the original software. If you use this software
+*   in a product, an acknowledgment in the product documentation would be
+*   appreciated but is not required.
+*
+*   2. Altered source versions must be plainly marked as such, and must not be
+*   misrepresented as being the original software.
+*
+*   3. This notice may not be removed or altered from any source
+*   distribution. 
+*
+*********************************************************************************************/
+
+#ifndef PARTIAL_H
+#define PARTIAL_H
+
+#include <stdbool.h>
+#include <stdio.h>
+
+// The first line of every partial result file.
+#define PARTIAL_MAGIC "nc-scout-partial 1"
+
+// A "key value" line of the header of a partial result file.
+struct PartialField {
+    char *key;
+    char *value;
+};
+
+// A partial result file read by partial_read().
+struct Partial {
+    const char *path;
+    int shard_index;                // From 0.
+    int shard_count;
+    int shard_depth;
+    struct PartialField *fields;
+    int n_fields;
+    FILE *file;                     // Positioned after the "output" line, if the file has one.
+};
+
+FILE *partial_create (const char *path, const char *command, int shard_index, int shard_count,
+                      int shard_depth);
+
+FILE *partial_reopen (const char *path);
+
+bool partial_commit (FILE *file, const char *path);
+
+bool partial_read (struct Partial *partial, const char *path);
+
+const char *partial_get (const struct Partial *partial, const char *key);
+
+#endif // PARTIAL_H
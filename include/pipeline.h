@@ -0,0 +1,99 @@
+/**********************************************************************************************
+*
+*   pipeline - Overlapping the reading, classifying and writing of entries on three threads.
+*
+*   LICENSE: zlib/libpng 
+*
+*   Copyright (c) 2024-2025 Josh Hayden (@BlinkDynamo)
+*
+*   This software is provided ‘as-is’, without any express or implied
+*   warranty. In no event will the authors be held liable for any damages
+*   arising from the use of this software.
+*
+*   Permission is granted to anyone to use this software for any purpose,
+*   including commercial applications, and to alter it and redistribute it
+*   freely, subject to the following restrictions:
+*
+*   1. The origin of this software must not be misrepresented; you must not
+*   claim that you wrote the original software. If you use this software
+*   in a product, an acknowledgment in the product documentation would be
+*   appreciated but is not required.
+*
+*   2. Altered source versions must be plainly marked as such, and must not be
+*   misrepresented as being the original software.
+*
+*   3. This notice may not be removed or altered from any source
+*   distribution. 
+*
+*********************************************************************************************/
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <pthread.h>
+
+#include "traverse.h"
+
+// The entries and bytes of names a batch holds. A full path and a name always fit.
+#define PIPELINE_BATCH_ENTRIES  512
+#define PIPELINE_BATCH_BYTES    (64 * 1024)
+
+// The batches in flight, which is also the capacity of each ring (a power of 2). The reader
+// waits for the writer once all of them are filled.
+#define PIPELINE_BATCHES        16
+
+#define PIPELINE_CACHE_LINE     64
+
+// An entry copied out of the traversal, and the verdict of the classifier on it.
+struct PipelineEntry {
+    const char *abs_dir_path;       // In the bytes of the batch, shared by its siblings.
+    const char *name;               // In the bytes of the batch.
+    unsigned char type;
+    bool print;                     // Set by the classifier.
+    const char *tag;                // Set by the classifier, printed after the entry if set.
+};
+
+struct PipelineBatch {
+    struct PipelineEntry entries[PIPELINE_BATCH_ENTRIES];
+    size_t n_entries;
+    char bytes[PIPELINE_BATCH_BYTES];
+    size_t n_bytes;
+};
+
+// A lock-free ring of batches between one producer and one consumer. head is only written by
+// the consumer and tail only by the producer, each on its own cache line. A NULL batch marks
+// the end of the stream.
+struct PipelineRing {
+    struct PipelineBatch *slots[PIPELINE_BATCHES];
+    size_t head;
+    char head_pad[PIPELINE_CACHE_LINE - sizeof(size_t)];
+    size_t tail;
+    char tail_pad[PIPELINE_CACHE_LINE - sizeof(size_t)];
+};
+
+struct Pipeline {
+    struct PipelineRing filled;     // Reader to classifier.
+    struct PipelineRing classified; // Classifier to writer.
+    struct PipelineRing empty;      // Writer back to reader.
+    struct PipelineBatch *batches;
+    struct PipelineBatch *current;  // Being filled by the reader.
+    void (*classify)(struct PipelineBatch *batch, void *context);
+    void (*write)(const struct PipelineBatch *batch, void *context);
+    void *context;
+    pthread_t classifier;
+    pthread_t writer;
+};
+
+bool pipeline_start (struct Pipeline *pipeline, 
+                     void (*classify)(struct PipelineBatch *batch, void *context),
+                     void (*write)(const struct PipelineBatch *batch, void *context),
+                     void *context);
+
+void pipeline_visit (const struct TraverseEntry *entry, const struct TraverseDir *dir, 
+                     void *pipeline);
+
+void pipeline_finish (struct Pipeline *pipeline);
+
+#endif // PIPELINE_H
@@ -0,0 +1,82 @@
+/**********************************************************************************************
+*
+*   policy - Per-extension, per-type and per-prefix naming policies.
+*
+*   LICENSE: zlib/libpng 
+*
+*   Copyright (c) 2024-2025 Josh Hayden (@BlinkDynamo)
+*
+*   This software is provided ‘as-is’, without any express or implied
+*   warranty. In no event will the authors be held liable for any damages
+*   arising from the use of this software.
+*
+*   Permission is granted to anyone to use this software for any purpose,
+*   including commercial applications, and to alter it and redistribute it
+*   freely, subject to the following restrictions:
+*
+*   1. The origin of this software must not be misrepresented; you must not
+*   claim that you wrote the original software. If you use this software
+*   in a product, an acknowledgment in the product documentation would be
+*   appreciated but is not required.
+*
+*   2. Altered source versions must be plainly marked as such, and must not be
+*   misrepresented as being the original software.
+*
+*   3. This notice may not be removed or altered from any source
+*   distribution. 
+*
+*********************************************************************************************/
+
+#ifndef POLICY_H
+#define POLICY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "naming.h"
+
+// Entry types a policy applies to, as a bit set.
+#define POLICY_TYPE_FILE    0x1
+#define POLICY_TYPE_DIR     0x2
+#define POLICY_TYPE_SYMLINK 0x4
+
+// One line of a policy file.
+struct Policy {
+    char *name;
+    char *convention;
+    char *prefix;                   // NULL if the policy applies under any path.
+    size_t prefix_len;
+    unsigned char types;
+    struct NamingRule rule;
+    unsigned long matches;
+    unsigned long non_matches;
+};
+
+// The policies matching one key of the extension hash, in the order of the policy file.
+struct PolicyCandidates {
+    const char *extension;          // NULL for the candidates of extensions not in any policy.
+    int *indices;
+    int n_indices;
+};
+
+struct PolicyTable {
+    struct Policy *policies;
+    int n_policies;
+
+    // Perfect hash of every extension named in the policy file. Slot i holds the index into
+    // candidates of the extension hashing to i with hash_seed, or -1 if no extension does.
+    int *slots;
+    uint32_t slots_mask;
+    uint64_t hash_seed;
+    struct PolicyCandidates *candidates;
+    int n_candidates;               // The last candidate list is for all other extensions.
+};
+
+bool policy_load (struct PolicyTable *table, const char *policy_path, bool strict_flag, 
+                  bool unicode_flag);
+
+struct Policy *policy_lookup (const struct PolicyTable *table, const char *name, 
+                              unsigned char d_type, const char *relative_dir);
+
+#endif // POLICY_H
@@ -0,0 +1,58 @@
+/**********************************************************************************************
+*
+*   progress - Live progress reporting of long scans.
+*
+*   LICENSE: zlib/libpng 
+*
+*   Copyright (c) 2024-2025 Josh Hayden (@BlinkDynamo)
+*
+*   This software is provided ‘as-is’, without any express or implied
+*   warranty. In no event will the authors be held liable for any damages
+*   arising from the use of this software.
+*
+*   Permission is granted to anyone to use this software for any purpose,
+*   including commercial applications, and to alter it and redistribute it
+*   freely, subject to the following restrictions:
+*
+*   1. The origin of this software must not be misrepresented; you must not
+*   claim that you wrote the original software. If you use this software
+*   in a product, an acknowledgment in the product documentation would be
+*   appreciated but is not required.
+*
+*   2. Altered source versions must be plainly marked as such, and must not be
+*   misrepresented as being the original software.
+*
+*   3. This notice may not be removed or altered from any source
+*   distribution. 
+*
+*********************************************************************************************/
+
+#ifndef PROGRESS_H
+#define PROGRESS_H
+
+#include <stdbool.h>
+
+// Counters of a scan, written only by the scanning thread and read by the reporter thread.
+struct ProgressCounters {
+    unsigned long dirs;
+    unsigned long entries;
+    unsigned long violations;
+    unsigned long errors;
+    unsigned long verdict_hits;         // Names whose verdict was found in a VerdictCache.
+    unsigned long verdict_misses;       // Names compared to their rule.
+};
+
+extern struct ProgressCounters progress_counters;
+
+// Adds n to a counter. Relaxed atomics make this a plain add, with no lock or fence, while
+// still letting the reporter thread read a whole value.
+#define PROGRESS_ADD(counter, n) \
+    __atomic_store_n(&progress_counters.counter, \
+                     __atomic_load_n(&progress_counters.counter, __ATOMIC_RELAXED) + (n), \
+                     __ATOMIC_RELAXED)
+
+bool progress_start (const char *abs_root_path, double interval_seconds);
+
+void progress_stop (void);
+
+#endif // PROGRESS_H
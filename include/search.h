@@ -34,4 +34,6 @@
 
 int subc_exec_search (int argc, char *argv[]);
 
+int subc_exec_scan (int argc, char *argv[]);
+
 #endif // SEARCH_H
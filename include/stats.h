@@ -0,0 +1,47 @@
+/**********************************************************************************************
+*
+*   stats - Detailed statistics of an analyze, collected in fixed memory.
+*
+*   LICENSE: zlib/libpng 
+*
+*   Copyright (c) 2024-2025 Josh Hayden (@BlinkDynamo)
+*
+*   This software is provided ‘as-is’, without any express or implied
+*   warranty. In no event will the authors be held liable for any damages
+*   arising from the use of this software.
+*
+*   Permission is granted to anyone to use this software for any purpose,
+*   including commercial applications, and to alter it and redistribute it
+*   freely, subject to the following restrictions:
+*
+*   1. The origin of this software must not be misrepresented; you must not
+*   claim that you wrote the original software. If you use this software
+*   in a product, an acknowledgment in the product documentation would be
+*   appreciated but is not required.
+*
+*   2. Altered source versions must be plainly marked as such, and must not be
+*   misrepresented as being the original software.
+*
+*   3. This notice may not be removed or altered from any source
+*   distribution. 
+*
+*********************************************************************************************/
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdbool.h>
+
+// Default number of directories listed by --stats-detail, and the most that can be asked for.
+#define STATS_DEFAULT_TOP_DIRS  10
+#define STATS_MAX_TOP_DIRS      1000
+
+void stats_start (int top_dirs);
+
+void stats_record (const char *name, int depth, bool is_match);
+
+void stats_finish_dir (const char *relative_path);
+
+void stats_print (void);
+
+#endif // STATS_H
@@ -0,0 +1,41 @@
+/**********************************************************************************************
+*
+*   throttle - Rate limits and adaptive pacing of filesystem operations.
+*
+*   LICENSE: zlib/libpng 
+*
+*   Copyright (c) 2024-2025 Josh Hayden (@BlinkDynamo)
+*
+*   This software is provided ‘as-is’, without any express or implied
+*   warranty. In no event will the authors be held liable for any damages
+*   arising from the use of this software.
+*
+*   Permission is granted to anyone to use this software for any purpose,
+*   including commercial applications, and to alter it and redistribute it
+*   freely, subject to the following restrictions:
+*
+*   1. The origin of this software must not be misrepresented; you must not
+*   claim that you wrote the original software. If you use this software
+*   in a product, an acknowledgment in the product documentation would be
+*   appreciated but is not required.
+*
+*   2. Altered source versions must be plainly marked as such, and must not be
+*   misrepresented as being the original software.
+*
+*   3. This notice may not be removed or altered from any source
+*   distribution. 
+*
+*********************************************************************************************/
+
+#ifndef THROTTLE_H
+#define THROTTLE_H
+
+#include <stdbool.h>
+
+void throttle_configure (double max_iops, double max_dirs_per_sec, bool adaptive);
+
+void throttle_begin (bool opens_dir);
+
+void throttle_end (void);
+
+#endif // THROTTLE_H
@@ -0,0 +1,154 @@
+/**********************************************************************************************
+*
+*   traverse - The directory traversal shared by nc-scout subcommands.
+*
+*   LICENSE: zlib/libpng 
+*
+*   Copyright (c) 2024-2025 Josh Hayden (@BlinkDynamo)
+*
+*   This software is provided ‘as-is’, without any express or implied
+*   warranty. In no event will the authors be held liable for any damages
+*   arising from the use of this software.
+*
+*   Permission is granted to anyone to use this software for any purpose,
+*   including commercial applications, and to alter it and redistribute it
+*   freely, subject to the following restrictions:
+*
+*   1. The origin of this software must not be misrepresented; you must not
+*   claim that you wrote the original software. If you use this software
+*   in a product, an acknowledgment in the product documentation would be
+*   appreciated but is not required.
+*
+*   2. Altered source versions must be plainly marked as such, and must not be
+*   misrepresented as being the original software.
+*
+*   3. This notice may not be removed or altered from any source
+*   distribution. 
+*
+*********************************************************************************************/
+
+#ifndef TRAVERSE_H
+#define TRAVERSE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+// Size of the buffer of each getdents64() call, which is one operation for --max-iops.
+#define TRAVERSE_DIRENTS_SIZE   32768
+
+// Entry types of TraverseFilters, as a bit set.
+#define TRAVERSE_TYPE_FILE      0x1
+#define TRAVERSE_TYPE_DIR       0x2
+#define TRAVERSE_TYPE_SYMLINK   0x4
+
+// A single entry of a directory, valid until the next directory is read.
+struct TraverseEntry {
+    const char *name;
+    unsigned char type;             // The d_type of the entry (DT_DIR, DT_REG, DT_LNK, ...).
+    ino_t ino;
+    struct statx_timestamp ctime;   // Only set when the traversal has changed_since_flag.
+    uint64_t size;                  // Only set when the filters have min_size_flag.
+    uid_t uid;                      // Only set when the filters have owner_flag.
+    unsigned int mark;              // Only set on directories, by traversal->mark_subdir.
+};
+
+// Which entries a traversal visits, beyond the types it always skips. Filters on the type and
+// depth never read metadata; the others are checked with one statx() per entry that asks for
+// nothing but the fields they need.
+struct TraverseFilters {
+    unsigned char types;            // TRAVERSE_TYPE_* bit set, or 0 for every visited type.
+    int max_depth;                  // Deepest entries visited (1 for those of the root), or 0.
+    bool min_size_flag;             // Only visit regular files of at least min_size bytes.
+    uint64_t min_size;
+    bool owner_flag;                // Only visit entries owned by owner.
+    uid_t owner;
+};
+
+// A directory read in full. The directory stays open (fd) until traverse_close_dir().
+struct TraverseDir {
+    const char *abs_path;
+    int depth;                      // 0 for the directory the traversal started in.
+    int fd;
+    bool changed;                   // False if changed_since_flag found the directory unchanged.
+    bool readahead;                 // Set by the caller to hint the kernel to read ahead.
+    unsigned int mark;              // The mark of its entry in its parent, or 0 for the root.
+    struct TraverseEntry *entries;
+    size_t n_entries;
+
+    // Buffers reused between directories.
+    char *dirents;                  // TRAVERSE_DIRENTS_SIZE bytes for getdents64().
+    char *abs_path_buf;
+    size_t abs_path_capacity;
+    size_t entries_capacity;
+    char *names;
+    size_t names_len;
+    size_t names_capacity;
+};
+
+// A directory waiting to be read by the traversal.
+struct TraversePending {
+    char *abs_path;
+    int depth;
+    unsigned int mark;
+};
+
+// How to traverse a tree, and what to do with every entry that is visited.
+struct Traversal {
+    bool recursive;
+    bool include_symlinks;          // Visit DT_LNK entries as well as directories and files.
+
+    // When set, only visit entries whose ctime is at or after changed_since.
+    bool changed_since_flag;
+    struct statx_timestamp changed_since;
+
+    struct TraverseFilters filters;
+
+    // Enter subdirectories, and read the metadata of entries, in inode order (--inode-order).
+    bool inode_order;
+
+    // When shard_count > 1, only visit the slice shard_index (from 0) of shard_count slices.
+    // Entries at shard_depth (1 for the entries of the root) are divided between the slices by
+    // the hash of their relative path, along with everything under them. Entries above
+    // shard_depth belong to slice 0.
+    int shard_index;
+    int shard_count;
+    int shard_depth;
+
+    void (*visit)(const struct TraverseEntry *entry, const struct TraverseDir *dir, void *context);
+    // Optional. Called once all entries of a directory have been visited, while it is open.
+    void (*finish_dir)(const struct TraverseDir *dir, void *context);
+    void *context;
+
+    // Optional. Returns the mark of a subdirectory of dir, which the traversal keeps with it
+    // until it is read, so that a property of a whole path can be worked out once per
+    // directory from the mark of its parent (dir->mark). Called for every subdirectory of a
+    // directory before any of its entries are visited, and not with resume, which starts
+    // every directory with a mark of 0.
+    unsigned int (*mark_subdir)(const struct TraverseEntry *subdir, const struct TraverseDir *dir,
+                                void *context);
+
+    // Optional. Called between directories with the directories still to be read, the last
+    // of which is read next. Every entry of the directories read so far has been visited.
+    void (*frontier)(const struct TraversePending *pending, size_t n_pending);
+    // Optional. Directories to read instead of abs_root_path, as passed to frontier.
+    const struct TraversePending *resume;
+    size_t n_resume;
+};
+
+bool traverse_open_dir (const char *abs_path, int depth, struct TraverseDir *dir);
+
+void traverse_close_dir (struct TraverseDir *dir);
+
+void traverse_free_dir (struct TraverseDir *dir);
+
+bool traverse_join_path (char *buf, size_t size, const char *abs_dir_path, const char *name);
+
+void traverse_tree (const struct Traversal *traversal, const char *abs_root_path);
+
+void traverse_describe_filters (const struct TraverseFilters *filters, char *buf, size_t size);
+
+#endif // TRAVERSE_H
@@ -31,9 +31,29 @@
 #define VALIDATION_H
 
 #include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+// Most slices a tree can be divided into with --shard.
+#define MAX_SHARDS 65536
 
 bool validate_file_exists (const char *filepath);
 
 bool validate_file_is_dir (const char *filepath);
 
+bool validate_timestamp (const char *arg, struct statx_timestamp *timestamp);
+
+bool validate_rate (const char *arg, double *rate);
+
+bool validate_shard (const char *arg, int *index, int *count);
+
+bool validate_types (const char *arg, unsigned char *types);
+
+bool validate_size (const char *arg, uint64_t *size);
+
+bool validate_owner (const char *arg, uid_t *owner);
+
+bool validate_depth (const char *arg, int *depth);
+
 #endif // VALIDATION_H
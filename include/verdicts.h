@@ -0,0 +1,59 @@
+/**********************************************************************************************
+*
+*   verdicts - A fixed-size cache of the verdicts of names seen before.
+*
+*   LICENSE: zlib/libpng 
+*
+*   Copyright (c) 2024-2025 Josh Hayden (@BlinkDynamo)
+*
+*   This software is provided ‘as-is’, without any express or implied
+*   warranty. In no event will the authors be held liable for any damages
+*   arising from the use of this software.
+*
+*   Permission is granted to anyone to use this software for any purpose,
+*   including commercial applications, and to alter it and redistribute it
+*   freely, subject to the following restrictions:
+*
+*   1. The origin of this software must not be misrepresented; you must not
+*   claim that you wrote the original software. If you use this software
+*   in a product, an acknowledgment in the product documentation would be
+*   appreciated but is not required.
+*
+*   2. Altered source versions must be plainly marked as such, and must not be
+*   misrepresented as being the original software.
+*
+*   3. This notice may not be removed or altered from any source
+*   distribution. 
+*
+*********************************************************************************************/
+
+#ifndef VERDICTS_H
+#define VERDICTS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "naming.h"
+
+#define VERDICT_CACHE_SLOTS 4096        // A power of two.
+#define VERDICT_NAME_MAX 50             // Longer names are always compared.
+#define VERDICT_RULES 32                // Rules with a higher index are always compared.
+
+// A name and its verdicts, one bit per rule, filling a cache line.
+struct VerdictSlot {
+    uint32_t hash;                      // The high half of the hash of name.
+    uint32_t known;                     // The rules name has been compared to.
+    uint32_t matches;                   // Of those, the rules name matches.
+    uint16_t length;                    // 0 for an empty slot.
+    char name[VERDICT_NAME_MAX];        // Not NUL-terminated.
+};
+
+// Direct-mapped by the hash of a name, so a slot is replaced by the next name mapped to it.
+struct VerdictCache {
+    struct VerdictSlot *slots;          // Allocated on first use.
+};
+
+bool verdicts_match (struct VerdictCache *cache, unsigned int rule_index, 
+                     const struct NamingRule *rule, const char *name);
+
+#endif // VERDICTS_H
@@ -37,87 +37,720 @@
 #include <dirent.h>
 #include <getopt.h>
 #include <errno.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
 #include <linux/limits.h>
 
 #include "help.h"
 #include "validate.h"
 #include "common.h"
 #include "naming.h"
+#include "traverse.h"
+#include "policy.h"
+#include "progress.h"
+#include "throttle.h"
+#include "stats.h"
+#include "partial.h"
+#include "checkpoint.h"
+#include "metrics.h"
+#include "locate.h"
+#include "owners.h"
+#include "verdicts.h"
 #include "analyze.h"
 
 #define N_REQUIRED_ARGS 2
 
+// Seconds between two reports of --progress.
+#define PROGRESS_DEFAULT_INTERVAL 1.0
+
+// Defaults and constants of --estimate.
+#define ESTIMATE_DEFAULT_PROBES     1000
+#define ESTIMATE_Z_95               1.96
+#define ESTIMATE_TABLE_MIN_SIZE     1024
+
+// Long options without a short equivalent.
+enum {
+    OPT_SEED = 256,
+    OPT_DEADLINE,
+    OPT_PROBES,
+    OPT_CHANGED_SINCE,
+    OPT_POLICY,
+    OPT_PROGRESS,
+    OPT_MAX_IOPS,
+    OPT_MAX_DIRS_PER_SEC,
+    OPT_ADAPTIVE,
+    OPT_STATS_DETAIL,
+    OPT_SHARD,
+    OPT_SHARD_DEPTH,
+    OPT_PARTIAL,
+    OPT_CHECKPOINT,
+    OPT_CHECKPOINT_INTERVAL,
+    OPT_RESUME,
+    OPT_TYPE,
+    OPT_MAX_DEPTH,
+    OPT_MIN_SIZE,
+    OPT_OWNER,
+    OPT_METRICS_FILE,
+    OPT_INODE_ORDER,
+    OPT_LOCATE_DB,
+    OPT_BY_OWNER,
+};
+
 // Flags.
 static bool strict_flag    = false;
 static bool recursive_flag = false;
+static bool estimate_flag  = false;
+static bool seed_flag      = false;
+static bool probes_flag    = false;
+static bool changed_since_flag = false;
+static bool unicode_flag   = false;
+static bool stats_detail_flag = false;
+
+// Set by --changed-since.
+static struct statx_timestamp changed_since;
+
+// Set by --policy.
+static const char *policy_path = NULL;
+
+// Set by --progress. 0 if progress is not reported.
+static double progress_interval = 0.0;
+
+// Set by --max-iops, --max-dirs-per-sec and --adaptive. 0 if not limited.
+static double max_iops = 0.0;
+static double max_dirs_per_sec = 0.0;
+static bool adaptive_flag = false;
+
+// Set by --stats-detail.
+static long stats_top_dirs = STATS_DEFAULT_TOP_DIRS;
+
+// Set by --shard, --shard-depth and --partial. The slice is counted from 0.
+static int shard_index = 0;
+static int shard_count = 1;
+static int shard_depth = 1;
+static const char *partial_path = NULL;
+
+// Set by --type, --max-depth, --min-size and --owner.
+static struct TraverseFilters filters;
+
+// Set by --inode-order.
+static bool inode_order_flag = false;
+
+// Set by --locate-db.
+static const char *locate_db_path = NULL;
+
+// Set by --by-owner. The non-matches of a directory wait in owner_batch for their owners,
+// which are counted in owner_counts.
+static bool by_owner_flag = false;
+static struct OwnerBatch owner_batch;
+static struct OwnerTable owner_counts;
+
+// The verdicts of names already compared, by convention or by index of the policy.
+static struct VerdictCache verdict_cache;
+
+// Set by --metrics-file.
+static const char *metrics_path = NULL;
+
+// Set by --checkpoint, --checkpoint-interval and --resume.
+static const char *checkpoint_path = NULL;
+static double checkpoint_interval = CHECKPOINT_DEFAULT_INTERVAL;
+static const char *resume_path = NULL;
+
+// Everything a checkpoint must agree on to be resumed by this analyze.
+static char scan_description[PATH_MAX + 256];
+static const struct PolicyTable *checkpoint_table = NULL;
+
+static const char *abs_initial_analyze_path = NULL;
+
+// Options of --estimate.
+static uint64_t estimate_seed       = 0;
+static double estimate_deadline     = 0.0;
+static long estimate_max_probes     = ESTIMATE_DEFAULT_PROBES;
+
+static unsigned long matches = 0;
+static unsigned long non_matches = 0;
+static unsigned long non_policy_entries = 0;
+
+// A directory read during --estimate. Cached so that repeated probes never re-read it.
+struct SampledDir {
+    uint64_t key;               // hash_string() of the absolute path, 0 if the slot is unused.
+    unsigned long matches;
+    unsigned long non_matches;
+    int n_subdirs;
+    char **subdirs;             // Names of the subdirectories, used to pick the next step.
+};
+
+// Open addressing table of every directory read so far, keyed by SampledDir.key.
+static struct SampledDir *sampled_dirs = NULL;
+static size_t sampled_dirs_size = 0;
+static size_t sampled_dirs_used = 0;
+
+static void process_current_file (const struct TraverseEntry *current_file,
+                                  const struct TraverseDir *current_dir, void *context)
+{
+    const struct NamingRule *rule = context;
+    bool is_match = verdicts_match(&verdict_cache, 0, rule, current_file->name);
+    if (is_match) {
+        matches++;
+    } else {
+        non_matches++;
+        PROGRESS_ADD(violations, 1);
+        if (by_owner_flag) {
+            owners_request(&owner_batch, current_file, NULL);
+        }
+    }
+    if (stats_detail_flag) {
+        stats_record(current_file->name, current_dir->depth + 1, is_match);
+    }
+}
+
+// The visit function of a convention analyze without --stats-detail or --by-owner, which only
+// counts, so neither flag is tested for every entry.
+static void count_current_file (const struct TraverseEntry *current_file,
+                                const struct TraverseDir *current_dir, void *context)
+{
+    (void)current_dir;
+    if (verdicts_match(&verdict_cache, 0, context, current_file->name)) {
+        matches++;
+    } else {
+        non_matches++;
+        PROGRESS_ADD(violations, 1);
+    }
+}
+
+static void process_policy_file (const struct TraverseEntry *current_file,
+                                 const struct TraverseDir *current_dir, void *context)
+{
+    const struct PolicyTable *table = context;
+    const char *relative_path = get_relative_path(abs_initial_analyze_path, current_dir->abs_path);
+    struct Policy *policy = policy_lookup(table, current_file->name, current_file->type, 
+                                          relative_path);
+    if (policy == NULL) {
+        non_policy_entries++;
+        return;
+    }
+
+    bool is_match = verdicts_match(&verdict_cache, (unsigned int)(policy - table->policies), 
+                                   &policy->rule, current_file->name);
+    if (is_match) {
+        policy->matches++;
+    } else {
+        policy->non_matches++;
+        PROGRESS_ADD(violations, 1);
+        if (by_owner_flag) {
+            owners_request(&owner_batch, current_file, NULL);
+        }
+    }
+    if (stats_detail_flag) {
+        stats_record(current_file->name, current_dir->depth + 1, is_match);
+    }
+}
 
-static int matches = 0;
-static int non_matches = 0;
+static void finish_current_dir (const struct TraverseDir *current_dir, void *context)
+{
+    (void)context;
+    if (stats_detail_flag) {
+        stats_finish_dir(get_relative_path(abs_initial_analyze_path, current_dir->abs_path));
+    }
+    // The owners of the non-matches of a directory are read together, before it is closed.
+    if (by_owner_flag) {
+        owners_stat(&owner_batch, current_dir);
+        for (size_t i = 0; i < owner_batch.n_requests; i++)
+        {
+            owners_count(&owner_counts, &owner_batch.requests[i]);
+        }
+        owners_clear(&owner_batch);
+    }
+}
 
-static void analyze_directory (const char *analyze_path, regex_t regex)
+static void describe_scan (const char *convention)
+{
+    char filter_description[128];
+    traverse_describe_filters(&filters, filter_description, sizeof(filter_description));
+    snprintf(scan_description, sizeof(scan_description), 
+             "analyze %s=%s strict=%d unicode=%d recursive=%d changed-since=%lld "
+             "shard=%d/%d shard-depth=%d %s location=%s",
+             (convention != NULL) ? "convention" : "policy", 
+             (convention != NULL) ? convention : policy_path,
+             strict_flag, unicode_flag, recursive_flag,
+             (changed_since_flag) ? (long long)changed_since.tv_sec : -1LL,
+             shard_index + 1, shard_count, shard_depth, filter_description, abs_initial_analyze_path);
+}
+
+// Writes the state of the analyze to a checkpoint. Called by checkpoint_frontier().
+static void write_checkpoint (FILE *file)
+{
+    fprintf(file, "scan %s\n", scan_description);
+    checkpoint_save_counters(file, checkpoint_table, matches, non_matches, non_policy_entries);
+}
+
+static bool write_metrics (const char *location, const char *convention, const void *context)
+{
+    // Adds the results of the analyze to the metrics, then writes them to --metrics-file.
+    if (convention != NULL) {
+        metrics_add_result(convention, NULL, matches, non_matches);
+    }
+    else {
+        const struct PolicyTable *table = context;
+        for (int i = 0; i < table->n_policies; i++)
+        {
+            const struct Policy *policy = &table->policies[i];
+            metrics_add_result(policy->convention, policy->name, policy->matches, 
+                               policy->non_matches);
+        }
+    }
+    return metrics_write(metrics_path, "analyze", location);
+}
+
+static bool analyze_directory (const char *abs_analyze_path, const char *convention,
+                               void (*visit)(const struct TraverseEntry *, const struct TraverseDir *, void *),
+                               void *context)
 /**********************************************************************************************
 *
-*   Analyzes a directory given a naming convention, printing the percentages of matching files 
-*   to total files.
+*   Analyzes a directory given a naming convention, counting the matching and non-matching
+*   files and directories.
 **
 *   ---------------------------------------- ARGUMENTS ----------------------------------------
 *
-*   analyze_path     The directory where the analyze will take place.
+*   abs_analyze_path    The absolute path of the directory where the analyze will take place.
+*
+*   convention          The convention being analyzed for, or NULL for a policy analyze.
+*
+*   visit               The function processing every entry.
 *
-*   regex           The compiled regex of the convention being analyzeed for.
+*   context             The rule of the convention, or policy table, being analyzed for.
+*
+*   ----------------------------------------- RETURNS -----------------------------------------
+*
+*   false if the --resume could not be loaded, otherwise true.
 *
 **********************************************************************************************/
 {
-    const char *abs_analyze_path = canonicalize_file_name(analyze_path);
-    
-    // dir_path is known to exist at this point, but opendir() can still fail from permissions.
-    DIR *current_dir = opendir(abs_analyze_path);
-    if (current_dir == NULL) {
-        printf("Error: cannot access %s due to Error %d (%s).\n", abs_analyze_path, errno, 
-                strerror(errno));
-        return;
+    abs_initial_analyze_path = abs_analyze_path;
+    describe_scan(convention);
+    checkpoint_table = (convention == NULL) ? context : NULL;
+
+    struct Checkpoint checkpoint = {0};
+    if (resume_path != NULL && 
+        (!checkpoint_read(&checkpoint, resume_path) || 
+         !checkpoint_expect(&checkpoint, "scan", scan_description) ||
+         !checkpoint_restore_counters(&checkpoint, (convention == NULL) ? context : NULL,
+                                      &matches, &non_matches, &non_policy_entries))) {
+        return false;
+    }
+
+    if (visit == process_current_file && !stats_detail_flag && !by_owner_flag) {
+        visit = count_current_file;
+    }
+
+    // Policies say for themselves whether they apply to symlinks.
+    struct Traversal traversal = {
+        .recursive = recursive_flag,
+        .include_symlinks = (policy_path != NULL),
+        .changed_since_flag = changed_since_flag,
+        .changed_since = changed_since,
+        .filters = filters,
+        .inode_order = inode_order_flag,
+        .visit = visit,
+        .finish_dir = (stats_detail_flag || by_owner_flag) ? finish_current_dir : NULL,
+        .shard_index = shard_index,
+        .shard_count = shard_count,
+        .shard_depth = shard_depth,
+        .context = context,
+        .frontier = (checkpoint_path != NULL) ? checkpoint_frontier : NULL,
+        .resume = (resume_path != NULL) ? checkpoint.pending : NULL,
+        .n_resume = checkpoint.n_pending,
+    };
+    if (stats_detail_flag) {
+        stats_start(stats_top_dirs);
+    }
+    if (progress_interval > 0.0) {
+        progress_start(abs_analyze_path, progress_interval);
+    }
+    if (checkpoint_path != NULL) {
+        checkpoint_start(checkpoint_path, checkpoint_interval, write_checkpoint);
+    }
+    if (metrics_path != NULL) {
+        metrics_start();
+    }
+    if (locate_db_path != NULL) {
+        if (!locate_scan(locate_db_path, &traversal, abs_analyze_path)) {
+            progress_stop();
+            return false;
+        }
+    }
+    else {
+        traverse_tree(&traversal, abs_analyze_path);
+    }
+    progress_stop();
+    checkpoint_finish(true);
+    if (metrics_path != NULL && !write_metrics(abs_analyze_path, convention, context)) {
+        return false;
+    }
+    return true;
+}
+
+static double seconds_since (const struct timespec *start)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static struct SampledDir *sampled_dirs_slot (uint64_t key)
+{
+    size_t i = key & (sampled_dirs_size - 1);
+    while (sampled_dirs[i].key != 0 && sampled_dirs[i].key != key)
+    {
+        i = (i + 1) & (sampled_dirs_size - 1);
     }
-   
-    // Begin reading directories/files inside current_dir.
-    struct dirent *current_file;
-    while ((current_file = readdir(current_dir)) != NULL)
+    return &sampled_dirs[i];
+}
+
+// Doubles the size of sampled_dirs (or creates it), keeping the load factor under one half.
+static void sampled_dirs_grow (void)
+{
+    struct SampledDir *old_dirs = sampled_dirs;
+    size_t old_size = sampled_dirs_size;
+
+    sampled_dirs_size = (old_size == 0) ? ESTIMATE_TABLE_MIN_SIZE : old_size * 2;
+    sampled_dirs = xcalloc(sampled_dirs_size, sizeof(struct SampledDir));
+    for (size_t i = 0; i < old_size; i++)
     {
-        // Skip current and parent entries.
-        if (strcmp(current_file->d_name, ".") == 0 || strcmp(current_file->d_name, "..") == 0) {
+        if (old_dirs[i].key != 0) {
+            *sampled_dirs_slot(old_dirs[i].key) = old_dirs[i];
+        }
+    }
+    free(old_dirs);
+}
+
+static struct SampledDir *sample_directory (const char *abs_sample_path, 
+                                            const struct NamingRule *rule)
+/**********************************************************************************************
+*
+*   Returns the counts and subdirectories of a directory, reading it only the first time it is
+*   sampled. Unreadable directories are cached as empty so the error is only printed once.
+*
+*   ---------------------------------------- ARGUMENTS ----------------------------------------
+*
+*   abs_sample_path     The absolute path of the directory to sample.
+*
+*   rule                The rule of the convention being analyzed for.
+*
+**********************************************************************************************/
+{
+    uint64_t key = hash_string(abs_sample_path);
+    if (key == 0) {
+        key = 1;
+    }
+
+    if (sampled_dirs_used * 2 >= sampled_dirs_size) {
+        sampled_dirs_grow();
+    }
+    struct SampledDir *dir = sampled_dirs_slot(key);
+    if (dir->key == key) {
+        return dir;
+    }
+    memset(dir, 0, sizeof(*dir));
+    dir->key = key;
+    sampled_dirs_used++;
+
+    static struct TraverseDir current_dir;
+    if (!traverse_open_dir(abs_sample_path, 0, &current_dir)) {
+        return dir;
+    }
+
+    int subdirs_capacity = 0;
+    for (size_t i = 0; i < current_dir.n_entries; i++)
+    {
+        const struct TraverseEntry *current_file = &current_dir.entries[i];
+        if (current_file->type != DT_DIR && current_file->type != DT_REG) {
             continue;
         }
 
-        // If the current file is a directory...
-        if (current_file->d_type == DT_DIR) {
+        if (verdicts_match(&verdict_cache, 0, rule, current_file->name)) {
+            dir->matches++;
+        } else {
+            dir->non_matches++;
+        }
 
-            // Process it.
-            if (naming_match_regex(regex, current_file->d_name)) {
-                matches++;
-            } else {
-                non_matches++;
+        if (current_file->type == DT_DIR) {
+            if (dir->n_subdirs == subdirs_capacity) {
+                subdirs_capacity = (subdirs_capacity == 0) ? 16 : subdirs_capacity * 2;
+                dir->subdirs = xrealloc(dir->subdirs, subdirs_capacity * sizeof(char *));
             }
+            dir->subdirs[dir->n_subdirs++] = strdup(current_file->name);
+        }
+    }
+    traverse_close_dir(&current_dir);
+    return dir;
+}
 
-            // Then if recursive_flag is true, concatenate abs_analyze_path with current_file->d_name
-            // and call analyze_directory at that location.
-            if (recursive_flag == true) {
-                char abs_new_analyze_path[PATH_MAX];
-                snprintf(abs_new_analyze_path, sizeof(abs_new_analyze_path), "%s/%s", abs_analyze_path, 
-                         current_file->d_name);
-                analyze_directory(abs_new_analyze_path, regex);
-            }
+static bool estimate_probe (const char *abs_root_path, const struct NamingRule *rule, 
+                            uint64_t *rng_state,
+                            const struct timespec *start, double sample[3])
+/**********************************************************************************************
+*
+*   Performs one random walk from abs_root_path to a leaf directory, choosing every step
+*   uniformly among the subdirectories. Each directory on the walk is weighted by the inverse
+*   of the probability of reaching it, which makes the weighted sums unbiased estimates of the
+*   totals of the whole tree (Knuth's estimator).
+*
+*   ---------------------------------------- ARGUMENTS ----------------------------------------
+*
+*   abs_root_path   The absolute path of the directory being estimated.
+*
+*   rule            The rule of the convention being analyzed for.
+*
+*   rng_state       The state of the random number generator choosing the walk.
+*
+*   start           When the estimate started, used to abandon the walk past the deadline.
+*
+*   sample          Set to the estimated matches, entries, and directories of the tree.
+*
+*   ----------------------------------------- RETURNS -----------------------------------------
+*
+*   True if the walk completed, false if it was abandoned because the deadline passed. An
+*   abandoned walk would bias the estimate towards shallow directories, so it is discarded.
+*
+**********************************************************************************************/
+{
+    char abs_probe_path[PATH_MAX];
+    snprintf(abs_probe_path, sizeof(abs_probe_path), "%s", abs_root_path);
+
+    double weight = 1.0;
+    sample[0] = sample[1] = sample[2] = 0.0;
+    while (1)
+    {
+        if (estimate_deadline > 0.0 && seconds_since(start) >= estimate_deadline) {
+            return false;
         }
-        // Else if the current file is a regular file...
-        else if (current_file->d_type == DT_REG) { 
 
-            // Process it.
-            if (naming_match_regex(regex, current_file->d_name)) {
-                matches++;
-            } else {
-                non_matches++;
-            }
+        struct SampledDir *dir = sample_directory(abs_probe_path, rule);
+        sample[0] += weight * dir->matches;
+        sample[1] += weight * (dir->matches + dir->non_matches);
+        sample[2] += weight;
+
+        if (dir->n_subdirs == 0) {
+            return true;
+        }
+        const char *next = dir->subdirs[random_next(rng_state) % dir->n_subdirs];
+        size_t path_len = strlen(abs_probe_path);
+        if (path_len + strlen(next) + 2 > sizeof(abs_probe_path)) {
+            return true;
+        }
+        snprintf(abs_probe_path + path_len, sizeof(abs_probe_path) - path_len, "%s%s",
+                 (path_len == 1) ? "" : "/", next);
+        weight *= dir->n_subdirs;
+    }
+}
+
+static bool estimate_directory (const char *abs_analyze_path, const char *arg_naming_convention,
+                                const struct NamingRule *rule)
+/**********************************************************************************************
+*
+*   Estimates the percentage of matching files and directories in a tree by repeated random
+*   walks, printing the estimate and its 95% confidence interval as it narrows, then the final
+*   estimate along with how much of the tree was actually read.
+*
+*   ---------------------------------------- ARGUMENTS ----------------------------------------
+*
+*   abs_analyze_path        The absolute path of the directory being estimated.
+*
+*   arg_naming_convention   The name of the convention, used in the output.
+*
+*   rule                    The rule of the convention being analyzed for.
+*
+*   ----------------------------------------- RETURNS -----------------------------------------
+*
+*   True if at least one walk completed before the deadline, false if not.
+*
+**********************************************************************************************/
+{
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    if (!seed_flag) {
+        estimate_seed = (uint64_t)time(NULL) ^ ((uint64_t)getpid() << 32);
+    }
+    // xorshift64* must never be seeded with 0.
+    uint64_t rng_state = (estimate_seed == 0) ? 0x9e3779b97f4a7c15ULL : estimate_seed;
+
+    printf("Estimated the presence of %s %s files and directories in '%s'.\n\n", 
+            (strict_flag) ? "strictly" : "leniently",
+            arg_naming_convention,
+            abs_analyze_path);
+
+    // Sums over completed walks of the estimated matches (m), entries (n), and directories.
+    double sum_m = 0.0, sum_n = 0.0, sum_dirs = 0.0;
+    double sum_mm = 0.0, sum_nn = 0.0, sum_mn = 0.0;
+    double ratio = 0.0, half_width = 0.0;
+    long n_probes = 0;
+    bool deadline_reached = false;
+
+    while (estimate_max_probes == 0 || n_probes < estimate_max_probes)
+    {
+        double sample[3];
+        if (!estimate_probe(abs_analyze_path, rule, &rng_state, &start, sample)) {
+            deadline_reached = true;
+            break;
+        }
+        n_probes++;
+        sum_m += sample[0];
+        sum_n += sample[1];
+        sum_dirs += sample[2];
+        sum_mm += sample[0] * sample[0];
+        sum_nn += sample[1] * sample[1];
+        sum_mn += sample[0] * sample[1];
+
+        // Ratio estimator with a delta method variance from the residuals m - ratio * n.
+        ratio = (sum_n > 0.0) ? sum_m / sum_n : 0.0;
+        half_width = 0.0;
+        if (n_probes > 1 && sum_n > 0.0) {
+            double residuals = sum_mm - 2.0 * ratio * sum_mn + ratio * ratio * sum_nn;
+            double variance = fmax(residuals, 0.0) / (n_probes - 1);
+            double mean_n = sum_n / n_probes;
+            half_width = ESTIMATE_Z_95 * sqrt(variance / n_probes) / mean_n;
+        }
+
+        // Report the interval every time the number of walks doubles.
+        if ((n_probes & (n_probes - 1)) == 0) {
+            printf("probes: %-8ld estimate: %7.3f%% +/- %.3f%%\n", n_probes, ratio * 100.0,
+                    half_width * 100.0);
         }
     }
-    closedir(current_dir);
+
+    if (n_probes == 0) {
+        printf("Error: no probe completed before the deadline of %.3f seconds.\n",
+                estimate_deadline);
+        return false;
+    }
+
+    double estimated_dirs = sum_dirs / n_probes;
+    double lower = fmax(ratio - half_width, 0.0) * 100.0;
+    double upper = fmin(ratio + half_width, 1.0) * 100.0;
+    printf("\n%s %s files and directories make up %0.3f%% of '%s' (estimated, 95%% CI %0.3f%% - %0.3f%%).\n",
+            (strict_flag) ? "strictly" : "leniently",
+            arg_naming_convention, 
+            ratio * 100.0,
+            abs_analyze_path,
+            lower,
+            upper);
+    printf("Read %zu of an estimated %.0f directories (%0.3f%% of the tree) in %ld probes "
+           "and %.3f seconds using seed %llu%s.\n",
+            sampled_dirs_used,
+            estimated_dirs,
+            fmin(sampled_dirs_used / estimated_dirs, 1.0) * 100.0,
+            n_probes,
+            seconds_since(&start),
+            (unsigned long long)estimate_seed,
+            (deadline_reached) ? ", stopped by the deadline" : "");
+    return true;
+}
+
+void analyze_print_report (const char *convention, bool strict, const char *location, 
+                           bool changed_since, unsigned long matches, unsigned long non_matches)
+/**********************************************************************************************
+*
+*   Prints the matches and non-matches of an analyze, followed by the percentage of entries
+*   that match. Also used by the merge subcommand to report the sum of partial results.
+*
+**********************************************************************************************/
+{
+    printf("Analyzed the presence of %s %s files and directories in '%s'%s.\n\n", 
+            (strict) ? "strictly" : "leniently",
+            convention,
+            location,
+            (changed_since) ? " changed since the given time" : "");
+
+    printf("%s:         %lu\n", convention, matches);
+    printf("non-%s:     %lu\n\n", convention, non_matches);
+    printf("%s %s files and directories make up %0.3f%% of '%s'.\n", 
+            (strict) ? "strictly" : "leniently",
+            convention, 
+            percentage(matches, matches + non_matches), 
+            location);
+}
+
+void analyze_print_policy_report (const struct Policy *policies, int n_policies, 
+                                  unsigned long non_policy_entries, const char *policy_path,
+                                  const char *location, bool changed_since)
+/**********************************************************************************************
+*
+*   Prints the matches and non-matches of every policy after a policy analyze, followed by
+*   the percentage of all checked entries that follow their policy. Also used by the merge
+*   subcommand to report the sum of partial results.
+*
+**********************************************************************************************/
+{
+    unsigned long total_matches = 0;
+    unsigned long total_non_matches = 0;
+
+    printf("Analyzed the presence of the policies of '%s' in '%s'%s.\n\n", 
+            policy_path,
+            location,
+            (changed_since) ? " changed since the given time" : "");
+    printf("%-20s %-14s %-9s %12s %12s %12s\n", "policy", "convention", "mode", "matches",
+           "non-matches", "percentage");
+    for (int i = 0; i < n_policies; i++)
+    {
+        const struct Policy *policy = &policies[i];
+        printf("%-20s %-14s %-9s %12lu %12lu %11.3f%%\n",
+               policy->name,
+               policy->convention,
+               (policy->rule.strict) ? "strict" : "lenient",
+               policy->matches,
+               policy->non_matches,
+               percentage(policy->matches, policy->matches + policy->non_matches));
+        total_matches += policy->matches;
+        total_non_matches += policy->non_matches;
+    }
+    printf("\nEntries no policy applies to: %lu\n\n", non_policy_entries);
+    printf("Files and directories following their policies make up %0.3f%% of '%s'.\n",
+           percentage(total_matches, total_matches + total_non_matches),
+           location);
+}
+
+static bool write_partial (const char *location, const char *arg_naming_convention,
+                           const struct PolicyTable *table)
+/**********************************************************************************************
+*
+*   Writes the counts of the analyze of this shard to --partial, for the merge subcommand.
+*   table is the policy table of a policy analyze, or NULL.
+*
+**********************************************************************************************/
+{
+    FILE *file = partial_create(partial_path, "analyze", shard_index, shard_count, shard_depth);
+    if (file == NULL) {
+        return false;
+    }
+    fprintf(file, "location %s\n", location);
+    fprintf(file, "mode %s\n", (strict_flag) ? "strict" : "lenient");
+    fprintf(file, "unicode %s\n", (unicode_flag) ? "yes" : "no");
+    char filter_description[128];
+    traverse_describe_filters(&filters, filter_description, sizeof(filter_description));
+    fprintf(file, "filters %s\n", filter_description);
+    if (changed_since_flag) {
+        fprintf(file, "changed-since %lld\n", (long long)changed_since.tv_sec);
+    }
+
+    if (table == NULL) {
+        fprintf(file, "convention %s\n", arg_naming_convention);
+        fprintf(file, "matches %lu\n", matches);
+        fprintf(file, "non-matches %lu\n", non_matches);
+    }
+    else {
+        fprintf(file, "policy-file %s\n", policy_path);
+        for (int i = 0; i < table->n_policies; i++)
+        {
+            const struct Policy *policy = &table->policies[i];
+            fprintf(file, "policy %s\t%s\t%s\t%lu\t%lu\n", policy->name, policy->convention, 
+                    (policy->rule.strict) ? "strict" : "lenient", policy->matches, 
+                    policy->non_matches);
+        }
+        fprintf(file, "non-policy %lu\n", non_policy_entries);
+    }
+    return partial_commit(file, partial_path);
 }
 
 int subc_exec_analyze (int argc, char *argv[])
@@ -146,11 +779,37 @@ int subc_exec_analyze (int argc, char *argv[])
             {"help", no_argument, 0, 'h'},
             {"strict", no_argument, 0, 's'},
             {"recursive", no_argument, 0, 'R'},
+            {"unicode", no_argument, 0, 'u'},
+            {"estimate", no_argument, 0, 'e'},
+            {"seed", required_argument, 0, OPT_SEED},
+            {"deadline", required_argument, 0, OPT_DEADLINE},
+            {"probes", required_argument, 0, OPT_PROBES},
+            {"changed-since", required_argument, 0, OPT_CHANGED_SINCE},
+            {"policy", required_argument, 0, OPT_POLICY},
+            {"progress", optional_argument, 0, OPT_PROGRESS},
+            {"max-iops", required_argument, 0, OPT_MAX_IOPS},
+            {"max-dirs-per-sec", required_argument, 0, OPT_MAX_DIRS_PER_SEC},
+            {"adaptive", no_argument, 0, OPT_ADAPTIVE},
+            {"stats-detail", optional_argument, 0, OPT_STATS_DETAIL},
+            {"shard", required_argument, 0, OPT_SHARD},
+            {"shard-depth", required_argument, 0, OPT_SHARD_DEPTH},
+            {"partial", required_argument, 0, OPT_PARTIAL},
+            {"checkpoint", required_argument, 0, OPT_CHECKPOINT},
+            {"checkpoint-interval", required_argument, 0, OPT_CHECKPOINT_INTERVAL},
+            {"resume", required_argument, 0, OPT_RESUME},
+            {"type", required_argument, 0, OPT_TYPE},
+            {"max-depth", required_argument, 0, OPT_MAX_DEPTH},
+            {"min-size", required_argument, 0, OPT_MIN_SIZE},
+            {"owner", required_argument, 0, OPT_OWNER},
+            {"metrics-file", required_argument, 0, OPT_METRICS_FILE},
+            {"inode-order", no_argument, 0, OPT_INODE_ORDER},
+            {"locate-db", required_argument, 0, OPT_LOCATE_DB},
+            {"by-owner", no_argument, 0, OPT_BY_OWNER},
             {0, 0, 0, 0}
         };
         
         int option_index = 0;
-        current_opt = getopt_long (argc, argv, "+hfmsR", long_options_analyze, &option_index);
+        current_opt = getopt_long (argc, argv, "+hsRue", long_options_analyze, &option_index);
         // Break if at the end of the options.
         if (current_opt == -1) {
             break;
@@ -164,7 +823,7 @@ int subc_exec_analyze (int argc, char *argv[])
             case 'h':
                 // Make sure that there are no arguments supplied.
                 if (argc == 2) {
-                    printf("%s", HELP_ANALYZE);
+                    printf("%s%s%s", HELP_ANALYZE, HELP_CONVENTION_LOCATION, HELP_STRICT_LENIENT);
                     return EXIT_SUCCESS;
                 }
                 else {
@@ -180,43 +839,312 @@ int subc_exec_analyze (int argc, char *argv[])
                 recursive_flag = true;
                 break;
 
+            case 'u':
+                unicode_flag = true;
+                break;
+
+            case 'e':
+                estimate_flag = true;
+                break;
+
+            case OPT_SEED:
+            {
+                char *end;
+                errno = 0;
+                estimate_seed = strtoull(optarg, &end, 10);
+                if (errno != 0 || *optarg == '\0' || *end != '\0') {
+                    printf("Error: '%s' is not a valid seed.\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                seed_flag = true;
+                break;
+            }
+
+            case OPT_DEADLINE:
+            {
+                char *end;
+                estimate_deadline = strtod(optarg, &end);
+                if (*optarg == '\0' || *end != '\0' || !(estimate_deadline > 0.0)) {
+                    printf("Error: '%s' is not a valid number of seconds.\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            }
+
+            case OPT_PROBES:
+            {
+                char *end;
+                estimate_max_probes = strtol(optarg, &end, 10);
+                if (*optarg == '\0' || *end != '\0' || estimate_max_probes < 0) {
+                    printf("Error: '%s' is not a valid number of probes.\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                probes_flag = true;
+                break;
+            }
+
+            case OPT_CHANGED_SINCE:
+                if (!validate_timestamp(optarg, &changed_since)) {
+                    return EXIT_FAILURE;
+                }
+                changed_since_flag = true;
+                break;
+
+            case OPT_POLICY:
+                policy_path = optarg;
+                break;
+
+            case OPT_PROGRESS:
+            {
+                char *end = NULL;
+                progress_interval = (optarg == NULL) ? PROGRESS_DEFAULT_INTERVAL : strtod(optarg, &end);
+                if (optarg != NULL && (*optarg == '\0' || *end != '\0' || !(progress_interval > 0.0))) {
+                    printf("Error: '%s' is not a valid number of seconds.\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            }
+
+            case OPT_MAX_IOPS:
+                if (!validate_rate(optarg, &max_iops)) {
+                    return EXIT_FAILURE;
+                }
+                break;
+
+            case OPT_MAX_DIRS_PER_SEC:
+                if (!validate_rate(optarg, &max_dirs_per_sec)) {
+                    return EXIT_FAILURE;
+                }
+                break;
+
+            case OPT_ADAPTIVE:
+                adaptive_flag = true;
+                break;
+
+            case OPT_STATS_DETAIL:
+            {
+                char *end = NULL;
+                stats_top_dirs = (optarg == NULL) ? STATS_DEFAULT_TOP_DIRS : strtol(optarg, &end, 10);
+                if (optarg != NULL && 
+                    (*optarg == '\0' || *end != '\0' || stats_top_dirs < 1 || stats_top_dirs > STATS_MAX_TOP_DIRS)) {
+                    printf("Error: '%s' is not a valid number of directories (1 to %d).\n", optarg,
+                           STATS_MAX_TOP_DIRS);
+                    return EXIT_FAILURE;
+                }
+                stats_detail_flag = true;
+                break;
+            }
+
+            case OPT_SHARD:
+                if (!validate_shard(optarg, &shard_index, &shard_count)) {
+                    return EXIT_FAILURE;
+                }
+                break;
+
+            case OPT_SHARD_DEPTH:
+                if (!validate_depth(optarg, &shard_depth)) {
+                    return EXIT_FAILURE;
+                }
+                break;
+
+            case OPT_PARTIAL:
+                partial_path = optarg;
+                break;
+
+            case OPT_CHECKPOINT:
+                checkpoint_path = optarg;
+                break;
+
+            case OPT_CHECKPOINT_INTERVAL:
+            {
+                char *end;
+                checkpoint_interval = strtod(optarg, &end);
+                if (*optarg == '\0' || *end != '\0' || !(checkpoint_interval > 0.0)) {
+                    printf("Error: '%s' is not a valid number of seconds.\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            }
+
+            case OPT_RESUME:
+                resume_path = optarg;
+                break;
+
+            case OPT_TYPE:
+                if (!validate_types(optarg, &filters.types)) {
+                    return EXIT_FAILURE;
+                }
+                break;
+
+            case OPT_MAX_DEPTH:
+                if (!validate_depth(optarg, &filters.max_depth)) {
+                    return EXIT_FAILURE;
+                }
+                break;
+
+            case OPT_MIN_SIZE:
+                if (!validate_size(optarg, &filters.min_size)) {
+                    return EXIT_FAILURE;
+                }
+                filters.min_size_flag = true;
+                break;
+
+            case OPT_OWNER:
+                if (!validate_owner(optarg, &filters.owner)) {
+                    return EXIT_FAILURE;
+                }
+                filters.owner_flag = true;
+                break;
+
+            case OPT_METRICS_FILE:
+                metrics_path = optarg;
+                break;
+
+            case OPT_INODE_ORDER:
+                inode_order_flag = true;
+                break;
+
+            case OPT_LOCATE_DB:
+                locate_db_path = optarg;
+                break;
+
+            case OPT_BY_OWNER:
+                by_owner_flag = true;
+                break;
+
             default:
                 abort();
         }
     }
+    throttle_configure(max_iops, max_dirs_per_sec, adaptive_flag);
 
+    // A policy file takes the place of the convention.
     int non_option_argc = argc - optind;
-    if (non_option_argc < N_REQUIRED_ARGS) {
+    if (non_option_argc < N_REQUIRED_ARGS - (policy_path != NULL)) {
         printf("Insufficient arguments.\nDo `nc-scout analyze --help` for more information about usage.\n");
         return EXIT_FAILURE;
     }
 
+    // With a deadline and no explicit number of probes, keep probing until the deadline.
+    if (estimate_deadline > 0.0 && !probes_flag) {
+        estimate_max_probes = 0;
+    }
+    if (estimate_flag && policy_path != NULL) {
+        printf("Error: `--estimate` cannot be combined with `--policy`.\n");
+        return EXIT_FAILURE;
+    }
+    if (estimate_flag && stats_detail_flag) {
+        printf("Error: `--estimate` cannot be combined with `--stats-detail`.\n");
+        return EXIT_FAILURE;
+    }
+    if (estimate_flag && (shard_count > 1 || partial_path != NULL)) {
+        printf("Error: `--estimate` cannot be combined with `--shard` or `--partial`.\n");
+        return EXIT_FAILURE;
+    }
+    if ((estimate_flag || stats_detail_flag) && (checkpoint_path != NULL || resume_path != NULL)) {
+        printf("Error: `--estimate` and `--stats-detail` cannot be combined with `--checkpoint` "
+               "or `--resume`.\n");
+        return EXIT_FAILURE;
+    }
+    if (stats_detail_flag && partial_path != NULL) {
+        printf("Error: `--stats-detail` cannot be combined with `--partial`.\n");
+        return EXIT_FAILURE;
+    }
+    if (estimate_flag && metrics_path != NULL) {
+        printf("Error: `--estimate` cannot be combined with `--metrics-file`.\n");
+        return EXIT_FAILURE;
+    }
+    if (estimate_flag && (filters.types != 0 || filters.max_depth != 0 || 
+                          filters.min_size_flag || filters.owner_flag)) {
+        printf("Error: `--estimate` cannot be combined with `--type`, `--max-depth`, `--min-size` "
+               "or `--owner`.\n");
+        return EXIT_FAILURE;
+    }
+    if (estimate_flag && changed_since_flag) {
+        printf("Error: `--estimate` cannot be combined with `--changed-since`.\n");
+        return EXIT_FAILURE;
+    }
+    // A locate database records neither change times, sizes nor owners, and is read in one pass.
+    if (locate_db_path != NULL &&
+        (estimate_flag || stats_detail_flag || changed_since_flag || filters.min_size_flag || 
+         filters.owner_flag || shard_count > 1 || checkpoint_path != NULL || resume_path != NULL)) {
+        printf("Error: `--locate-db` cannot be combined with `--estimate`, `--stats-detail`, "
+               "`--changed-since`, `--min-size`, `--owner`, `--shard`, `--checkpoint` or `--resume`.\n");
+        return EXIT_FAILURE;
+    }
+    // Owners are read from each open directory, and only reported by this process.
+    if (by_owner_flag && (estimate_flag || locate_db_path != NULL || partial_path != NULL || 
+                          checkpoint_path != NULL || resume_path != NULL)) {
+        printf("Error: `--by-owner` cannot be combined with `--estimate`, `--locate-db`, "
+               "`--partial`, `--checkpoint` or `--resume`.\n");
+        return EXIT_FAILURE;
+    }
+    if (estimate_max_probes == 0 && estimate_deadline == 0.0) {
+        printf("Error: `--probes 0` requires a `--deadline`.\n");
+        return EXIT_FAILURE;
+    }
+
+    if (policy_path != NULL) {
+        const char *arg_target_dirname = (locate_db_path != NULL) ? locate_root(argv[optind])
+                                         : canonicalize_file_name(argv[optind]);
+        struct PolicyTable policy_table;
+        if ((policy_load(&policy_table, policy_path, strict_flag, unicode_flag)) &&
+            ((locate_db_path != NULL) ? (arg_target_dirname != NULL) :
+             (validate_file_exists(arg_target_dirname) && validate_file_is_dir(arg_target_dirname))))
+        {
+            if (!analyze_directory(arg_target_dirname, NULL, process_policy_file, &policy_table)) {
+                return EXIT_FAILURE;
+            }
+            if (partial_path != NULL) {
+                return write_partial(arg_target_dirname, NULL, &policy_table) ? 
+                       EXIT_SUCCESS : EXIT_FAILURE;
+            }
+            analyze_print_policy_report(policy_table.policies, policy_table.n_policies, 
+                                        non_policy_entries, policy_path, arg_target_dirname, 
+                                        changed_since_flag);
+            if (by_owner_flag) {
+                owners_print(&owner_counts, "non-matches");
+            }
+            if (stats_detail_flag) {
+                stats_print();
+            }
+            return EXIT_SUCCESS;
+        }
+        return EXIT_FAILURE;
+    }
+
     const char *arg_naming_convention = argv[optind];
-    const char *arg_target_dirname = canonicalize_file_name(argv[optind + 1]);
+    const char *arg_target_dirname = (locate_db_path != NULL) ? locate_root(argv[optind + 1])
+                                     : canonicalize_file_name(argv[optind + 1]);
 
-    // Set to Conventions[i].regex if arg_naming_convention is valid, otherwise it remains NULL.
-    const char *analyze_expression;
-    // Set by naming_compile_regex() after analyze_expression is known to be set.
-    regex_t analyze_regex;
+    // Set by naming_compile_rule() if arg_naming_convention is valid.
+    struct NamingRule analyze_rule;
 
-    if ((naming_set_expression(arg_naming_convention, &analyze_expression, strict_flag)) &&
-        (validate_file_exists(arg_target_dirname)) && 
-        (validate_file_is_dir(arg_target_dirname)) && 
-        (naming_compile_regex(&analyze_regex, analyze_expression)))
+    if ((naming_compile_rule(&analyze_rule, arg_naming_convention, strict_flag, unicode_flag)) &&
+        ((locate_db_path != NULL) ? (arg_target_dirname != NULL) :
+         (validate_file_exists(arg_target_dirname) && validate_file_is_dir(arg_target_dirname))))
     {     
-        analyze_directory(arg_target_dirname, analyze_regex); 
-        printf("Analyzed the presence of %s %s files and directories in '%s'.\n\n", 
-                (strict_flag) ? "strictly" : "leniently",
-                arg_naming_convention,
-                arg_target_dirname);
-
-        printf("%s:         %d\n", arg_naming_convention, matches);
-        printf("non-%s:     %d\n\n", arg_naming_convention, non_matches);
-        printf("%s %s files and directories make up %0.3f%% of '%s'.\n", 
-                (strict_flag) ? "strictly" : "leniently",
-                arg_naming_convention, 
-                percentage(matches, matches + non_matches), 
-                arg_target_dirname);
+        if (estimate_flag) {
+            return estimate_directory(arg_target_dirname, arg_naming_convention, &analyze_rule) ?
+                   EXIT_SUCCESS : EXIT_FAILURE;
+        }
+
+        if (!analyze_directory(arg_target_dirname, arg_naming_convention, process_current_file, 
+                               &analyze_rule)) {
+            return EXIT_FAILURE;
+        }
+        if (partial_path != NULL) {
+            return write_partial(arg_target_dirname, arg_naming_convention, NULL) ? 
+                   EXIT_SUCCESS : EXIT_FAILURE;
+        }
+        analyze_print_report(arg_naming_convention, strict_flag, arg_target_dirname, 
+                             changed_since_flag, matches, non_matches);
+        if (by_owner_flag) {
+            owners_print(&owner_counts, "non-matches");
+        }
+        if (stats_detail_flag) {
+            stats_print();
+        }
 
         return EXIT_SUCCESS;
     }
@@ -0,0 +1,223 @@
+/**********************************************************************************************
+*
+*   baseline - Saved sets of violations, suppressed by later scans.
+*
+*   LICENSE: zlib/libpng 
+*
+*   Copyright (c) 2024-2025 Josh Hayden (@BlinkDynamo)
+*
+*   This software is provided ‘as-is’, without any express or implied
+*   warranty. In no event will the authors be held liable for any damages
+*   arising from the use of this software.
+*
+*   Permission is granted to anyone to use this software for any purpose,
+*   including commercial applications, and to alter it and redistribute it
+*   freely, subject to the following restrictions:
+*
+*   1. The origin of this software must not be misrepresented; you must not
+*   claim that you wrote the original software. If you use this software
+*   in a product, an acknowledgment in the product documentation would be
+*   appreciated but is not required.
+*
+*   2. Altered source versions must be plainly marked as such, and must not be
+*   misrepresented as being the original software.
+*
+*   3. This notice may not be removed or altered from any source
+*   distribution. 
+*
+*   A violation is identified by the 64-bit hash of its path relative to the scanned directory,
+*   so a baseline stays valid when the tree is checked out elsewhere. Baselines are mapped
+*   rather than read, and looked up with an interpolation search, which takes a few probes
+*   even for millions of hashes because the hashes are uniformly distributed.
+*
+*********************************************************************************************/
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif // _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "common.h"
+#include "baseline.h"
+
+#define HEADER_SIZE (BASELINE_MAGIC_LEN + sizeof(uint64_t))
+
+bool baseline_load (struct Baseline *baseline, const char *path)
+/**********************************************************************************************
+*
+*   Maps a baseline file written by baseline_write() into memory.
+*
+*   ----------------------------------------- RETURNS -----------------------------------------
+*
+*   true if the file was mapped, or false after printing an error.
+*
+**********************************************************************************************/
+{
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        printf("Error: cannot open baseline file '%s' due to Error %d (%s).\n", 
+               path, errno, strerror(errno));
+        return false;
+    }
+
+    struct stat st;
+    uint64_t n_hashes = 0;
+    if (fstat(fd, &st) == -1 || (size_t)st.st_size < HEADER_SIZE) {
+        printf("Error: '%s' is not a baseline file.\n", path);
+        close(fd);
+        return false;
+    }
+
+    void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        printf("Error: cannot map baseline file '%s' due to Error %d (%s).\n", 
+               path, errno, strerror(errno));
+        return false;
+    }
+
+    memcpy(&n_hashes, (const char *)map + BASELINE_MAGIC_LEN, sizeof(n_hashes));
+    if (memcmp(map, BASELINE_MAGIC, BASELINE_MAGIC_LEN) != 0 ||
+        n_hashes != ((size_t)st.st_size - HEADER_SIZE) / sizeof(uint64_t) ||
+        ((size_t)st.st_size - HEADER_SIZE) % sizeof(uint64_t) != 0)
+    {
+        printf("Error: '%s' is not a baseline file.\n", path);
+        munmap(map, st.st_size);
+        return false;
+    }
+
+    // Lookups land on unrelated pages, so readahead around them would be wasted.
+    madvise(map, st.st_size, MADV_RANDOM);
+
+    baseline->map = map;
+    baseline->map_size = st.st_size;
+    baseline->hashes = (const uint64_t *)((const char *)map + HEADER_SIZE);
+    baseline->n_hashes = n_hashes;
+    return true;
+}
+
+bool baseline_contains (const struct Baseline *baseline, uint64_t hash)
+/**********************************************************************************************
+*
+*   Looks up a hash with an interpolation search, probing where the hash would be if the
+*   hashes between the bounds were evenly spaced. A probe that fails to halve the range is
+*   followed by a bisection, so a skewed baseline costs at most twice a binary search.
+*
+**********************************************************************************************/
+{
+    const uint64_t *hashes = baseline->hashes;
+    size_t low = 0;
+    size_t high = baseline->n_hashes;
+    bool bisect = false;
+
+    while (low < high)
+    {
+        size_t span = high - low;
+        size_t probe;
+        if (hash < hashes[low] || hash > hashes[high - 1]) {
+            return false;
+        }
+        if (bisect || hashes[high - 1] == hashes[low]) {
+            probe = low + span / 2;
+        }
+        else {
+            double fraction = (double)(hash - hashes[low]) / (double)(hashes[high - 1] - hashes[low]);
+            probe = low + (size_t)(fraction * (span - 1));
+            if (probe >= high) {
+                probe = high - 1;
+            }
+        }
+
+        if (hashes[probe] == hash) {
+            return true;
+        }
+        if (hashes[probe] < hash) {
+            low = probe + 1;
+        }
+        else {
+            high = probe;
+        }
+        bisect = (high - low) > span / 2;
+    }
+    return false;
+}
+
+void baseline_unload (struct Baseline *baseline)
+{
+    if (baseline->map != NULL) {
+        munmap(baseline->map, baseline->map_size);
+        baseline->map = NULL;
+    }
+}
+
+void baseline_add (struct BaselineWriter *writer, uint64_t hash)
+{
+    if (writer->n_hashes == writer->capacity) {
+        writer->capacity = (writer->capacity == 0) ? 1024 : writer->capacity * 2;
+        writer->hashes = xrealloc(writer->hashes, writer->capacity * sizeof(uint64_t));
+    }
+    writer->hashes[writer->n_hashes++] = hash;
+}
+
+static int compare_hashes (const void *a, const void *b)
+{
+    uint64_t hash_a = *(const uint64_t *)a;
+    uint64_t hash_b = *(const uint64_t *)b;
+    return (hash_a > hash_b) - (hash_a < hash_b);
+}
+
+bool baseline_write (struct BaselineWriter *writer, const char *path)
+/**********************************************************************************************
+*
+*   Sorts and deduplicates the recorded hashes and writes them to path. The file is written
+*   next to path and renamed over it, so a failed write never leaves a truncated baseline.
+*
+*   ----------------------------------------- RETURNS -----------------------------------------
+*
+*   true if the baseline was written, or false after printing an error.
+*
+**********************************************************************************************/
+{
+    qsort(writer->hashes, writer->n_hashes, sizeof(uint64_t), compare_hashes);
+    size_t n_unique = 0;
+    for (size_t i = 0; i < writer->n_hashes; i++)
+    {
+        if (n_unique == 0 || writer->hashes[n_unique - 1] != writer->hashes[i]) {
+            writer->hashes[n_unique++] = writer->hashes[i];
+        }
+    }
+    writer->n_hashes = n_unique;
+
+    size_t tmp_path_len = strlen(path) + sizeof(".tmp");
+    char *tmp_path = xrealloc(NULL, tmp_path_len);
+    snprintf(tmp_path, tmp_path_len, "%s.tmp", path);
+
+    uint64_t n_hashes = n_unique;
+    FILE *file = fopen(tmp_path, "wb");
+    bool written = (file != NULL) &&
+                   (fwrite(BASELINE_MAGIC, 1, BASELINE_MAGIC_LEN, file) == BASELINE_MAGIC_LEN) &&
+                   (fwrite(&n_hashes, sizeof(n_hashes), 1, file) == 1) &&
+                   (fwrite(writer->hashes, sizeof(uint64_t), n_unique, file) == n_unique);
+    if (file != NULL && fclose(file) != 0) {
+        written = false;
+    }
+    if (!written || rename(tmp_path, path) == -1) {
+        printf("Error: cannot write baseline file '%s' due to Error %d (%s).\n", 
+               path, errno, strerror(errno));
+        if (file != NULL) {
+            unlink(tmp_path);
+        }
+        free(tmp_path);
+        return false;
+    }
+    free(tmp_path);
+    return true;
+}
@@ -0,0 +1,447 @@
+/**********************************************************************************************
+*
+*   checkpoint - Saving the frontier of a scan, so that an interrupted scan can be resumed.
+*
+*   LICENSE: zlib/libpng 
+*
+*   Copyright (c) 2024-2025 Josh Hayden (@BlinkDynamo)
+*
+*   This software is provided ‘as-is’, without any express or implied
+*   warranty. In no event will the authors be held liable for any damages
+*   arising from the use of this software.
+*
+*   Permission is granted to anyone to use this software for any purpose,
+*   including commercial applications, and to alter it and redistribute it
+*   freely, subject to the following restrictions:
+*
+*   1. The origin of this software must not be misrepresented; you must not
+*   claim that you wrote the original software. If you use this software
+*   in a product, an acknowledgment in the product documentation would be
+*   appreciated but is not required.
+*
+*   2. Altered source versions must be plainly marked as such, and must not be
+*   misrepresented as being the original software.
+*
+*   3. This notice may not be removed or altered from any source
+*   distribution. 
+*
+*   -------------------------------- CHECKPOINT FILE FORMAT ----------------------------------
+*
+*   A "key value" line per field, starting with:
+*
+*       nc-scout-checkpoint 1
+*
+*   followed by the fields the command saved (what the scan is, its counters and the length
+*   of its output), and finally the directories still to be read:
+*
+*       pending N
+*       DEPTH LENGTH PATH       (N times, LENGTH being the bytes of PATH)
+*
+*********************************************************************************************/
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif // _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <linux/limits.h>
+
+#include "common.h"
+#include "checkpoint.h"
+#include "progress.h"
+
+static const char *checkpoint_path = NULL;
+static char *tmp_path = NULL;
+static double save_interval;
+static struct timespec last_save;
+static void (*save_state)(FILE *file);
+
+// The last SIGINT or SIGTERM received, to save a checkpoint at before exiting.
+static volatile sig_atomic_t received_signal = 0;
+static struct sigaction old_sigint;
+static struct sigaction old_sigterm;
+
+static double seconds_since (const struct timespec *start)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static void on_signal (int signal)
+{
+    received_signal = signal;
+}
+
+bool checkpoint_start (const char *path, double interval_seconds, 
+                       void (*write_state)(FILE *file))
+/**********************************************************************************************
+*
+*   Starts saving checkpoints to path every interval_seconds, from checkpoint_frontier(). A
+*   SIGINT or SIGTERM makes the next checkpoint_frontier() save one right away and exit.
+*
+*   ---------------------------------------- ARGUMENTS ----------------------------------------
+*
+*   path                The checkpoint file, replaced atomically by every save.
+*
+*   interval_seconds    The time between saves.
+*
+*   write_state         Writes the fields of the command: what is scanned, the counters so far,
+*                       and (with checkpoint_save_output()) the length of the output.
+*
+**********************************************************************************************/
+{
+    checkpoint_path = path;
+    save_interval = interval_seconds;
+    save_state = write_state;
+    size_t tmp_path_len = strlen(path) + sizeof(".tmp");
+    tmp_path = xrealloc(tmp_path, tmp_path_len);
+    snprintf(tmp_path, tmp_path_len, "%s.tmp", path);
+    clock_gettime(CLOCK_MONOTONIC, &last_save);
+
+    struct sigaction action = {.sa_handler = on_signal, .sa_flags = SA_RESTART};
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, &old_sigint);
+    sigaction(SIGTERM, &action, &old_sigterm);
+    return true;
+}
+
+static bool save (const struct TraversePending *pending, size_t n_pending)
+{
+    FILE *file = fopen(tmp_path, "w");
+    if (file == NULL) {
+        printf("Error: cannot write checkpoint '%s' due to Error %d (%s).\n", 
+               checkpoint_path, errno, strerror(errno));
+        return false;
+    }
+    fprintf(file, "%s\n", CHECKPOINT_MAGIC);
+    save_state(file);
+    fprintf(file, "pending %zu\n", n_pending);
+    for (size_t i = 0; i < n_pending; i++)
+    {
+        fprintf(file, "%d %zu %s\n", pending[i].depth, strlen(pending[i].abs_path), 
+                pending[i].abs_path);
+    }
+
+    // The checkpoint must be on disk before it replaces the previous one.
+    bool written = (fflush(file) == 0) && (fsync(fileno(file)) == 0) && !ferror(file);
+    if (fclose(file) != 0) {
+        written = false;
+    }
+    if (!written || rename(tmp_path, checkpoint_path) == -1) {
+        printf("Error: cannot write checkpoint '%s' due to Error %d (%s).\n", 
+               checkpoint_path, errno, strerror(errno));
+        unlink(tmp_path);
+        return false;
+    }
+    return true;
+}
+
+void checkpoint_frontier (const struct TraversePending *pending, size_t n_pending)
+/**********************************************************************************************
+*
+*   The frontier function of a traversal with checkpoints. Saves one if the interval has
+*   passed, or if a signal was received, in which case the process then exits.
+*
+**********************************************************************************************/
+{
+    int signal = received_signal;
+    if (signal == 0 && seconds_since(&last_save) < save_interval) {
+        return;
+    }
+    bool saved = save(pending, n_pending);
+    clock_gettime(CLOCK_MONOTONIC, &last_save);
+    if (signal != 0) {
+        if (saved) {
+            fprintf(stderr, "Interrupted. Continue the scan with --resume %s.\n", checkpoint_path);
+        }
+        fflush(stdout);
+        exit(128 + signal);
+    }
+}
+
+void checkpoint_finish (bool completed)
+/**********************************************************************************************
+*
+*   Stops saving checkpoints. The checkpoint file is removed once the scan has completed, as
+*   there is nothing left to resume.
+*
+**********************************************************************************************/
+{
+    if (checkpoint_path == NULL) {
+        return;
+    }
+    sigaction(SIGINT, &old_sigint, NULL);
+    sigaction(SIGTERM, &old_sigterm, NULL);
+    if (completed) {
+        unlink(checkpoint_path);
+    }
+    checkpoint_path = NULL;
+}
+
+static bool read_error (struct Checkpoint *checkpoint, FILE *file, const char *reason)
+{
+    printf("Error: '%s' is not a checkpoint file (%s).\n", checkpoint->path, reason);
+    fclose(file);
+    return false;
+}
+
+bool checkpoint_read (struct Checkpoint *checkpoint, const char *path)
+/**********************************************************************************************
+*
+*   Reads a checkpoint file saved by checkpoint_frontier().
+*
+*   ----------------------------------------- RETURNS -----------------------------------------
+*
+*   true if the checkpoint was read, or false after printing an error.
+*
+**********************************************************************************************/
+{
+    memset(checkpoint, 0, sizeof(*checkpoint));
+    checkpoint->path = path;
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        printf("Error: cannot open checkpoint '%s' due to Error %d (%s).\n", 
+               path, errno, strerror(errno));
+        return false;
+    }
+
+    char *line = NULL;
+    size_t line_capacity = 0;
+    ssize_t len;
+    bool first = true;
+    bool has_pending = false;
+    while (!has_pending && (len = getline(&line, &line_capacity, file)) != -1)
+    {
+        if (len > 0 && line[len - 1] == '\n') {
+            line[--len] = '\0';
+        }
+        if (first) {
+            first = false;
+            if (strcmp(line, CHECKPOINT_MAGIC) != 0) {
+                free(line);
+                return read_error(checkpoint, file, "unknown first line");
+            }
+            continue;
+        }
+        if (sscanf(line, "pending %zu", &checkpoint->n_pending) == 1) {
+            has_pending = true;
+            continue;
+        }
+
+        char *separator = strchr(line, ' ');
+        if (separator == NULL) {
+            free(line);
+            return read_error(checkpoint, file, "field without a value");
+        }
+        *separator = '\0';
+        checkpoint->fields = xrealloc(checkpoint->fields, 
+                                      (checkpoint->n_fields + 1) * sizeof(struct CheckpointField));
+        checkpoint->fields[checkpoint->n_fields].key = strdup(line);
+        checkpoint->fields[checkpoint->n_fields].value = strdup(separator + 1);
+        checkpoint->n_fields++;
+    }
+    free(line);
+    if (!has_pending) {
+        return read_error(checkpoint, file, "no pending directories");
+    }
+
+    // Paths are read by length, as they can hold any byte but '\0'.
+    checkpoint->pending = xrealloc(NULL, (checkpoint->n_pending + 1) * sizeof(struct TraversePending));
+    for (size_t i = 0; i < checkpoint->n_pending; i++)
+    {
+        struct TraversePending *pending = &checkpoint->pending[i];
+        size_t path_len;
+        if (fscanf(file, "%d %zu", &pending->depth, &path_len) != 2 || fgetc(file) != ' ' ||
+            path_len >= PATH_MAX) {
+            return read_error(checkpoint, file, "invalid pending directory");
+        }
+        pending->abs_path = xrealloc(NULL, path_len + 1);
+        if (fread(pending->abs_path, 1, path_len, file) != path_len || fgetc(file) != '\n') {
+            return read_error(checkpoint, file, "truncated pending directory");
+        }
+        pending->abs_path[path_len] = '\0';
+    }
+    fclose(file);
+    return true;
+}
+
+// Returns the value of the first field with key, or NULL.
+const char *checkpoint_get (const struct Checkpoint *checkpoint, const char *key)
+{
+    for (int i = 0; i < checkpoint->n_fields; i++)
+    {
+        if (strcmp(checkpoint->fields[i].key, key) == 0) {
+            return checkpoint->fields[i].value;
+        }
+    }
+    return NULL;
+}
+
+// Checks that the field key of the checkpoint is value, printing an error if it is not.
+bool checkpoint_expect (const struct Checkpoint *checkpoint, const char *key, const char *value)
+{
+    const char *saved = checkpoint_get(checkpoint, key);
+    if (saved == NULL || strcmp(saved, value) != 0) {
+        printf("Error: '%s' is a checkpoint of a different scan (its %s differs).\n", 
+               checkpoint->path, key);
+        return false;
+    }
+    return true;
+}
+
+void checkpoint_save_counters (FILE *file, const struct PolicyTable *table, unsigned long matches,
+                               unsigned long non_matches, unsigned long non_policy_entries)
+/**********************************************************************************************
+*
+*   Writes the counters of a scan to the checkpoint file: its matches and non-matches, per
+*   policy if table is not NULL, and the progress_counters behind --progress and the metrics.
+*
+**********************************************************************************************/
+{
+    if (table == NULL) {
+        fprintf(file, "matches %lu\n", matches);
+        fprintf(file, "non-matches %lu\n", non_matches);
+    }
+    else {
+        for (int i = 0; i < table->n_policies; i++)
+        {
+            fprintf(file, "policy %lu %lu\n", table->policies[i].matches, 
+                    table->policies[i].non_matches);
+        }
+        fprintf(file, "non-policy %lu\n", non_policy_entries);
+    }
+    fprintf(file, "progress %lu %lu %lu %lu %lu %lu\n", progress_counters.dirs, 
+            progress_counters.entries, progress_counters.violations, progress_counters.errors,
+            progress_counters.verdict_hits, progress_counters.verdict_misses);
+}
+
+bool checkpoint_restore_counters (const struct Checkpoint *checkpoint, struct PolicyTable *table,
+                                  unsigned long *matches, unsigned long *non_matches,
+                                  unsigned long *non_policy_entries)
+/**********************************************************************************************
+*
+*   Restores the counters saved by checkpoint_save_counters(). table is the policy table of a
+*   policy scan, or NULL.
+*
+*   ----------------------------------------- RETURNS -----------------------------------------
+*
+*   true if every counter was restored, otherwise false after printing an error.
+*
+**********************************************************************************************/
+{
+    bool valid;
+    if (table == NULL) {
+        const char *saved_matches = checkpoint_get(checkpoint, "matches");
+        const char *saved_non_matches = checkpoint_get(checkpoint, "non-matches");
+        valid = (saved_matches != NULL && saved_non_matches != NULL &&
+                 sscanf(saved_matches, "%lu", matches) == 1 &&
+                 sscanf(saved_non_matches, "%lu", non_matches) == 1);
+    }
+    else {
+        int policy_index = 0;
+        for (int i = 0; i < checkpoint->n_fields; i++)
+        {
+            if (strcmp(checkpoint->fields[i].key, "policy") != 0) {
+                continue;
+            }
+            if (policy_index == table->n_policies) {
+                break;
+            }
+            struct Policy *policy = &table->policies[policy_index++];
+            if (sscanf(checkpoint->fields[i].value, "%lu %lu", 
+                       &policy->matches, &policy->non_matches) != 2) {
+                break;
+            }
+        }
+        const char *saved_non_policy = checkpoint_get(checkpoint, "non-policy");
+        valid = (policy_index == table->n_policies && saved_non_policy != NULL &&
+                 sscanf(saved_non_policy, "%lu", non_policy_entries) == 1);
+    }
+    const char *saved_progress = checkpoint_get(checkpoint, "progress");
+    valid = valid && saved_progress != NULL &&
+            sscanf(saved_progress, "%lu %lu %lu %lu %lu %lu", &progress_counters.dirs, 
+                   &progress_counters.entries, &progress_counters.violations, 
+                   &progress_counters.errors, &progress_counters.verdict_hits, 
+                   &progress_counters.verdict_misses) == 6;
+    if (!valid) {
+        printf("Error: '%s' is not a checkpoint file (missing or invalid counters).\n", 
+               checkpoint->path);
+    }
+    return valid;
+}
+
+static bool output_size (FILE *output, off_t *size)
+{
+    struct stat st;
+    if (fflush(output) != 0 || fstat(fileno(output), &st) == -1 || !S_ISREG(st.st_mode)) {
+        printf("Error: `--checkpoint` and `--resume` need the output written to a file, "
+               "such as with `>> FILE`.\n");
+        return false;
+    }
+    *size = st.st_size;
+    return true;
+}
+
+bool checkpoint_save_output (FILE *file, FILE *output)
+/**********************************************************************************************
+*
+*   Flushes output and writes its length to the checkpoint file, as "output-offset". With
+*   file NULL, only checks that output is a regular file, as it must be for checkpoints.
+*
+*   ----------------------------------------- RETURNS -----------------------------------------
+*
+*   true if output is a regular file, or false after printing an error.
+*
+**********************************************************************************************/
+{
+    off_t size;
+    if (!output_size(output, &size)) {
+        return false;
+    }
+    if (file != NULL) {
+        fprintf(file, "output-offset %lld\n", (long long)size);
+    }
+    return true;
+}
+
+bool checkpoint_restore_output (const struct Checkpoint *checkpoint, FILE *output)
+/**********************************************************************************************
+*
+*   Cuts output back to the length saved with the checkpoint, so that the output written after
+*   the checkpoint, which the resumed scan writes again, is not duplicated.
+*
+*   ----------------------------------------- RETURNS -----------------------------------------
+*
+*   true if output now ends where the checkpoint was saved, or false after printing an error.
+*
+**********************************************************************************************/
+{
+    const char *saved = checkpoint_get(checkpoint, "output-offset");
+    if (saved == NULL) {
+        printf("Error: '%s' is not a checkpoint file (no output-offset).\n", checkpoint->path);
+        return false;
+    }
+    off_t size;
+    if (!output_size(output, &size)) {
+        return false;
+    }
+    off_t offset = (off_t)strtoll(saved, NULL, 10);
+    if (size < offset) {
+        printf("Error: the output holds %lld bytes but had %lld at the checkpoint. Append to it "
+               "with `>> FILE` when resuming.\n", (long long)size, (long long)offset);
+        return false;
+    }
+    if (ftruncate(fileno(output), offset) == -1 || fseeko(output, offset, SEEK_SET) == -1) {
+        printf("Error: cannot restore the output due to Error %d (%s).\n", errno, strerror(errno));
+        return false;
+    }
+    return true;
+}
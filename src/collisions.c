@@ -0,0 +1,285 @@
+/**********************************************************************************************
+*
+*   collisions - Handles options, validation, and runtime of the nc-scout collisions subcommand.
+*
+*   LICENSE: zlib/libpng
+*
+*   Copyright (c) 2024-2025 Josh Hayden (@BlinkDynamo)
+*
+*   This software is provided ‘as-is’, without any express or implied
+*   warranty. In no event will the authors be held liable for any damages
+*   arising from the use of this software.
+*
+*   Permission is granted to anyone to use this software for any purpose,
+*   including commercial applications, and to alter it and redistribute it
+*   freely, subject to the following restrictions:
+*
+*   1. The origin of this software must not be misrepresented; you must not
+*   claim that you wrote the original software. If you use this software
+*   in a product, an acknowledgment in the product documentation would be
+*   appreciated but is not required.
+*
+*   2. Altered source versions must be plainly marked as such, and must not be
+*   misrepresented as being the original software.
+*
+*   3. This notice may not be removed or altered from any source
+*   distribution.
+*
+*********************************************************************************************/
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif // _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <getopt.h>
+#include <linux/limits.h>
+
+#include "help.h"
+#include "validate.h"
+#include "common.h"
+#include "naming.h"
+#include "traverse.h"
+#include "collisions.h"
+
+#define N_REQUIRED_ARGS 1
+#define MIN_TABLE_SIZE  64
+
+// Flags.
+static bool full_path_flag  = false;
+static bool recursive_flag  = false;
+
+static const char *abs_initial_path = NULL;
+
+// A slot of the table. Slots of an older generation are empty, which clears the whole table
+// between directories without touching it.
+struct Slot {
+    uint64_t hash;
+    uint32_t generation;
+    uint32_t key_offset;    // Offset of the canonical form in keys.
+    int last;               // Index in entries of the last entry with this key.
+};
+
+// The table of the current directory. It only ever grows to fit the largest directory.
+static struct Slot *slots = NULL;
+static uint32_t slots_mask = 0;
+static uint32_t n_used_slots = 0;
+static uint32_t generation = 1;
+
+// Canonical sequences of the current directory.
+static char *keys = NULL;
+static size_t keys_len = 0;
+static size_t keys_capacity = 0;
+
+// Entries of the current directory, chained by the key they share. The first entry of every
+// chain is marked, so printing the groups needs no second lookup of their keys.
+static struct {
+    const char *name;
+    int next;
+    bool first;
+} *entries = NULL;
+static int n_entries = 0;
+static int entries_capacity = 0;
+
+static struct Slot *find_slot (uint64_t hash, const char *key)
+{
+    uint32_t i = hash & slots_mask;
+    while (slots[i].generation == generation &&
+           (slots[i].hash != hash || strcmp(keys + slots[i].key_offset, key) != 0))
+    {
+        i = (i + 1) & slots_mask;
+    }
+    return &slots[i];
+}
+
+// Doubles the table, moving the slots of the current generation over.
+static void grow_table (void)
+{
+    struct Slot *old_slots = slots;
+    uint32_t old_size = (slots == NULL) ? 0 : slots_mask + 1;
+    uint32_t size = (old_size == 0) ? MIN_TABLE_SIZE : old_size * 2;
+
+    slots = xcalloc(size, sizeof(struct Slot));
+    slots_mask = size - 1;
+    for (uint32_t i = 0; i < old_size; i++)
+    {
+        if (old_slots[i].generation == generation) {
+            *find_slot(old_slots[i].hash, keys + old_slots[i].key_offset) = old_slots[i];
+        }
+    }
+    free(old_slots);
+}
+
+static void process_current_file (const struct TraverseEntry *current_file,
+                                  const struct TraverseDir *current_dir, void *context)
+/**********************************************************************************************
+*
+*   Normalizes a d_name to its canonical form and adds it to the table of the current
+*   directory, chaining it to the entries with the same form.
+*
+**********************************************************************************************/
+{
+    (void)current_dir;
+    (void)context;
+    char key[NAME_MAX * 2 + 2];
+    size_t key_len = naming_normalize(current_file->name, key, sizeof(key));
+    uint64_t hash = hash_string(key);
+
+    if ((n_used_slots + 1) * 2 > ((slots == NULL) ? 0 : slots_mask + 1)) {
+        grow_table();
+    }
+    if (n_entries == entries_capacity) {
+        entries_capacity = (entries_capacity == 0) ? 64 : entries_capacity * 2;
+        entries = xrealloc(entries, entries_capacity * sizeof(*entries));
+    }
+    int index = n_entries++;
+    entries[index].name = current_file->name;
+    entries[index].next = -1;
+
+    struct Slot *slot = find_slot(hash, key);
+    entries[index].first = (slot->generation != generation);
+    if (entries[index].first) {
+        if (keys_len + key_len + 1 > keys_capacity) {
+            keys_capacity = (keys_capacity + key_len + 1) * 2;
+            keys = xrealloc(keys, keys_capacity);
+        }
+        memcpy(keys + keys_len, key, key_len + 1);
+        *slot = (struct Slot){hash, generation, keys_len, index};
+        keys_len += key_len + 1;
+        n_used_slots++;
+    }
+    else {
+        entries[slot->last].next = index;
+        slot->last = index;
+    }
+}
+
+static void print_entry (const struct TraverseDir *current_dir, const char *name, bool first)
+{
+    if (full_path_flag) {
+        printf("%s%s/%s", (first) ? "" : "\t", current_dir->abs_path, name);
+    }
+    else {
+        const char *relative_path = get_relative_path(abs_initial_path, current_dir->abs_path);
+        printf("%s%s%s%s", (first) ? "" : "\t", relative_path, (*relative_path) ? "/" : "", name);
+    }
+}
+
+static void finish_current_dir (const struct TraverseDir *current_dir, void *context)
+/**********************************************************************************************
+*
+*   Prints every group of colliding entries of the current directory on one line, in the
+*   order their first entries were read, then clears the table for the next directory.
+*
+**********************************************************************************************/
+{
+    (void)context;
+    for (int i = 0; i < n_entries; i++)
+    {
+        if (!entries[i].first || entries[i].next == -1) {
+            continue;
+        }
+        for (int j = i; j != -1; j = entries[j].next)
+        {
+            print_entry(current_dir, entries[j].name, j == i);
+        }
+        printf("\n");
+    }
+
+    generation++;
+    n_used_slots = 0;
+    n_entries = 0;
+    keys_len = 0;
+}
+
+int subc_exec_collisions (int argc, char *argv[])
+/**********************************************************************************************
+*
+*   The external function called from src/main.c. Processes options, does validation, and
+*   finally traverses the directory, printing entries that collide in each directory.
+*
+*   ---------------------------------------- ARGUMENTS ----------------------------------------
+*
+*   argc    The argc of main() in src/main.c with 1 removed.
+*
+*   argv    The argv of main() in src/main.c with "nc-scout" removed from the beginning.
+*
+*   ----------------------------------------- RETURNS -----------------------------------------
+*
+*   It inherrits the return of main() in src/main.c, returning EXIT_FAILURE or EXIT_SUCCESS.
+*
+**********************************************************************************************/
+{
+    int current_opt;
+    while (1)
+    {
+        static struct option long_options_collisions[] =
+        {
+            {"help", no_argument, 0, 'h'},
+            {"full-path", no_argument, 0, 'f'}, 
+            {"recursive", no_argument, 0, 'R'},
+            {0, 0, 0, 0}
+        };
+        
+        int option_index = 0;
+        current_opt = getopt_long (argc, argv, "+hfR", long_options_collisions, &option_index);
+        // Break if at the end of the options.
+        if (current_opt == -1) {
+            break;
+        }
+
+        switch (current_opt)
+        {
+            case '?':
+                return EXIT_FAILURE;
+
+            case 'h':
+                // Make sure that there are no arguments supplied.
+                if (argc == 2) {
+                    printf("%s", HELP_COLLISIONS);
+                    return EXIT_SUCCESS;
+                }
+                else {
+                    printf("Incorrect usage.\nDo `nc-scout collisions --help` for more information about usage.\n");
+                    return EXIT_FAILURE;
+                }
+
+            case 'f':
+                full_path_flag = true;
+                break;
+
+            case 'R':
+                recursive_flag = true;
+                break;
+
+            default:
+                abort();
+        }
+    }
+
+    int non_option_argc = argc - optind;
+    if (non_option_argc < N_REQUIRED_ARGS) {
+        printf("Insufficient arguments.\nDo `nc-scout collisions --help` for more information about usage.\n");
+        return EXIT_FAILURE;
+    }
+
+    const char *arg_target_dirname = argv[optind];
+
+    if ((validate_file_exists(arg_target_dirname)) && 
+        (validate_file_is_dir(arg_target_dirname)))
+    {
+        abs_initial_path = canonicalize_file_name(arg_target_dirname);
+        struct Traversal traversal = {
+            .recursive = recursive_flag,
+            .include_symlinks = true,
+            .visit = process_current_file,
+            .finish_dir = finish_current_dir,
+        };
+        traverse_tree(&traversal, abs_initial_path);
+        return EXIT_SUCCESS;
+    }
+    return EXIT_FAILURE;
+}
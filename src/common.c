@@ -27,6 +27,12 @@
 *
 *********************************************************************************************/
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "common.h"
+
 // Returns the difference of an absolute initial path and an absolute current path.
 const char *get_relative_path (const char *abs_initial_path, const char *abs_current_path)
 {
@@ -40,6 +46,56 @@ const char *get_relative_path (const char *abs_initial_path, const char *abs_cur
 }
 
 // Returns a float of num_a / num_b, unless num_b is 0, in which case it returns 0.0.
-double percentage(int num_a, int num_b) {
+double percentage(unsigned long num_a, unsigned long num_b) {
     return (num_b) == 0 ? 0.0 : (num_a * 100.0) / (num_b); 
 }
+
+// Returns the 64-bit FNV-1a hash of a NUL-terminated string.
+uint64_t hash_string (const char *str)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    while (*str)
+    {
+        hash ^= (unsigned char)*str++;
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+// Advances a xorshift64* generator, returning the next pseudo-random number. *state must not be 0.
+uint64_t random_next (uint64_t *state)
+{
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return x * 0x2545f4914f6cdd1dULL;
+}
+
+// Prints an error and exits. Called wherever memory is exhausted.
+void out_of_memory (void)
+{
+    printf("Error: out of memory.\n");
+    exit(EXIT_FAILURE);
+}
+
+// Reallocates ptr to size bytes, exiting after printing an error if memory is exhausted.
+void *xrealloc (void *ptr, size_t size)
+{
+    ptr = realloc(ptr, size);
+    if (ptr == NULL) {
+        out_of_memory();
+    }
+    return ptr;
+}
+
+// Allocates n zeroed elements of size bytes (at least one), exiting if memory is exhausted.
+void *xcalloc (size_t n, size_t size)
+{
+    void *ptr = calloc(n ? n : 1, size);
+    if (ptr == NULL) {
+        out_of_memory();
+    }
+    return ptr;
+}
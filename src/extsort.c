@@ -0,0 +1,331 @@
+/**********************************************************************************************
+*
+*   extsort - Sorting lines within a memory budget, spilling sorted runs to temporary files.
+*
+*   LICENSE: zlib/libpng 
+*
+*   Copyright (c) 2024-2025 Josh Hayden (@BlinkDynamo)
+*
+*   This software is provided ‘as-is’, without any express or implied
+*   warranty. In no event will the authors be held liable for any damages
+*   arising from the use of this software.
+*
+*   Permission is granted to anyone to use this software for any purpose,
+*   including commercial applications, and to alter it and redistribute it
+*   freely, subject to the following restrictions:
+*
+*   1. The origin of this software must not be misrepresented; you must not
+*   claim that you wrote the original software. If you use this software
+*   in a product, an acknowledgment in the product documentation would be
+*   appreciated but is not required.
+*
+*   2. Altered source versions must be plainly marked as such, and must not be
+*   misrepresented as being the original software.
+*
+*   3. This notice may not be removed or altered from any source
+*   distribution. 
+*
+*********************************************************************************************/
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif // _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/types.h>
+
+#include "common.h"
+#include "extsort.h"
+
+// The next line of an input of a merge, without its '\n' or length.
+struct MergeHead {
+    FILE *file;
+    char *line;
+    size_t capacity;
+    ssize_t len;
+};
+
+// The bytes the offsets being sorted point into, as qsort() passes no context.
+static const char *compare_bytes = NULL;
+
+static int compare_lines (const void *a, const void *b)
+{
+    return strcmp(compare_bytes + *(const size_t *)a, compare_bytes + *(const size_t *)b);
+}
+
+static void sort_lines (struct ExtSort *sort)
+{
+    compare_bytes = sort->bytes;
+    qsort(sort->lines, sort->n_lines, sizeof(size_t), compare_lines);
+}
+
+static void write_line (FILE *out, const char *line, size_t len, bool to_run)
+{
+    // Runs hold each line after its length rather than before a '\n', as a name may hold one.
+    if (to_run) {
+        fwrite(&len, sizeof(len), 1, out);
+        fwrite(line, 1, len, out);
+    }
+    else {
+        fwrite(line, 1, len, out);
+        fputc('\n', out);
+    }
+}
+
+static void write_lines (const struct ExtSort *sort, FILE *out, bool to_run)
+{
+    for (size_t i = 0; i < sort->n_lines; i++)
+    {
+        const char *line = sort->bytes + sort->lines[i];
+        write_line(out, line, strlen(line), to_run);
+    }
+}
+
+static bool read_head (struct MergeHead *head, bool from_run)
+{
+    // Reads the next line of an input, a run or a file of lines, returning false at its end.
+    if (from_run) {
+        size_t len;
+        if (fread(&len, sizeof(len), 1, head->file) != 1) {
+            return false;
+        }
+        if (len + 1 > head->capacity) {
+            head->capacity = len + 1;
+            head->line = xrealloc(head->line, head->capacity);
+        }
+        if (fread(head->line, 1, len, head->file) != len) {
+            return false;
+        }
+        head->line[len] = '\0';
+        head->len = (ssize_t)len;
+        return true;
+    }
+    head->len = getline(&head->line, &head->capacity, head->file);
+    if (head->len <= 0) {
+        return false;
+    }
+    if (head->line[head->len - 1] == '\n') {
+        head->line[--head->len] = '\0';
+    }
+    return true;
+}
+
+static void sift_down (struct MergeHead *heap, int n_heap, int i)
+{
+    while (true)
+    {
+        int smallest = i;
+        int left = 2 * i + 1;
+        int right = left + 1;
+        if (left < n_heap && strcmp(heap[left].line, heap[smallest].line) < 0) {
+            smallest = left;
+        }
+        if (right < n_heap && strcmp(heap[right].line, heap[smallest].line) < 0) {
+            smallest = right;
+        }
+        if (smallest == i) {
+            return;
+        }
+        struct MergeHead swap = heap[i];
+        heap[i] = heap[smallest];
+        heap[smallest] = swap;
+        i = smallest;
+    }
+}
+
+static bool merge_inputs (FILE **inputs, int n_inputs, bool from_runs, FILE *out, bool to_run)
+/**********************************************************************************************
+*
+*   Merges inputs that are each sorted into out, keeping the next line of every input on a
+*   binary heap, so that each line written costs O(log n_inputs) comparisons. from_runs and
+*   to_run say whether the inputs and out are runs, or files of lines.
+*
+*   ----------------------------------------- RETURNS -----------------------------------------
+*
+*   false if an input could not be read, after printing an error, otherwise true.
+*
+**********************************************************************************************/
+{
+    struct MergeHead *heap = xrealloc(NULL, (n_inputs > 0 ? n_inputs : 1) * sizeof(struct MergeHead));
+    int n_heap = 0;
+    for (int i = 0; i < n_inputs; i++)
+    {
+        heap[n_heap] = (struct MergeHead){.file = inputs[i]};
+        if (read_head(&heap[n_heap], from_runs)) {
+            n_heap++;
+        }
+        else {
+            free(heap[n_heap].line);
+        }
+    }
+    for (int i = n_heap / 2; i-- > 0; )
+    {
+        sift_down(heap, n_heap, i);
+    }
+
+    while (n_heap > 0)
+    {
+        write_line(out, heap[0].line, (size_t)heap[0].len, to_run);
+        if (!read_head(&heap[0], from_runs)) {
+            free(heap[0].line);
+            heap[0] = heap[--n_heap];
+        }
+        sift_down(heap, n_heap, 0);
+    }
+    free(heap);
+
+    for (int i = 0; i < n_inputs; i++)
+    {
+        if (ferror(inputs[i])) {
+            printf("Error: cannot read back the lines being sorted.\n");
+            return false;
+        }
+    }
+    return true;
+}
+
+static FILE *create_run (void)
+{
+    FILE *run = tmpfile();
+    if (run == NULL) {
+        printf("Error: cannot create a temporary file for --sort due to Error %d (%s).\n", 
+               errno, strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+    return run;
+}
+
+static void finish_run (FILE *run)
+{
+    if (fflush(run) != 0 || ferror(run) || fseeko(run, 0, SEEK_SET) != 0) {
+        printf("Error: cannot write a temporary file for --sort due to Error %d (%s).\n", 
+               errno, strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+}
+
+static void merge_last_runs (struct ExtSort *sort, int n)
+{
+    // Replaces the last n runs with one run of their merged lines, a level above the first.
+    int first = sort->n_runs - n;
+    FILE *merged = create_run();
+    if (!merge_inputs(sort->runs + first, n, true, merged, true)) {
+        exit(EXIT_FAILURE);
+    }
+    finish_run(merged);
+    for (int i = first; i < sort->n_runs; i++)
+    {
+        fclose(sort->runs[i]);
+    }
+    sort->runs[first] = merged;
+    sort->levels[first]++;
+    sort->n_runs = first + 1;
+}
+
+static void spill (struct ExtSort *sort)
+/**********************************************************************************************
+*
+*   Sorts the lines held in memory into a new run on disk, and empties the memory. Runs are
+*   merged in levels: once EXTSORT_MERGE_WIDTH runs share a level, they become one run of the
+*   next, so each line is rewritten a logarithmic number of times however many are added. The
+*   runs are kept from the highest level down, and should EXTSORT_MAX_RUNS still be reached,
+*   they are all merged into one.
+*
+**********************************************************************************************/
+{
+    if (sort->n_runs == EXTSORT_MAX_RUNS) {
+        merge_last_runs(sort, sort->n_runs);
+    }
+
+    FILE *run = create_run();
+    sort_lines(sort);
+    write_lines(sort, run, true);
+    finish_run(run);
+    sort->levels[sort->n_runs] = 0;
+    sort->runs[sort->n_runs++] = run;
+    sort->n_bytes = 0;
+    sort->n_lines = 0;
+
+    while (sort->n_runs >= EXTSORT_MERGE_WIDTH &&
+           sort->levels[sort->n_runs - EXTSORT_MERGE_WIDTH] == sort->levels[sort->n_runs - 1])
+    {
+        merge_last_runs(sort, EXTSORT_MERGE_WIDTH);
+    }
+}
+
+void extsort_start (struct ExtSort *sort, size_t budget)
+{
+    // Starts an empty sort that holds about budget bytes of lines in memory.
+    memset(sort, 0, sizeof(*sort));
+    sort->budget = budget;
+}
+
+void extsort_add (struct ExtSort *sort, const char *line)
+/**********************************************************************************************
+*
+*   Adds a line (without its '\n') to be sorted, spilling the lines held in memory to a run
+*   on disk first if it would not fit in the budget.
+*
+**********************************************************************************************/
+{
+    size_t size = strlen(line) + 1;
+    if (sort->n_lines > 0 && 
+        sort->n_bytes + size + (sort->n_lines + 1) * sizeof(size_t) > sort->budget) {
+        spill(sort);
+    }
+    if (sort->n_bytes + size > sort->bytes_capacity) {
+        sort->bytes_capacity = (sort->n_bytes + size) * 2;
+        sort->bytes = xrealloc(sort->bytes, sort->bytes_capacity);
+    }
+    if (sort->n_lines == sort->lines_capacity) {
+        sort->lines_capacity = (sort->lines_capacity == 0) ? 1024 : sort->lines_capacity * 2;
+        sort->lines = xrealloc(sort->lines, sort->lines_capacity * sizeof(size_t));
+    }
+    memcpy(sort->bytes + sort->n_bytes, line, size);
+    sort->lines[sort->n_lines++] = sort->n_bytes;
+    sort->n_bytes += size;
+}
+
+bool extsort_finish (struct ExtSort *sort, FILE *out)
+/**********************************************************************************************
+*
+*   Writes every line added, in order, to out, then frees the sort. Lines that never left
+*   memory are written straight from it; otherwise they are spilled as a last run, and the
+*   runs merged.
+*
+*   ----------------------------------------- RETURNS -----------------------------------------
+*
+*   false if a run could not be read back, after printing an error, otherwise true.
+*
+**********************************************************************************************/
+{
+    bool written = true;
+    if (sort->n_runs == 0) {
+        sort_lines(sort);
+        write_lines(sort, out, false);
+    }
+    else {
+        if (sort->n_lines > 0) {
+            spill(sort);
+        }
+        written = merge_inputs(sort->runs, sort->n_runs, true, out, false);
+        for (int i = 0; i < sort->n_runs; i++)
+        {
+            fclose(sort->runs[i]);
+        }
+    }
+    free(sort->bytes);
+    free(sort->lines);
+    memset(sort, 0, sizeof(*sort));
+    return written;
+}
+
+bool extsort_merge (FILE **inputs, int n_inputs, FILE *out)
+{
+    // Merges files of sorted lines into out. Used by the merge subcommand to combine the sorted
+    // outputs of the shards of a search.
+    return merge_inputs(inputs, n_inputs, false, out, false);
+}
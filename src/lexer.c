@@ -0,0 +1,997 @@
+/**********************************************************************************************
+*
+*   lexer - Extraction and classification of the identifiers declared in source files.
+*
+*   LICENSE: zlib/libpng 
+*
+*   Copyright (c) 2024-2025 Josh Hayden (@BlinkDynamo)
+*
+*   This software is provided ‘as-is’, without any express or implied
+*   warranty. In no event will the authors be held liable for any damages
+*   arising from the use of this software.
+*
+*   Permission is granted to anyone to use this software for any purpose,
+*   including commercial applications, and to alter it and redistribute it
+*   freely, subject to the following restrictions:
+*
+*   1. The origin of this software must not be misrepresented; you must not
+*   claim that you wrote the original software. If you use this software
+*   in a product, an acknowledgment in the product documentation would be
+*   appreciated but is not required.
+*
+*   2. Altered source versions must be plainly marked as such, and must not be
+*   misrepresented as being the original software.
+*
+*   3. This notice may not be removed or altered from any source
+*   distribution. 
+*
+*   --------------------------------------- HEURISTICS ---------------------------------------
+*
+*   The lexers skip comments, string literals and numbers, and only report identifiers where
+*   they are declared, recognized from the tokens around them rather than by parsing:
+*
+*   C        'TYPE NAME (' outside of any braces is a function, '#define NAME' a macro,
+*            'struct NAME {' (or union or enum) and the name a typedef ends with a type, and
+*            'TYPE NAME' or 'TYPE *NAME' followed by '=', ';', ',' or '[' a variable (or a
+*            parameter).
+*
+*   Python   'def NAME' is a function, 'class NAME' a type, and NAME at the start of a
+*            statement followed by '=' or ':', a parameter of a def, or the target of a 'for'
+*            a variable.
+*
+*   Shell    'function NAME' and 'NAME ()' are functions, and 'NAME=' at the start of a command
+*            or after local, export, declare, readonly or typeset, and the target of a 'for'
+*            are variables.
+*
+*   Comments and string literals are skipped by searching for the few bytes that can end them,
+*   16 bytes at a time where SSE2 is available.
+*
+*********************************************************************************************/
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif // _GNU_SOURCE
+
+#include <stdbool.h>
+#include <string.h>
+#include <strings.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif // __SSE2__
+
+#include "lexer.h"
+
+// Where a token came from, for the lexers that look back at previous tokens.
+enum TokenType {
+    TOKEN_NONE,         // The start of a file, or of a statement after a preprocessor line.
+    TOKEN_IDENTIFIER,
+    TOKEN_PUNCTUATION,
+    TOKEN_LITERAL,      // A string or a number.
+};
+
+// Keywords of C that matter to what an identifier next to them is.
+enum Keyword {
+    KEYWORD_NONE,
+    KEYWORD_TYPE,       // Types and qualifiers that can precede a declared name.
+    KEYWORD_TAG,        // struct, union and enum.
+    KEYWORD_TYPEDEF,
+    KEYWORD_OTHER,      // Every other keyword.
+};
+
+struct Token {
+    enum TokenType type;
+    const char *text;
+    size_t len;
+    char punctuation;
+    enum Keyword keyword;
+};
+
+struct Lexer {
+    const char *start;
+    const char *p;
+    const char *end;
+    unsigned long line;
+    void (*found)(const char *, size_t, enum IdentifierKind, unsigned long, void *);
+    void *context;
+    struct Token prev;
+    struct Token prev2;
+};
+
+static const char *KindNames[N_IDENTIFIER_KINDS] = {"function", "variable", "type", "macro"};
+
+enum Language lexer_language (const char *filename)
+{
+    const char *period = strrchr(filename, '.');
+    if (period == NULL || period == filename) {
+        return LANGUAGE_NONE;
+    }
+    if (strcmp(period, ".c") == 0 || strcmp(period, ".h") == 0) {
+        return LANGUAGE_C;
+    }
+    if (strcmp(period, ".py") == 0) {
+        return LANGUAGE_PYTHON;
+    }
+    if (strcmp(period, ".sh") == 0 || strcmp(period, ".bash") == 0) {
+        return LANGUAGE_SHELL;
+    }
+    return LANGUAGE_NONE;
+}
+
+const char *lexer_kind_name (enum IdentifierKind kind)
+{
+    return KindNames[kind];
+}
+
+static bool is_space (char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v';
+}
+
+static bool is_digit (char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+// Non-ASCII bytes are accepted so that UTF-8 identifiers are kept whole.
+static bool is_identifier_start (char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || (c & 0x80);
+}
+
+static bool is_identifier_char (char c)
+{
+    return is_identifier_start(c) || is_digit(c);
+}
+
+static bool token_is (const struct Token *token, const char *word)
+{
+    return token->type == TOKEN_IDENTIFIER && strlen(word) == token->len &&
+           memcmp(token->text, word, token->len) == 0;
+}
+
+static bool token_is_punctuation (const struct Token *token, char c)
+{
+    return token->type == TOKEN_PUNCTUATION && token->punctuation == c;
+}
+
+static void push_token (struct Lexer *lexer, struct Token token)
+{
+    lexer->prev2 = lexer->prev;
+    lexer->prev = token;
+}
+
+static void push_punctuation (struct Lexer *lexer, char c)
+{
+    push_token(lexer, (struct Token){TOKEN_PUNCTUATION, NULL, 0, c, KEYWORD_NONE});
+}
+
+// Returns the first of a, b or c in [p, end), or end.
+static const char *find_any3 (const char *p, const char *end, char a, char b, char c)
+{
+#if defined(__SSE2__)
+    const __m128i va = _mm_set1_epi8(a);
+    const __m128i vb = _mm_set1_epi8(b);
+    const __m128i vc = _mm_set1_epi8(c);
+    for (; p + 16 <= end; p += 16)
+    {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)p);
+        __m128i hits = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, va), 
+                                                 _mm_cmpeq_epi8(chunk, vb)),
+                                    _mm_cmpeq_epi8(chunk, vc));
+        int mask = _mm_movemask_epi8(hits);
+        if (mask != 0) {
+            return p + __builtin_ctz(mask);
+        }
+    }
+#endif // __SSE2__
+    for (; p < end; p++)
+    {
+        if (*p == a || *p == b || *p == c) {
+            return p;
+        }
+    }
+    return end;
+}
+
+static unsigned long count_newlines (const char *p, const char *end)
+{
+    unsigned long n = 0;
+    while ((p = memchr(p, '\n', end - p)) != NULL)
+    {
+        n++;
+        p++;
+    }
+    return n;
+}
+
+// Skips to the newline ending the current line, leaving it to be read.
+static void skip_line (struct Lexer *lexer)
+{
+    const char *newline = memchr(lexer->p, '\n', lexer->end - lexer->p);
+    lexer->p = (newline != NULL) ? newline : lexer->end;
+}
+
+// Skips a C block comment, with lexer->p after its opening "/*".
+static void skip_block_comment (struct Lexer *lexer)
+{
+    const char *p = lexer->p;
+    const char *end = lexer->end;
+    while (p < end)
+    {
+        const char *star = memchr(p, '*', end - p);
+        if (star == NULL) {
+            break;
+        }
+        if (star + 1 < end && star[1] == '/') {
+            lexer->line += count_newlines(lexer->p, star);
+            lexer->p = star + 2;
+            return;
+        }
+        p = star + 1;
+    }
+    lexer->line += count_newlines(lexer->p, end);
+    lexer->p = end;
+}
+
+static void skip_quoted (struct Lexer *lexer, char quote, bool escapes, bool multiline, 
+                         bool triple)
+/**********************************************************************************************
+*
+*   Skips a string literal, with lexer->p after its opening quote (or quotes).
+*
+*   ---------------------------------------- ARGUMENTS ----------------------------------------
+*
+*   quote       The quote that closes the literal.
+*
+*   escapes     Whether a backslash escapes the next character.
+*
+*   multiline   Whether the literal can span lines. Otherwise a newline ends it, so an
+*               unterminated literal does not swallow the rest of the file.
+*
+*   triple      Whether the literal is closed by three quotes (Python).
+*
+**********************************************************************************************/
+{
+    const char *p = lexer->p;
+    const char *end = lexer->end;
+    while (p < end)
+    {
+        const char *q = find_any3(p, end, quote, (escapes) ? '\\' : quote, '\n');
+        if (q == end) {
+            p = end;
+            break;
+        }
+        if (*q == '\n') {
+            lexer->line++;
+            p = q + 1;
+            if (!multiline) {
+                break;
+            }
+        }
+        else if (*q == '\\') {
+            if (q + 1 < end && q[1] == '\n') {
+                lexer->line++;
+            }
+            p = q + 2;
+        }
+        else if (!triple) {
+            p = q + 1;
+            break;
+        }
+        else if (q + 2 < end && q[1] == quote && q[2] == quote) {
+            p = q + 3;
+            break;
+        }
+        else {
+            p = q + 1;
+        }
+    }
+    lexer->p = (p < end) ? p : end;
+}
+
+// Reads an identifier at lexer->p into a token.
+static struct Token read_identifier (struct Lexer *lexer)
+{
+    const char *start = lexer->p;
+    while (lexer->p < lexer->end && is_identifier_char(*lexer->p))
+    {
+        lexer->p++;
+    }
+    return (struct Token){TOKEN_IDENTIFIER, start, lexer->p - start, 0, KEYWORD_NONE};
+}
+
+// Skips a number, including suffixes, exponents and digit separators.
+static void skip_number (struct Lexer *lexer)
+{
+    while (lexer->p < lexer->end && (is_identifier_char(*lexer->p) || *lexer->p == '.' || 
+                                     *lexer->p == '\''))
+    {
+        lexer->p++;
+    }
+}
+
+// Returns the next character that is not a space or (if newlines) a newline, or '\0'.
+static char peek (const struct Lexer *lexer, bool newlines)
+{
+    for (const char *p = lexer->p; p < lexer->end; p++)
+    {
+        if (!is_space(*p) && !(newlines && *p == '\n')) {
+            return *p;
+        }
+    }
+    return '\0';
+}
+
+// Returns the character after the one peek() returns, or '\0'.
+static char peek2 (const struct Lexer *lexer, bool newlines)
+{
+    for (const char *p = lexer->p; p < lexer->end; p++)
+    {
+        if (!is_space(*p) && !(newlines && *p == '\n')) {
+            return (p + 1 < lexer->end) ? p[1] : '\0';
+        }
+    }
+    return '\0';
+}
+
+static void report (struct Lexer *lexer, const struct Token *token, enum IdentifierKind kind)
+{
+    lexer->found(token->text, token->len, kind, lexer->line, lexer->context);
+}
+
+static bool is_word (const char *text, size_t len, const char *const *words)
+{
+    for (size_t i = 0; words[i] != NULL; i++)
+    {
+        if (strlen(words[i]) == len && memcmp(words[i], text, len) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+//----------------------------------------------------------------------------------------------
+// C
+//----------------------------------------------------------------------------------------------
+static const char *const CTypeKeywords[] = {
+    "void", "char", "short", "int", "long", "float", "double", "signed", "unsigned", "_Bool",
+    "_Complex", "const", "volatile", "restrict", "static", "extern", "register", "auto", 
+    "inline", "_Atomic", "_Thread_local", "__thread", NULL
+};
+
+static const char *const COtherKeywords[] = {
+    "break", "case", "continue", "default", "do", "else", "for", "goto", "if", "return", 
+    "sizeof", "switch", "while", "_Alignas", "_Alignof", "_Generic", "_Noreturn", 
+    "_Static_assert", "asm", "__asm__", "__attribute__", "typeof", "__typeof__", NULL
+};
+
+static enum Keyword c_keyword (const struct Token *token)
+{
+    if (token_is(token, "struct") || token_is(token, "union") || token_is(token, "enum")) {
+        return KEYWORD_TAG;
+    }
+    if (token_is(token, "typedef")) {
+        return KEYWORD_TYPEDEF;
+    }
+    if (is_word(token->text, token->len, CTypeKeywords)) {
+        return KEYWORD_TYPE;
+    }
+    if (is_word(token->text, token->len, COtherKeywords)) {
+        return KEYWORD_OTHER;
+    }
+    return KEYWORD_NONE;
+}
+
+// Whether a token can be the type (or last word of the type) of a declaration.
+static bool is_c_type_token (const struct Token *token)
+{
+    return token->type == TOKEN_IDENTIFIER && 
+           (token->keyword == KEYWORD_NONE || token->keyword == KEYWORD_TYPE);
+}
+
+// Skips a preprocessor line, with lexer->p after its '#', reporting the name of a #define.
+static void scan_c_directive (struct Lexer *lexer)
+{
+    while (lexer->p < lexer->end && is_space(*lexer->p))
+    {
+        lexer->p++;
+    }
+    struct Token directive = read_identifier(lexer);
+    if (token_is(&directive, "define")) {
+        while (lexer->p < lexer->end && is_space(*lexer->p))
+        {
+            lexer->p++;
+        }
+        if (lexer->p < lexer->end && is_identifier_start(*lexer->p)) {
+            struct Token name = read_identifier(lexer);
+            report(lexer, &name, IDENTIFIER_MACRO);
+        }
+    }
+
+    // The directive ends at the first newline that is not escaped.
+    while (lexer->p < lexer->end)
+    {
+        const char *q = find_any3(lexer->p, lexer->end, '\n', '\\', '/');
+        if (q == lexer->end || *q == '\n') {
+            lexer->p = q;
+            break;
+        }
+        if (*q == '\\') {
+            lexer->p = q + 1;
+            if (lexer->p < lexer->end && *lexer->p == '\n') {
+                lexer->line++;
+                lexer->p++;
+            }
+        }
+        else if (q + 1 < lexer->end && q[1] == '*') {
+            lexer->p = q + 2;
+            skip_block_comment(lexer);
+        }
+        else if (q + 1 < lexer->end && q[1] == '/') {
+            lexer->p = q;
+            skip_line(lexer);
+            break;
+        }
+        else {
+            lexer->p = q + 1;
+        }
+    }
+    push_token(lexer, (struct Token){TOKEN_NONE, NULL, 0, 0, KEYWORD_NONE});
+}
+
+static void scan_c (struct Lexer *lexer)
+{
+    bool line_start = true;
+    int brace_depth = 0;
+    int paren_depth = 0;
+    bool in_expression = false;     // After '=' or 'return', until the statement ends.
+
+    // The name a typedef at typedef_depth declares, reported at the ';' ending it.
+    bool in_typedef = false;
+    int typedef_depth = 0;
+    struct Token typedef_name = {0};
+    unsigned long typedef_line = 0;
+    bool typedef_name_final = false;
+
+    while (lexer->p < lexer->end)
+    {
+        char c = *lexer->p;
+        char next = (lexer->p + 1 < lexer->end) ? lexer->p[1] : '\0';
+
+        if (c == '\n') {
+            lexer->line++;
+            lexer->p++;
+            line_start = true;
+            continue;
+        }
+        if (is_space(c)) {
+            lexer->p++;
+            continue;
+        }
+        if (c == '#' && line_start) {
+            lexer->p++;
+            scan_c_directive(lexer);
+            continue;
+        }
+        line_start = false;
+
+        if (c == '/' && next == '/') {
+            skip_line(lexer);
+        }
+        else if (c == '/' && next == '*') {
+            lexer->p += 2;
+            skip_block_comment(lexer);
+        }
+        else if (c == '"' || c == '\'') {
+            lexer->p++;
+            skip_quoted(lexer, c, true, false, false);
+            push_token(lexer, (struct Token){TOKEN_LITERAL, NULL, 0, 0, KEYWORD_NONE});
+        }
+        else if (is_digit(c) || (c == '.' && is_digit(next))) {
+            skip_number(lexer);
+            push_token(lexer, (struct Token){TOKEN_LITERAL, NULL, 0, 0, KEYWORD_NONE});
+        }
+        else if (is_identifier_start(c)) {
+            struct Token token = read_identifier(lexer);
+            token.keyword = c_keyword(&token);
+            char after = peek(lexer, true);
+            char after2 = peek2(lexer, true);
+            bool member = token_is_punctuation(&lexer->prev, '.') || 
+                          token_is_punctuation(&lexer->prev, '>');
+
+            if (token.keyword == KEYWORD_TYPEDEF) {
+                in_typedef = true;
+                typedef_depth = brace_depth;
+                typedef_name.type = TOKEN_NONE;
+                typedef_name_final = false;
+            }
+            else if (token.keyword == KEYWORD_OTHER) {
+                if (token_is(&token, "return") || token_is(&token, "case")) {
+                    in_expression = true;
+                }
+            }
+            else if (token.keyword != KEYWORD_NONE || member) {
+                // Keywords are never reported, and neither are members being accessed.
+            }
+            else if (lexer->prev.keyword == KEYWORD_TAG && lexer->prev.type == TOKEN_IDENTIFIER) {
+                if (after == '{') {
+                    report(lexer, &token, IDENTIFIER_TYPE);
+                }
+            }
+            else if (in_typedef && brace_depth == typedef_depth) {
+                // In 'typedef int (*handler)(int);' the name is the one inside '(*' ')'.
+                bool pointer_name = (after == ')' && token_is_punctuation(&lexer->prev, '*'));
+                if (!typedef_name_final && (after == ';' || after == '[' || pointer_name)) {
+                    typedef_name = token;
+                    typedef_line = lexer->line;
+                    typedef_name_final = pointer_name;
+                }
+            }
+            else if (after == '(' && brace_depth == 0) {
+                // Only after a return type, so that macros such as attributes are left out.
+                if (is_c_type_token(&lexer->prev) || token_is_punctuation(&lexer->prev, '*')) {
+                    report(lexer, &token, IDENTIFIER_FUNCTION);
+                }
+            }
+            else if (!in_expression) {
+                // 'TYPE NAME', or 'TYPE *NAME' where the '*' cannot be a multiplication.
+                bool typed = is_c_type_token(&lexer->prev) ||
+                             (token_is_punctuation(&lexer->prev, '*') &&
+                              (is_c_type_token(&lexer->prev2) || 
+                               token_is_punctuation(&lexer->prev2, '*')));
+                bool declared = (after == '=' && after2 != '=') || after == ';' || after == '[' ||
+                                (after == ',' && (paren_depth == 0 || brace_depth == 0)) ||
+                                (after == ')' && paren_depth > 0 && brace_depth == 0);
+                if (typed && declared) {
+                    report(lexer, &token, IDENTIFIER_VARIABLE);
+                }
+            }
+            push_token(lexer, token);
+        }
+        else {
+            switch (c)
+            {
+                case '{':
+                    // The block of 'extern "C" {' in headers is still at file scope, and its
+                    // '}' is absorbed by the depth never going below 0.
+                    if (!(lexer->prev.type == TOKEN_LITERAL && token_is(&lexer->prev2, "extern"))) {
+                        brace_depth++;
+                    }
+                    in_expression = false;
+                    break;
+
+                case '}':
+                    brace_depth -= (brace_depth > 0);
+                    in_expression = false;
+                    break;
+
+                case '(':
+                    paren_depth++;
+                    break;
+
+                case ')':
+                    paren_depth -= (paren_depth > 0);
+                    break;
+
+                case ';':
+                    in_expression = false;
+                    if (in_typedef && brace_depth == typedef_depth) {
+                        if (typedef_name.type == TOKEN_IDENTIFIER) {
+                            lexer->found(typedef_name.text, typedef_name.len, IDENTIFIER_TYPE, 
+                                         typedef_line, lexer->context);
+                        }
+                        in_typedef = false;
+                    }
+                    break;
+
+                case '=':
+                    in_expression = true;
+                    break;
+
+                case ',':
+                    // 'int a = 1, b;' declares b after the initializer of a.
+                    if (paren_depth == 0) {
+                        in_expression = false;
+                    }
+                    break;
+
+                case '-':
+                    // '->' is recorded as '>' after the '-', like the '.' of a member access.
+                    if (next == '>') {
+                        push_punctuation(lexer, '-');
+                        c = '>';
+                        lexer->p++;
+                    }
+                    break;
+
+                default:
+                    break;
+            }
+            push_punctuation(lexer, c);
+            lexer->p++;
+        }
+    }
+}
+
+//----------------------------------------------------------------------------------------------
+// Python
+//----------------------------------------------------------------------------------------------
+static const char *const PythonKeywords[] = {
+    "False", "None", "True", "and", "as", "assert", "async", "await", "break", "class", 
+    "continue", "def", "del", "elif", "else", "except", "finally", "for", "from", "global", 
+    "if", "import", "in", "is", "lambda", "nonlocal", "not", "or", "pass", "raise", "return", 
+    "try", "while", "with", "yield", "match", "case", NULL
+};
+
+// Whether an identifier is a string prefix (r, b, f, u or a pair of them) before a quote.
+static bool is_string_prefix (const struct Token *token, const struct Lexer *lexer)
+{
+    if (lexer->p >= lexer->end || (*lexer->p != '"' && *lexer->p != '\'') || token->len > 2) {
+        return false;
+    }
+    for (size_t i = 0; i < token->len; i++)
+    {
+        if (strchr("rRbBfFuU", token->text[i]) == NULL) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void scan_python (struct Lexer *lexer)
+{
+    int paren_depth = 0;
+    bool statement_start = true;
+    int params_depth = -1;          // The paren depth of the parameters of a def, or -1.
+
+    while (lexer->p < lexer->end)
+    {
+        char c = *lexer->p;
+        char next = (lexer->p + 1 < lexer->end) ? lexer->p[1] : '\0';
+
+        if (c == '\n') {
+            lexer->line++;
+            lexer->p++;
+            // Lines only continue inside of brackets.
+            statement_start = statement_start || (paren_depth == 0);
+            continue;
+        }
+        if (is_space(c)) {
+            lexer->p++;
+            continue;
+        }
+        if (c == '\\' && next == '\n') {
+            lexer->line++;
+            lexer->p += 2;
+            continue;
+        }
+        if (c == '#') {
+            skip_line(lexer);
+            continue;
+        }
+
+        bool was_statement_start = statement_start;
+        statement_start = false;
+
+        if (c == '"' || c == '\'') {
+            bool triple = (next == c && lexer->p + 2 < lexer->end && lexer->p[2] == c);
+            lexer->p += (triple) ? 3 : 1;
+            skip_quoted(lexer, c, true, triple, triple);
+            push_token(lexer, (struct Token){TOKEN_LITERAL, NULL, 0, 0, KEYWORD_NONE});
+        }
+        else if (is_digit(c) || (c == '.' && is_digit(next))) {
+            skip_number(lexer);
+            push_token(lexer, (struct Token){TOKEN_LITERAL, NULL, 0, 0, KEYWORD_NONE});
+        }
+        else if (is_identifier_start(c)) {
+            struct Token token = read_identifier(lexer);
+            if (is_string_prefix(&token, lexer)) {
+                statement_start = was_statement_start;
+                continue;
+            }
+            bool keyword = is_word(token.text, token.len, PythonKeywords);
+            char after = peek(lexer, paren_depth > 0);
+            char after2 = peek2(lexer, paren_depth > 0);
+
+            if (keyword) {
+                // 'else: x = 1' and the like start a new statement after the ':'.
+            }
+            else if (token_is(&lexer->prev, "def")) {
+                report(lexer, &token, IDENTIFIER_FUNCTION);
+                params_depth = paren_depth + 1;
+            }
+            else if (token_is(&lexer->prev, "class")) {
+                report(lexer, &token, IDENTIFIER_TYPE);
+            }
+            else if (token_is(&lexer->prev, "for") && after != '(') {
+                report(lexer, &token, IDENTIFIER_VARIABLE);
+            }
+            else if (paren_depth == params_depth && 
+                     (token_is_punctuation(&lexer->prev, '(') || token_is_punctuation(&lexer->prev, ',') ||
+                      token_is_punctuation(&lexer->prev, '*')) &&
+                     (after == ',' || after == ')' || after == '=' || after == ':')) {
+                report(lexer, &token, IDENTIFIER_VARIABLE);
+            }
+            else if (was_statement_start && paren_depth == 0 && 
+                     ((after == '=' && after2 != '=') || after == ':')) {
+                report(lexer, &token, IDENTIFIER_VARIABLE);
+            }
+            push_token(lexer, token);
+        }
+        else {
+            switch (c)
+            {
+                case '(':
+                case '[':
+                case '{':
+                    paren_depth++;
+                    break;
+
+                case ')':
+                case ']':
+                case '}':
+                    if (paren_depth == params_depth) {
+                        params_depth = -1;
+                    }
+                    paren_depth -= (paren_depth > 0);
+                    break;
+
+                case ';':
+                    statement_start = true;
+                    break;
+
+                case ':':
+                    // The body of a compound statement on the same line, as in 'if x: y = 1'.
+                    statement_start = (paren_depth == 0);
+                    break;
+
+                default:
+                    break;
+            }
+            push_punctuation(lexer, c);
+            lexer->p++;
+        }
+    }
+}
+
+//----------------------------------------------------------------------------------------------
+// Shell
+//----------------------------------------------------------------------------------------------
+
+// Words after which a new command starts.
+static const char *const ShellCommandKeywords[] = {
+    "then", "do", "else", "elif", "if", "while", "until", "time", "!", NULL
+};
+
+// Builtins whose arguments declare variables.
+static const char *const ShellDeclareBuiltins[] = {
+    "local", "export", "declare", "readonly", "typeset", NULL
+};
+
+// Skips the body of a here-document, with lexer->p at the start of the line after '<<'.
+static void skip_heredoc (struct Lexer *lexer, const char *delimiter, size_t len, 
+                          bool strip_tabs)
+{
+    while (lexer->p < lexer->end)
+    {
+        const char *line = lexer->p;
+        const char *newline = memchr(line, '\n', lexer->end - line);
+        const char *line_end = (newline != NULL) ? newline : lexer->end;
+        lexer->p = (newline != NULL) ? newline + 1 : lexer->end;
+        lexer->line += (newline != NULL);
+
+        while (strip_tabs && line < line_end && *line == '\t')
+        {
+            line++;
+        }
+        if ((size_t)(line_end - line) == len && memcmp(line, delimiter, len) == 0) {
+            return;
+        }
+    }
+}
+
+static void scan_shell (struct Lexer *lexer)
+{
+    bool command_start = true;
+    bool in_declare = false;        // In the arguments of local, export, and so on.
+
+    // A here-document whose body starts at the next newline.
+    const char *heredoc = NULL;
+    size_t heredoc_len = 0;
+    bool heredoc_strip_tabs = false;
+
+    while (lexer->p < lexer->end)
+    {
+        char c = *lexer->p;
+        char next = (lexer->p + 1 < lexer->end) ? lexer->p[1] : '\0';
+        char before = (lexer->p > lexer->start) ? lexer->p[-1] : '\n';
+
+        if (c == '\n') {
+            lexer->line++;
+            lexer->p++;
+            command_start = true;
+            in_declare = false;
+            if (heredoc != NULL) {
+                skip_heredoc(lexer, heredoc, heredoc_len, heredoc_strip_tabs);
+                heredoc = NULL;
+            }
+            continue;
+        }
+        if (is_space(c)) {
+            lexer->p++;
+            continue;
+        }
+        if (c == '\\') {
+            lexer->line += (next == '\n');
+            lexer->p += (next != '\0') ? 2 : 1;
+            continue;
+        }
+        if (c == '#' && (is_space(before) || before == '\n' || before == ';')) {
+            skip_line(lexer);
+            continue;
+        }
+
+        if (c == '\'') {
+            lexer->p++;
+            skip_quoted(lexer, c, false, true, false);
+            command_start = false;
+            push_token(lexer, (struct Token){TOKEN_LITERAL, NULL, 0, 0, KEYWORD_NONE});
+        }
+        else if (c == '"' || c == '`') {
+            lexer->p++;
+            skip_quoted(lexer, c, true, true, false);
+            command_start = false;
+            push_token(lexer, (struct Token){TOKEN_LITERAL, NULL, 0, 0, KEYWORD_NONE});
+        }
+        else if (c == '$' && next == '{') {
+            // Parameter expansions only reference names.
+            const char *close = memchr(lexer->p, '}', lexer->end - lexer->p);
+            lexer->p = (close != NULL) ? close + 1 : lexer->end;
+            command_start = false;
+        }
+        else if (c == '$' && next == '(') {
+            // Command substitutions hold commands of their own.
+            lexer->p += 2;
+            command_start = true;
+            push_punctuation(lexer, '(');
+        }
+        else if (c == '$') {
+            lexer->p++;
+            read_identifier(lexer);
+            command_start = false;
+        }
+        else if (c == '<' && next == '<' && 
+                 (lexer->p + 2 >= lexer->end || lexer->p[2] != '<')) {
+            lexer->p += 2;
+            heredoc_strip_tabs = (lexer->p < lexer->end && *lexer->p == '-');
+            lexer->p += heredoc_strip_tabs;
+            while (lexer->p < lexer->end && is_space(*lexer->p))
+            {
+                lexer->p++;
+            }
+            char quote = (lexer->p < lexer->end && (*lexer->p == '\'' || *lexer->p == '"')) ? 
+                         *lexer->p : '\0';
+            lexer->p += (quote != '\0');
+            heredoc = lexer->p;
+            while (lexer->p < lexer->end && *lexer->p != '\n' && !is_space(*lexer->p) && 
+                   *lexer->p != quote && *lexer->p != ';')
+            {
+                lexer->p++;
+            }
+            heredoc_len = lexer->p - heredoc;
+            lexer->p += (quote != '\0' && lexer->p < lexer->end && *lexer->p == quote);
+            if (heredoc_len == 0) {
+                heredoc = NULL;
+            }
+        }
+        else if (is_identifier_start(c) || is_digit(c)) {
+            struct Token token = read_identifier(lexer);
+            bool assignment = (lexer->p < lexer->end && *lexer->p == '=');
+            bool separated = is_space(before) || before == '\n' || before == ';' || 
+                             before == '(' || before == '{' || before == '&' || before == '|';
+            bool first_word = command_start;
+            command_start = false;
+
+            if (is_digit(c) || !separated) {
+                // Numbers and the rest of words such as 'a-b' or './x' are not names.
+            }
+            else if (token_is(&lexer->prev, "function") && lexer->prev.keyword == KEYWORD_OTHER) {
+                report(lexer, &token, IDENTIFIER_FUNCTION);
+            }
+            else if (first_word && assignment) {
+                report(lexer, &token, IDENTIFIER_VARIABLE);
+                command_start = true;   // 'A=1 B=2 command' assigns both.
+            }
+            else if (in_declare && (assignment || peek(lexer, false) == ';' || 
+                                    peek(lexer, false) == '\n' || peek(lexer, false) == '\0' ||
+                                    is_space(*lexer->p))) {
+                report(lexer, &token, IDENTIFIER_VARIABLE);
+            }
+            else if (first_word && peek(lexer, false) == '(' && peek2(lexer, false) == ')') {
+                report(lexer, &token, IDENTIFIER_FUNCTION);
+            }
+            else if (token_is(&lexer->prev, "for") && lexer->prev.keyword == KEYWORD_OTHER) {
+                report(lexer, &token, IDENTIFIER_VARIABLE);
+            }
+            else if (first_word && is_word(token.text, token.len, ShellCommandKeywords)) {
+                command_start = true;
+            }
+            else if (first_word && is_word(token.text, token.len, ShellDeclareBuiltins)) {
+                in_declare = true;
+            }
+
+            // Keywords are only keywords as the first word of a command.
+            token.keyword = (first_word) ? KEYWORD_OTHER : KEYWORD_NONE;
+            if (assignment) {
+                // Skip the value, which can contain anything but unquoted spaces.
+                while (lexer->p < lexer->end && !is_space(*lexer->p) && *lexer->p != '\n' && 
+                       *lexer->p != ';' && *lexer->p != '"' && *lexer->p != '\'' && 
+                       *lexer->p != '$' && *lexer->p != '`')
+                {
+                    lexer->p++;
+                }
+            }
+            push_token(lexer, token);
+        }
+        else {
+            command_start = (c == ';' || c == '&' || c == '|' || c == '(' || c == '{' || 
+                             c == ')' || c == '}');
+            if (c == ';' || c == '&' || c == '|') {
+                in_declare = false;
+            }
+            push_punctuation(lexer, c);
+            lexer->p++;
+        }
+    }
+}
+
+void lexer_scan (enum Language language, const char *text, size_t len,
+                 void (*found)(const char *identifier, size_t len, enum IdentifierKind kind,
+                               unsigned long line, void *context),
+                 void *context)
+/**********************************************************************************************
+*
+*   Reports every identifier declared in the source text of a file.
+*
+*   ---------------------------------------- ARGUMENTS ----------------------------------------
+*
+*   language    The language of the file, from lexer_language().
+*
+*   text        The contents of the file, which do not need to be null-terminated.
+*
+*   len         The length of text.
+*
+*   found       Called with each declared identifier, its kind and its line (from 1).
+*
+*   context     Passed to found.
+*
+**********************************************************************************************/
+{
+    struct Lexer lexer = {
+        .start = text,
+        .p = text,
+        .end = text + len,
+        .line = 1,
+        .found = found,
+        .context = context,
+    };
+
+    switch (language)
+    {
+        case LANGUAGE_C:
+            scan_c(&lexer);
+            break;
+
+        case LANGUAGE_PYTHON:
+            scan_python(&lexer);
+            break;
+
+        case LANGUAGE_SHELL:
+            scan_shell(&lexer);
+            break;
+
+        default:
+            break;
+    }
+}
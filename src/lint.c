@@ -0,0 +1,539 @@
+/**********************************************************************************************
+*
+*   lint - Handles options, validation, and runtime of the nc-scout lint-identifiers subcommand.
+*
+*   LICENSE: zlib/libpng
+*
+*   Copyright (c) 2024-2025 Josh Hayden (@BlinkDynamo)
+*
+*   This software is provided ‘as-is’, without any express or implied
+*   warranty. In no event will the authors be held liable for any damages
+*   arising from the use of this software.
+*
+*   Permission is granted to anyone to use this software for any purpose,
+*   including commercial applications, and to alter it and redistribute it
+*   freely, subject to the following restrictions:
+*
+*   1. The origin of this software must not be misrepresented; you must not
+*   claim that you wrote the original software. If you use this software
+*   in a product, an acknowledgment in the product documentation would be
+*   appreciated but is not required.
+*
+*   2. Altered source versions must be plainly marked as such, and must not be
+*   misrepresented as being the original software.
+*
+*   3. This notice may not be removed or altered from any source
+*   distribution.
+*
+*********************************************************************************************/
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif // _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <linux/limits.h>
+
+#include "help.h"
+#include "validate.h"
+#include "common.h"
+#include "naming.h"
+#include "lexer.h"
+#include "traverse.h"
+#include "lint.h"
+
+#define N_REQUIRED_ARGS 2
+
+// Most files waiting for a worker at once, and most workers.
+#define QUEUE_CAPACITY  1024
+#define MAX_JOBS        256
+
+// Identifiers longer than this are not checked.
+#define MAX_IDENTIFIER_LEN 1023
+
+// Long options without a short equivalent.
+enum {
+    OPT_FUNCTIONS = 256,
+    OPT_VARIABLES,
+    OPT_TYPES,
+    OPT_MACROS,
+};
+
+// Flags.
+static bool full_path_flag  = false;
+static bool strict_flag     = false;
+static bool recursive_flag  = false;
+static bool unicode_flag    = false;
+static bool quiet_flag      = false;
+
+// The convention of each kind of identifier, set by --functions and so on, or CONVENTION.
+static const char *conventions[N_IDENTIFIER_KINDS] = {NULL};
+
+static const char *abs_initial_lint_path = NULL;
+
+// Files found by the traversal, waiting for a worker.
+static struct {
+    char *paths[QUEUE_CAPACITY];
+    size_t head;
+    size_t len;
+    bool closed;
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+} queue = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .not_empty = PTHREAD_COND_INITIALIZER,
+    .not_full = PTHREAD_COND_INITIALIZER,
+};
+
+// Serializes the output of the workers, which each print a whole file at once.
+static pthread_mutex_t output_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// A worker thread. Each compiles its own rules, since regexec() locks a shared regex.
+struct Worker {
+    pthread_t thread;
+    struct NamingRule rules[N_IDENTIFIER_KINDS];
+    unsigned long matches[N_IDENTIFIER_KINDS];
+    unsigned long non_matches[N_IDENTIFIER_KINDS];
+};
+
+// The file a worker is linting.
+struct LintFile {
+    struct Worker *worker;
+    const char *display_path;
+    FILE *out;
+};
+
+static void queue_push (char *path)
+{
+    pthread_mutex_lock(&queue.lock);
+    while (queue.len == QUEUE_CAPACITY)
+    {
+        pthread_cond_wait(&queue.not_full, &queue.lock);
+    }
+    queue.paths[(queue.head + queue.len++) % QUEUE_CAPACITY] = path;
+    pthread_cond_signal(&queue.not_empty);
+    pthread_mutex_unlock(&queue.lock);
+}
+
+// Returns the next file to lint, or NULL once the queue is closed and empty.
+static char *queue_pop (void)
+{
+    pthread_mutex_lock(&queue.lock);
+    while (queue.len == 0 && !queue.closed)
+    {
+        pthread_cond_wait(&queue.not_empty, &queue.lock);
+    }
+    char *path = NULL;
+    if (queue.len > 0) {
+        path = queue.paths[queue.head];
+        queue.head = (queue.head + 1) % QUEUE_CAPACITY;
+        queue.len--;
+        pthread_cond_signal(&queue.not_full);
+    }
+    pthread_mutex_unlock(&queue.lock);
+    return path;
+}
+
+static void queue_close (void)
+{
+    pthread_mutex_lock(&queue.lock);
+    queue.closed = true;
+    pthread_cond_broadcast(&queue.not_empty);
+    pthread_mutex_unlock(&queue.lock);
+}
+
+static void check_identifier (const char *identifier, size_t len, enum IdentifierKind kind,
+                              unsigned long line, void *context)
+/**********************************************************************************************
+*
+*   Compares an identifier to the convention of its kind, printing it if it does not match.
+*   Called by lexer_scan() for every identifier declared in a file.
+*
+*   Leading and trailing underscores are ignored, as they mark private and reserved names in
+*   every language rather than being part of the convention.
+*
+**********************************************************************************************/
+{
+    struct LintFile *file = context;
+    const char *name = identifier;
+    size_t name_len = len;
+    while (name_len > 0 && *name == '_')
+    {
+        name++;
+        name_len--;
+    }
+    while (name_len > 0 && name[name_len - 1] == '_')
+    {
+        name_len--;
+    }
+    if (name_len == 0 || name_len > MAX_IDENTIFIER_LEN) {
+        return;
+    }
+
+    char buf[MAX_IDENTIFIER_LEN + 1];
+    memcpy(buf, name, name_len);
+    buf[name_len] = '\0';
+
+    if (naming_match_rule(&file->worker->rules[kind], buf)) {
+        file->worker->matches[kind]++;
+    }
+    else {
+        file->worker->non_matches[kind]++;
+        if (!quiet_flag) {
+            fprintf(file->out, "%s:%lu: %s %.*s\n", file->display_path, line, 
+                    lexer_kind_name(kind), (int)len, identifier);
+        }
+    }
+}
+
+static void lint_file (struct Worker *worker, const char *abs_path)
+/**********************************************************************************************
+*
+*   Maps a source file into memory and checks every identifier declared in it. The lines
+*   printed for the file are collected first and printed together, so files never interleave.
+*
+**********************************************************************************************/
+{
+    int fd = open(abs_path, O_RDONLY | O_CLOEXEC);
+    struct stat st;
+    if (fd == -1 || fstat(fd, &st) == -1) {
+        pthread_mutex_lock(&output_lock);
+        printf("Error: cannot access %s due to Error %d (%s).\n", abs_path, errno, 
+               strerror(errno));
+        pthread_mutex_unlock(&output_lock);
+        if (fd != -1) {
+            close(fd);
+        }
+        return;
+    }
+    if (st.st_size == 0) {
+        close(fd);
+        return;
+    }
+
+    void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        pthread_mutex_lock(&output_lock);
+        printf("Error: cannot map %s due to Error %d (%s).\n", abs_path, errno, strerror(errno));
+        pthread_mutex_unlock(&output_lock);
+        return;
+    }
+    madvise(map, st.st_size, MADV_SEQUENTIAL);
+
+    char *output = NULL;
+    size_t output_len = 0;
+    struct LintFile file = {
+        .worker = worker,
+        .display_path = (full_path_flag) ? abs_path : 
+                        get_relative_path(abs_initial_lint_path, abs_path),
+        .out = open_memstream(&output, &output_len),
+    };
+    if (file.out == NULL) {
+        out_of_memory();
+    }
+    lexer_scan(lexer_language(abs_path), map, st.st_size, check_identifier, &file);
+    fclose(file.out);
+    munmap(map, st.st_size);
+
+    if (output_len > 0) {
+        pthread_mutex_lock(&output_lock);
+        fwrite(output, 1, output_len, stdout);
+        pthread_mutex_unlock(&output_lock);
+    }
+    free(output);
+}
+
+static void *run_worker (void *arg)
+{
+    struct Worker *worker = arg;
+    char *path;
+    while ((path = queue_pop()) != NULL)
+    {
+        lint_file(worker, path);
+        free(path);
+    }
+    return NULL;
+}
+
+static void process_current_file (const struct TraverseEntry *current_file,
+                                  const struct TraverseDir *current_dir, void *context)
+/**********************************************************************************************
+*
+*   Queues a regular file for the workers if it is in a language the lexer knows. Called by
+*   traverse_tree() for every entry it visits.
+*
+**********************************************************************************************/
+{
+    (void)context;
+    if (current_file->type != DT_REG || lexer_language(current_file->name) == LANGUAGE_NONE) {
+        return;
+    }
+    char abs_path[PATH_MAX];
+    if (!traverse_join_path(abs_path, sizeof(abs_path), current_dir->abs_path, 
+                            current_file->name)) {
+        printf("Error: path of %s/%s is too long.\n", current_dir->abs_path, current_file->name);
+        return;
+    }
+    char *queued_path = strdup(abs_path);
+    if (queued_path == NULL) {
+        out_of_memory();
+    }
+    queue_push(queued_path);
+}
+
+static void print_report (const struct Worker *workers, long n_jobs)
+/**********************************************************************************************
+*
+*   Prints the matches and non-matches of every kind of identifier, summed over the workers,
+*   followed by the percentage of all identifiers that follow their convention.
+*
+**********************************************************************************************/
+{
+    unsigned long total_matches = 0;
+    unsigned long total_non_matches = 0;
+
+    if (!quiet_flag) {
+        printf("\n");
+    }
+    printf("Analyzed the presence of the conventions of identifiers in '%s'.\n\n", 
+           abs_initial_lint_path);
+    printf("%-20s %-14s %-9s %12s %12s %12s\n", "kind", "convention", "mode", "matches",
+           "non-matches", "percentage");
+    for (int kind = 0; kind < N_IDENTIFIER_KINDS; kind++)
+    {
+        unsigned long kind_matches = 0;
+        unsigned long kind_non_matches = 0;
+        for (long i = 0; i < n_jobs; i++)
+        {
+            kind_matches += workers[i].matches[kind];
+            kind_non_matches += workers[i].non_matches[kind];
+        }
+        printf("%-20s %-14s %-9s %12lu %12lu %11.3f%%\n",
+               lexer_kind_name(kind),
+               conventions[kind],
+               (strict_flag) ? "strict" : "lenient",
+               kind_matches,
+               kind_non_matches,
+               percentage(kind_matches, kind_matches + kind_non_matches));
+        total_matches += kind_matches;
+        total_non_matches += kind_non_matches;
+    }
+    printf("\nIdentifiers following their conventions make up %0.3f%% of '%s'.\n",
+           percentage(total_matches, total_matches + total_non_matches),
+           abs_initial_lint_path);
+}
+
+static bool lint_directory (const char *lint_path, long n_jobs)
+/**********************************************************************************************
+*
+*   Lints every C, Python and shell file in a directory. The traversal runs on the calling
+*   thread and queues the files, while n_jobs workers each map, scan and check them.
+*
+*   ----------------------------------------- RETURNS -----------------------------------------
+*
+*   false if a worker could not be started, otherwise true.
+*
+**********************************************************************************************/
+{
+    abs_initial_lint_path = canonicalize_file_name(lint_path);
+
+    struct Worker *workers = xcalloc(n_jobs, sizeof(struct Worker));
+    long n_started = 0;
+    for (; n_started < n_jobs; n_started++)
+    {
+        struct Worker *worker = &workers[n_started];
+        for (int kind = 0; kind < N_IDENTIFIER_KINDS; kind++)
+        {
+            naming_compile_rule(&worker->rules[kind], conventions[kind], strict_flag, unicode_flag);
+        }
+        if (pthread_create(&worker->thread, NULL, run_worker, worker) != 0) {
+            printf("Error: cannot start worker %ld of %ld.\n", n_started + 1, n_jobs);
+            break;
+        }
+    }
+
+    if (n_started > 0) {
+        struct Traversal traversal = {
+            .recursive = recursive_flag,
+            .visit = process_current_file,
+        };
+        traverse_tree(&traversal, abs_initial_lint_path);
+    }
+    queue_close();
+    for (long i = 0; i < n_started; i++)
+    {
+        pthread_join(workers[i].thread, NULL);
+    }
+
+    if (n_started == n_jobs) {
+        print_report(workers, n_jobs);
+    }
+    free(workers);
+    return n_started == n_jobs;
+}
+
+int subc_exec_lint_identifiers (int argc, char *argv[])
+/**********************************************************************************************
+*
+*   The external function called from src/main.c. Processes options, compiles the regex of
+*   each kind of identifier, does validation, and finally calls lint_directory.
+*
+*   ---------------------------------------- ARGUMENTS ----------------------------------------
+*
+*   argc    The argc of main() in src/main.c with 1 removed.
+*
+*   argv    The argv of main() in src/main.c with "nc-scout" removed from the beginning.
+*
+*   ----------------------------------------- RETURNS -----------------------------------------
+*
+*   It inherrits the return of main() in src/main.c, returning EXIT_FAILURE or EXIT_SUCCESS.
+*
+**********************************************************************************************/
+{
+    long n_jobs = sysconf(_SC_NPROCESSORS_ONLN);
+    if (n_jobs < 1) {
+        n_jobs = 1;
+    }
+    if (n_jobs > MAX_JOBS) {
+        n_jobs = MAX_JOBS;
+    }
+
+    int current_opt;
+    while (1)
+    {
+        static struct option long_options_lint[] =
+        {
+            {"help", no_argument, 0, 'h'},
+            {"full-path", no_argument, 0, 'f'}, 
+            {"strict", no_argument, 0, 's'},
+            {"recursive", no_argument, 0, 'R'},
+            {"unicode", no_argument, 0, 'u'},
+            {"quiet", no_argument, 0, 'q'},
+            {"jobs", required_argument, 0, 'j'},
+            {"functions", required_argument, 0, OPT_FUNCTIONS},
+            {"variables", required_argument, 0, OPT_VARIABLES},
+            {"types", required_argument, 0, OPT_TYPES},
+            {"macros", required_argument, 0, OPT_MACROS},
+            {0, 0, 0, 0}
+        };
+        
+        int option_index = 0;
+        current_opt = getopt_long (argc, argv, "+hfsRuqj:", long_options_lint, &option_index);
+        // Break if at the end of the options.
+        if (current_opt == -1) {
+            break;
+        }
+
+        switch (current_opt)
+        {
+            case '?':
+                return EXIT_FAILURE;
+
+            case 'h':
+                // Make sure that there are no arguments supplied.
+                if (argc == 2) {
+                    printf("%s", HELP_LINT_IDENTIFIERS);
+                    return EXIT_SUCCESS;
+                }
+                else {
+                    printf("Incorrect usage.\nDo `nc-scout lint-identifiers --help` for more information about usage.\n");
+                    return EXIT_FAILURE;
+                }
+
+            case 'f':
+                full_path_flag = true;
+                break;
+
+            case 's':
+                strict_flag = true;
+                break;
+
+            case 'R':
+                recursive_flag = true;
+                break;
+
+            case 'u':
+                unicode_flag = true;
+                break;
+
+            case 'q':
+                quiet_flag = true;
+                break;
+
+            case 'j':
+            {
+                char *end;
+                n_jobs = strtol(optarg, &end, 10);
+                if (*optarg == '\0' || *end != '\0' || n_jobs < 1 || n_jobs > MAX_JOBS) {
+                    printf("Error: '%s' is not a valid number of jobs (1 to %d).\n", optarg, 
+                           MAX_JOBS);
+                    return EXIT_FAILURE;
+                }
+                break;
+            }
+
+            case OPT_FUNCTIONS:
+                conventions[IDENTIFIER_FUNCTION] = optarg;
+                break;
+
+            case OPT_VARIABLES:
+                conventions[IDENTIFIER_VARIABLE] = optarg;
+                break;
+
+            case OPT_TYPES:
+                conventions[IDENTIFIER_TYPE] = optarg;
+                break;
+
+            case OPT_MACROS:
+                conventions[IDENTIFIER_MACRO] = optarg;
+                break;
+
+            default:
+                abort();
+        }
+    }
+
+    int non_option_argc = argc - optind;
+    if (non_option_argc < N_REQUIRED_ARGS) {
+        printf("Insufficient arguments.\nDo `nc-scout lint-identifiers --help` for more information about usage.\n");
+        return EXIT_FAILURE;
+    }
+
+    const char *arg_naming_convention = argv[optind];
+    const char *arg_target_dirname = argv[optind + 1]; 
+
+    // Kinds without a convention of their own follow CONVENTION. Every convention is compiled
+    // once here, so that an invalid one is reported before any worker starts.
+    for (int kind = 0; kind < N_IDENTIFIER_KINDS; kind++)
+    {
+        if (conventions[kind] == NULL) {
+            conventions[kind] = arg_naming_convention;
+        }
+        struct NamingRule rule;
+        if (!naming_compile_rule(&rule, conventions[kind], strict_flag, unicode_flag)) {
+            return EXIT_FAILURE;
+        }
+        if (!unicode_flag) {
+            regfree(&rule.regex);
+        }
+    }
+
+    if ((validate_file_exists(arg_target_dirname)) && 
+        (validate_file_is_dir(arg_target_dirname)) &&
+        (lint_directory(arg_target_dirname, n_jobs)))
+    {
+        return EXIT_SUCCESS;
+    }
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,404 @@
+/**********************************************************************************************
+*
+*   locate - Reading the entries of a tree from a locate database instead of the filesystem.
+*
+*   LICENSE: zlib/libpng 
+*
+*   Copyright (c) 2024-2025 Josh Hayden (@BlinkDynamo)
+*
+*   This software is provided ‘as-is’, without any express or implied
+*   warranty. In no event will the authors be held liable for any damages
+*   arising from the use of this software.
+*
+*   Permission is granted to anyone to use this software for any purpose,
+*   including commercial applications, and to alter it and redistribute it
+*   freely, subject to the following restrictions:
+*
+*   1. The origin of this software must not be misrepresented; you must not
+*   claim that you wrote the original software. If you use this software
+*   in a product, an acknowledgment in the product documentation would be
+*   appreciated but is not required.
+*
+*   2. Altered source versions must be plainly marked as such, and must not be
+*   misrepresented as being the original software.
+*
+*   3. This notice may not be removed or altered from any source
+*   distribution. 
+*
+*   ------------------------------------ DATABASE FORMATS ------------------------------------
+*
+*   mlocate (mlocate.db(5)), all numbers big-endian:
+*
+*       "\0mlocate", u32 size of the configuration block, u8 version, u8 visibility, 2 bytes
+*       of padding, the root path and '\0', then the configuration block. Then every directory:
+*       u64 and u32 of its time, 4 bytes of padding, its path and '\0', then its entries, each
+*       a u8 type (0: not a directory, 1: directory) and a name and '\0', ended by a type 2.
+*
+*   LOCATE02 (GNU findutils locatedb(5)):
+*
+*       "\0LOCATE02\0", then every path front-coded against the one before: a signed byte
+*       adding to the length of the shared prefix (or 0x80 and a signed big-endian 16-bit
+*       number, if it does not fit), then the rest of the path and '\0'.
+*
+*   plocate databases compress their paths with zstd, which nc-scout does not link against.
+*
+*********************************************************************************************/
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif // _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <linux/limits.h>
+
+#include "progress.h"
+#include "locate.h"
+
+#define MLOCATE_MAGIC       "\0mlocate"
+#define MLOCATE_MAGIC_LEN   8
+#define MLOCATE_HEADER_LEN  16
+#define MLOCATE_DIR_HEADER_LEN  16
+#define LOCATE02_MAGIC      "\0LOCATE02\0"
+#define LOCATE02_MAGIC_LEN  10
+#define PLOCATE_MAGIC       "\0plocate"
+#define PLOCATE_MAGIC_LEN   8
+
+// The mapped database, and the traversal its entries are visited for.
+struct LocateScan {
+    const char *db_path;
+    const char *data;
+    const char *end;
+    const struct Traversal *traversal;
+    const char *root;
+    size_t root_len;
+};
+
+static uint32_t read_u32 (const char *p)
+{
+    const unsigned char *u = (const unsigned char *)p;
+    return ((uint32_t)u[0] << 24) | ((uint32_t)u[1] << 16) | ((uint32_t)u[2] << 8) | u[3];
+}
+
+// Returns the end of the string at p, or NULL if it runs past the end of the database.
+static const char *string_end (const struct LocateScan *scan, const char *p)
+{
+    return memchr(p, '\0', scan->end - p);
+}
+
+static int depth_under_root (const struct LocateScan *scan, const char *dir_path, size_t dir_len)
+/**********************************************************************************************
+*
+*   Returns the depth of a directory below the root of the scan (0 for the root itself), or -1
+*   if it is not inside of the root.
+*
+**********************************************************************************************/
+{
+    if (dir_len < scan->root_len || memcmp(dir_path, scan->root, scan->root_len) != 0) {
+        return -1;
+    }
+    if (dir_len == scan->root_len) {
+        return 0;
+    }
+    // "/" is the only root that ends in a slash.
+    size_t start = scan->root_len;
+    if (scan->root[scan->root_len - 1] != '/') {
+        if (dir_path[start] != '/') {
+            return -1;
+        }
+        start++;
+    }
+    int depth = 1;
+    for (size_t i = start; i < dir_len; i++)
+    {
+        depth += (dir_path[i] == '/');
+    }
+    return depth;
+}
+
+static bool is_visited (const struct Traversal *traversal, int dir_depth, unsigned char type)
+{
+    if (!traversal->recursive && dir_depth > 0) {
+        return false;
+    }
+    if (traversal->filters.max_depth != 0 && dir_depth + 1 > traversal->filters.max_depth) {
+        return false;
+    }
+    unsigned char type_bit = (type == DT_DIR) ? TRAVERSE_TYPE_DIR : TRAVERSE_TYPE_FILE;
+    return traversal->filters.types == 0 || (traversal->filters.types & type_bit);
+}
+
+static void visit (const struct LocateScan *scan, struct TraverseDir *dir, const char *name, 
+                   unsigned char type)
+{
+    struct TraverseEntry entry = {.name = name, .type = type};
+    scan->traversal->visit(&entry, dir, scan->traversal->context);
+}
+
+static bool scan_mlocate (const struct LocateScan *scan)
+/**********************************************************************************************
+*
+*   Visits the entries of every directory of an mlocate database that is inside of the root.
+*   The database holds whole directories, so the entries of the directories outside of the
+*   root are skipped with one memchr() each, and never copied.
+*
+**********************************************************************************************/
+{
+    const char *p = scan->data + MLOCATE_HEADER_LEN;
+    uint32_t config_len = read_u32(scan->data + MLOCATE_MAGIC_LEN);
+    const char *db_root_end = string_end(scan, p);
+    if (db_root_end == NULL || (size_t)(scan->end - db_root_end - 1) < config_len) {
+        return false;
+    }
+    p = db_root_end + 1 + config_len;
+
+    char dir_path[PATH_MAX];
+    struct TraverseDir dir = {.abs_path = dir_path, .fd = -1, .changed = true};
+    while (p < scan->end)
+    {
+        if (scan->end - p < MLOCATE_DIR_HEADER_LEN) {
+            return false;
+        }
+        p += MLOCATE_DIR_HEADER_LEN;
+        const char *path_end = string_end(scan, p);
+        if (path_end == NULL || (size_t)(path_end - p) >= sizeof(dir_path)) {
+            return false;
+        }
+        size_t path_len = path_end - p;
+        int depth = depth_under_root(scan, p, path_len);
+        if (depth >= 0) {
+            memcpy(dir_path, p, path_len + 1);
+            dir.depth = depth;
+            PROGRESS_ADD(dirs, 1);
+        }
+        p = path_end + 1;
+
+        while (true)
+        {
+            if (p >= scan->end) {
+                return false;
+            }
+            unsigned char type = (unsigned char)*p++;
+            if (type == 2) {
+                break;
+            }
+            const char *name_end = string_end(scan, p);
+            if (type > 2 || name_end == NULL) {
+                return false;
+            }
+            if (depth >= 0) {
+                PROGRESS_ADD(entries, 1);
+                unsigned char d_type = (type == 1) ? DT_DIR : DT_REG;
+                if (is_visited(scan->traversal, depth, d_type)) {
+                    visit(scan, &dir, p, d_type);
+                }
+            }
+            p = name_end + 1;
+        }
+    }
+    return true;
+}
+
+// Decodes the path of a LOCATE02 database at p into path, given the path before it and its
+// length, returning where the path after it starts, or NULL if the database ends or is corrupt.
+// The length of path is written to path_len.
+static const char *next_locate02_path (const struct LocateScan *scan, const char *p, 
+                                       const char *previous, size_t previous_len, char *path, 
+                                       size_t *path_len, int *prefix_len)
+{
+    if (p >= scan->end) {
+        return NULL;
+    }
+    int diff = (signed char)*p++;
+    if (diff == -128) {
+        if (scan->end - p < 2) {
+            return NULL;
+        }
+        diff = (int16_t)(((uint16_t)(unsigned char)p[0] << 8) | (unsigned char)p[1]);
+        p += 2;
+    }
+    *prefix_len += diff;
+    const char *suffix_end = string_end(scan, p);
+    // A corrupt database can claim to share more of the previous path than there is of it.
+    if (*prefix_len < 0 || (size_t)*prefix_len > previous_len || suffix_end == NULL || 
+        (size_t)*prefix_len + (suffix_end - p) >= PATH_MAX) {
+        return NULL;
+    }
+    memcpy(path, previous, *prefix_len);
+    memcpy(path + *prefix_len, p, suffix_end - p + 1);
+    *path_len = (size_t)*prefix_len + (suffix_end - p);
+    return suffix_end + 1;
+}
+
+static bool scan_locate02 (const struct LocateScan *scan)
+/**********************************************************************************************
+*
+*   Visits the paths of a LOCATE02 database that are inside of the root. The format does not
+*   record types, so a path is taken to be a directory when the path after it is inside of it,
+*   which holds for every directory that is not empty, as updatedb sorts the paths.
+*
+**********************************************************************************************/
+{
+    // The path after the current one is decoded before the current one is visited, to tell
+    // whether the current one is a directory.
+    static char paths[2][PATH_MAX];
+    char *current = paths[0];
+    char *next = paths[1];
+    size_t current_len = 0;
+    size_t next_len = 0;
+    int prefix_len = 0;
+    const char *p = next_locate02_path(scan, scan->data + LOCATE02_MAGIC_LEN, "", 0, current, 
+                                       &current_len, &prefix_len);
+    if (p == NULL) {
+        return scan->data + LOCATE02_MAGIC_LEN == scan->end;
+    }
+
+    struct TraverseDir dir = {.fd = -1, .changed = true};
+    while (true)
+    {
+        const char *after = NULL;
+        if (p < scan->end) {
+            after = next_locate02_path(scan, p, current, current_len, next, &next_len, 
+                                       &prefix_len);
+            if (after == NULL) {
+                return false;
+            }
+        }
+
+        char *slash = strrchr(current, '/');
+        if (slash != NULL && slash[1] != '\0') {
+            // The parent of "/x" is "/".
+            size_t dir_len = (slash == current) ? 1 : (size_t)(slash - current);
+            int depth = depth_under_root(scan, current, dir_len);
+            if (depth >= 0) {
+                bool is_dir = (after != NULL && strncmp(next, current, current_len) == 0 && 
+                               next[current_len] == '/');
+                unsigned char d_type = (is_dir) ? DT_DIR : DT_REG;
+                PROGRESS_ADD(entries, 1);
+                if (is_visited(scan->traversal, depth, d_type)) {
+                    char saved = current[dir_len];
+                    current[dir_len] = '\0';
+                    dir.abs_path = current;
+                    dir.depth = depth;
+                    visit(scan, &dir, slash + 1, d_type);
+                    current[dir_len] = saved;
+                }
+            }
+        }
+
+        if (after == NULL) {
+            return true;
+        }
+        char *swap = current;
+        current = next;
+        next = swap;
+        current_len = next_len;
+        p = after;
+    }
+}
+
+bool locate_scan (const char *db_path, const struct Traversal *traversal, 
+                  const char *abs_root_path)
+/**********************************************************************************************
+*
+*   Visits the entries under abs_root_path listed in an mlocate or LOCATE02 database, in
+*   place of traverse_tree(). The database is mapped into memory and decoded in one pass,
+*   without a call to the filesystem being scanned. Only the recursive, filters.types and
+*   filters.max_depth fields of traversal are used: the database records no metadata to
+*   filter on, nor whether an entry is a symlink, so symlinks are visited as regular files.
+*
+*   ----------------------------------------- RETURNS -----------------------------------------
+*
+*   true if the database was read, or false after printing an error.
+*
+**********************************************************************************************/
+{
+    int fd = open(db_path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        printf("Error: cannot open locate database '%s' due to Error %d (%s).\n", 
+               db_path, errno, strerror(errno));
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == -1 || st.st_size < LOCATE02_MAGIC_LEN) {
+        printf("Error: '%s' is not a locate database.\n", db_path);
+        close(fd);
+        return false;
+    }
+    const char *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        printf("Error: cannot map locate database '%s' due to Error %d (%s).\n", 
+               db_path, errno, strerror(errno));
+        return false;
+    }
+    madvise((void *)map, st.st_size, MADV_SEQUENTIAL);
+
+    struct LocateScan scan = {
+        .db_path = db_path,
+        .data = map,
+        .end = map + st.st_size,
+        .traversal = traversal,
+        .root = abs_root_path,
+        .root_len = strlen(abs_root_path),
+    };
+    bool known = true;
+    bool valid;
+    if (st.st_size >= MLOCATE_HEADER_LEN && memcmp(map, MLOCATE_MAGIC, MLOCATE_MAGIC_LEN) == 0) {
+        valid = scan_mlocate(&scan);
+    }
+    else if (memcmp(map, LOCATE02_MAGIC, LOCATE02_MAGIC_LEN) == 0) {
+        valid = scan_locate02(&scan);
+    }
+    else if (memcmp(map, PLOCATE_MAGIC, PLOCATE_MAGIC_LEN) == 0) {
+        printf("Error: '%s' is a plocate database, whose paths are compressed with zstd. "
+               "Use an mlocate or LOCATE02 database instead.\n", db_path);
+        known = valid = false;
+    }
+    else {
+        printf("Error: '%s' is not an mlocate or LOCATE02 database.\n", db_path);
+        known = valid = false;
+    }
+    if (known && !valid) {
+        printf("Error: locate database '%s' is truncated or corrupt.\n", db_path);
+    }
+    munmap((void *)map, st.st_size);
+    return valid;
+}
+
+char *locate_root (const char *path)
+/**********************************************************************************************
+*
+*   Resolves the LOCATION of a scan of a locate database. The database can describe a tree
+*   that is not mounted here, so an absolute path that does not exist is taken as it is.
+*
+*   ----------------------------------------- RETURNS -----------------------------------------
+*
+*   The absolute path to look for in the database, or NULL after printing an error.
+*
+**********************************************************************************************/
+{
+    char *root = canonicalize_file_name(path);
+    if (root != NULL) {
+        return root;
+    }
+    if (path[0] != '/') {
+        printf("Error: '%s' does not exist, and is not an absolute path to look up in the "
+               "locate database.\n", path);
+        return NULL;
+    }
+    root = strdup(path);
+    size_t len = strlen(root);
+    while (len > 1 && root[len - 1] == '/') {
+        root[--len] = '\0';
+    }
+    return root;
+}
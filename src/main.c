@@ -35,6 +35,9 @@
 #include "help.h"
 #include "search.h"
 #include "analyze.h"
+#include "collisions.h"
+#include "lint.h"
+#include "merge.h"
 
 static int builtin_exec_help (int argc)
 {
@@ -110,7 +113,11 @@ int main (int argc, char *argv[])
     struct Subcommand Subcommands[] = 
     {
         {"search", subc_exec_search},
-        {"analyze", subc_exec_analyze}
+        {"analyze", subc_exec_analyze},
+        {"scan", subc_exec_scan},
+        {"collisions", subc_exec_collisions},
+        {"lint-identifiers", subc_exec_lint_identifiers},
+        {"merge", subc_exec_merge}
     };
 
     // Get the number of Builtins and Subcommands.
@@ -0,0 +1,362 @@
+/**********************************************************************************************
+*
+*   merge - nc-scout merge handling, operation, and output.
+*
+*   LICENSE: zlib/libpng 
+*
+*   Copyright (c) 2024-2025 Josh Hayden (@BlinkDynamo)
+*
+*   This software is provided ‘as-is’, without any express or implied
+*   warranty. In no event will the authors be held liable for any damages
+*   arising from the use of this software.
+*
+*   Permission is granted to anyone to use this software for any purpose,
+*   including commercial applications, and to alter it and redistribute it
+*   freely, subject to the following restrictions:
+*
+*   1. The origin of this software must not be misrepresented; you must not
+*   claim that you wrote the original software. If you use this software
+*   in a product, an acknowledgment in the product documentation would be
+*   appreciated but is not required.
+*
+*   2. Altered source versions must be plainly marked as such, and must not be
+*   misrepresented as being the original software.
+*
+*   3. This notice may not be removed or altered from any source
+*   distribution. 
+*
+*********************************************************************************************/
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif // _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+
+#include "help.h"
+#include "common.h"
+#include "partial.h"
+#include "policy.h"
+#include "analyze.h"
+#include "extsort.h"
+#include "merge.h"
+
+#define N_REQUIRED_ARGS 1
+
+// The fields that hold the results of a shard, rather than describe the scan.
+static const char *const result_keys[] = {"shard", "matches", "non-matches", "policy", 
+                                          "non-policy"};
+
+static bool is_result_key (const char *key)
+{
+    for (size_t i = 0; i < sizeof(result_keys) / sizeof(result_keys[0]); i++)
+    {
+        if (strcmp(key, result_keys[i]) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool same_scan (const struct Partial *a, const struct Partial *b)
+/**********************************************************************************************
+*
+*   Checks that two partial results are shards of the same scan: the same command, shard
+*   count and depth, and the same value for every field that is not a result.
+*
+*   ----------------------------------------- RETURNS -----------------------------------------
+*
+*   true if they are, otherwise false after printing an error.
+*
+**********************************************************************************************/
+{
+    for (int pass = 0; pass < 2; pass++)
+    {
+        const struct Partial *from = (pass == 0) ? a : b;
+        const struct Partial *to = (pass == 0) ? b : a;
+        for (int i = 0; i < from->n_fields; i++)
+        {
+            const char *key = from->fields[i].key;
+            if (is_result_key(key)) {
+                continue;
+            }
+            const char *value = partial_get(to, key);
+            if (value == NULL || strcmp(value, from->fields[i].value) != 0) {
+                printf("Error: '%s' and '%s' are not shards of the same scan (their %s differs).\n",
+                       a->path, b->path, key);
+                return false;
+            }
+        }
+    }
+    if (a->shard_count != b->shard_count) {
+        printf("Error: '%s' and '%s' are not shards of the same scan (their shard count differs).\n",
+               a->path, b->path);
+        return false;
+    }
+    return true;
+}
+
+static int compare_shard_index (const void *a, const void *b)
+{
+    const struct Partial *pa = a;
+    const struct Partial *pb = b;
+    return (pa->shard_index > pb->shard_index) - (pa->shard_index < pb->shard_index);
+}
+
+static bool merge_search (const struct Partial *partials, int n_partials)
+/**********************************************************************************************
+*
+*   Prints the output of every shard of a search, in the order of the shards, or merged
+*   into one sorted output if the shards were sorted with --sort.
+*
+**********************************************************************************************/
+{
+    // Sorted outputs are merged into one sorted output.
+    if (partial_get(&partials[0], "sorted") != NULL) {
+        FILE **files = xcalloc(n_partials, sizeof(FILE *));
+        for (int i = 0; i < n_partials; i++)
+        {
+            files[i] = partials[i].file;
+        }
+        bool merged = extsort_merge(files, n_partials, stdout);
+        free(files);
+        return merged;
+    }
+
+    char buf[65536];
+    for (int i = 0; i < n_partials; i++)
+    {
+        size_t n;
+        while ((n = fread(buf, 1, sizeof(buf), partials[i].file)) > 0) {
+            fwrite(buf, 1, n, stdout);
+        }
+        if (ferror(partials[i].file)) {
+            printf("Error: cannot read partial result file '%s'.\n", partials[i].path);
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool read_count (const struct Partial *partial, const char *key, unsigned long *count)
+{
+    const char *value = partial_get(partial, key);
+    char *end;
+    if (value == NULL || (*count = strtoul(value, &end, 10), *end != '\0')) {
+        printf("Error: '%s' has no valid %s field.\n", partial->path, key);
+        return false;
+    }
+    return true;
+}
+
+static bool merge_analyze_policies (const struct Partial *partials, int n_partials)
+/**********************************************************************************************
+*
+*   Sums the counts of every policy, and of the entries no policy applies to, over the
+*   shards of a policy analyze, then prints the report the unsharded analyze would have.
+*
+**********************************************************************************************/
+{
+    struct Policy *policies = NULL;
+    int n_policies = 0;
+    unsigned long non_policy_entries = 0;
+
+    for (int i = 0; i < n_partials; i++)
+    {
+        const struct Partial *partial = &partials[i];
+        int policy_index = 0;
+        for (int f = 0; f < partial->n_fields; f++)
+        {
+            if (strcmp(partial->fields[f].key, "policy") != 0) {
+                continue;
+            }
+            char name[256], convention[256], mode[16];
+            unsigned long matches, non_matches;
+            if (sscanf(partial->fields[f].value, "%255[^\t]\t%255[^\t]\t%15[^\t]\t%lu\t%lu", 
+                       name, convention, mode, &matches, &non_matches) != 5) {
+                printf("Error: '%s' has an invalid policy field.\n", partial->path);
+                return false;
+            }
+            if (i == 0) {
+                policies = xrealloc(policies, (n_policies + 1) * sizeof(struct Policy));
+                memset(&policies[n_policies], 0, sizeof(struct Policy));
+                policies[n_policies].name = strdup(name);
+                policies[n_policies].convention = strdup(convention);
+                policies[n_policies].rule.strict = (strcmp(mode, "strict") == 0);
+                n_policies++;
+            }
+            else if (policy_index >= n_policies || 
+                     strcmp(policies[policy_index].name, name) != 0) {
+                printf("Error: '%s' and '%s' are not shards of the same scan (their policies differ).\n",
+                       partials[0].path, partial->path);
+                return false;
+            }
+            policies[policy_index].matches += matches;
+            policies[policy_index].non_matches += non_matches;
+            policy_index++;
+        }
+        if (policy_index != n_policies) {
+            printf("Error: '%s' and '%s' are not shards of the same scan (their policies differ).\n",
+                   partials[0].path, partial->path);
+            return false;
+        }
+
+        unsigned long non_policy;
+        if (!read_count(partial, "non-policy", &non_policy)) {
+            return false;
+        }
+        non_policy_entries += non_policy;
+    }
+
+    analyze_print_policy_report(policies, n_policies, non_policy_entries, 
+                                partial_get(&partials[0], "policy-file"), 
+                                partial_get(&partials[0], "location"),
+                                partial_get(&partials[0], "changed-since") != NULL);
+    return true;
+}
+
+static bool merge_analyze (const struct Partial *partials, int n_partials)
+/**********************************************************************************************
+*
+*   Sums the matches and non-matches of the shards of an analyze, then prints the report the
+*   unsharded analyze would have.
+*
+**********************************************************************************************/
+{
+    const struct Partial *first = &partials[0];
+    if (partial_get(first, "policy-file") != NULL) {
+        return merge_analyze_policies(partials, n_partials);
+    }
+
+    unsigned long matches = 0;
+    unsigned long non_matches = 0;
+    for (int i = 0; i < n_partials; i++)
+    {
+        unsigned long shard_matches, shard_non_matches;
+        if (!read_count(&partials[i], "matches", &shard_matches) ||
+            !read_count(&partials[i], "non-matches", &shard_non_matches)) {
+            return false;
+        }
+        matches += shard_matches;
+        non_matches += shard_non_matches;
+    }
+
+    const char *convention = partial_get(first, "convention");
+    const char *location = partial_get(first, "location");
+    const char *mode = partial_get(first, "mode");
+    if (convention == NULL || location == NULL || mode == NULL) {
+        printf("Error: '%s' is not a partial result of an analyze.\n", first->path);
+        return false;
+    }
+    analyze_print_report(convention, strcmp(mode, "strict") == 0, location, 
+                         partial_get(first, "changed-since") != NULL, matches, non_matches);
+    return true;
+}
+
+int subc_exec_merge (int argc, char *argv[])
+/**********************************************************************************************
+*
+*   The external function called from src/main.c. Processes options, reads the partial result
+*   file of every shard, checks that together they cover the whole scan, and finally prints
+*   the output of the search or the report of the analyze.
+*
+*   ---------------------------------------- ARGUMENTS ----------------------------------------
+*
+*   argc    The argc of main() in src/main.c with 1 removed.
+*
+*   argv    The argv of main() in src/main.c with "nc-scout" removed from the beginning.
+*
+*   ----------------------------------------- RETURNS -----------------------------------------
+*
+*   It inherrits the return of main() in src/main.c, returning EXIT_FAILURE or EXIT_SUCCESS.
+*
+**********************************************************************************************/
+{
+    int current_opt;
+    while (1)
+    {
+        static struct option long_options_merge[] =
+        {
+            {"help", no_argument, 0, 'h'},
+            {0, 0, 0, 0}
+        };
+        
+        int option_index = 0;
+        current_opt = getopt_long (argc, argv, "+h", long_options_merge, &option_index);
+        // Break if at the end of the options.
+        if (current_opt == -1) {
+            break;
+        }
+
+        switch (current_opt)
+        {
+            case '?':
+                return EXIT_FAILURE;
+
+            case 'h':
+                // Make sure that there are no arguments supplied.
+                if (argc == 2) {
+                    printf("%s", HELP_MERGE);
+                    return EXIT_SUCCESS;
+                }
+                else {
+                    printf("Incorrect usage.\nDo `nc-scout merge --help` for more information about usage.\n");
+                    return EXIT_FAILURE;
+                }
+
+            default:
+                abort();
+        }
+    }
+
+    int n_partials = argc - optind;
+    if (n_partials < N_REQUIRED_ARGS) {
+        printf("Insufficient arguments.\nDo `nc-scout merge --help` for more information about usage.\n");
+        return EXIT_FAILURE;
+    }
+
+    struct Partial *partials = xcalloc(n_partials, sizeof(struct Partial));
+    for (int i = 0; i < n_partials; i++)
+    {
+        if (!partial_read(&partials[i], argv[optind + i]) || 
+            !same_scan(&partials[0], &partials[i])) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Every shard must be given exactly once.
+    qsort(partials, n_partials, sizeof(struct Partial), compare_shard_index);
+    int shard_count = partials[0].shard_count;
+    for (int i = 0, expected = 0; expected < shard_count; expected++)
+    {
+        if (i < n_partials && partials[i].shard_index == expected) {
+            if (i + 1 < n_partials && partials[i + 1].shard_index == expected) {
+                printf("Error: '%s' and '%s' are both shard %d/%d.\n", 
+                       partials[i].path, partials[i + 1].path, expected + 1, shard_count);
+                return EXIT_FAILURE;
+            }
+            i++;
+            continue;
+        }
+        printf("Error: shard %d/%d is missing.\n", expected + 1, shard_count);
+        return EXIT_FAILURE;
+    }
+
+    const char *command = partial_get(&partials[0], "command");
+    bool merged;
+    if (strcmp(command, "search") == 0) {
+        merged = merge_search(partials, n_partials);
+    }
+    else if (strcmp(command, "analyze") == 0) {
+        merged = merge_analyze(partials, n_partials);
+    }
+    else {
+        printf("Error: '%s' is a partial result of an unknown command '%s'.\n", 
+               partials[0].path, command);
+        merged = false;
+    }
+    return (merged) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,231 @@
+/**********************************************************************************************
+*
+*   metrics - Metrics of a scan, written as a Prometheus textfile.
+*
+*   LICENSE: zlib/libpng 
+*
+*   Copyright (c) 2024-2025 Josh Hayden (@BlinkDynamo)
+*
+*   This software is provided ‘as-is’, without any express or implied
+*   warranty. In no event will the authors be held liable for any damages
+*   arising from the use of this software.
+*
+*   Permission is granted to anyone to use this software for any purpose,
+*   including commercial applications, and to alter it and redistribute it
+*   freely, subject to the following restrictions:
+*
+*   1. The origin of this software must not be misrepresented; you must not
+*   claim that you wrote the original software. If you use this software
+*   in a product, an acknowledgment in the product documentation would be
+*   appreciated but is not required.
+*
+*   2. Altered source versions must be plainly marked as such, and must not be
+*   misrepresented as being the original software.
+*
+*   3. This notice may not be removed or altered from any source
+*   distribution. 
+*
+*   ----------------------------------- METRICS FILE FORMAT ----------------------------------
+*
+*   The file is in the Prometheus text exposition format, for the textfile collector of
+*   node_exporter. Every metric is a gauge labelled with the command and location of the scan:
+*
+*       nc_scout_entries_scanned            Entries read from directories.
+*       nc_scout_directories_scanned        Directories read.
+*       nc_scout_errors                     Directories that could not be opened or read.
+*       nc_scout_verdict_cache_hits         Names whose verdict was already cached.
+*       nc_scout_verdict_cache_misses       Names compared to their convention.
+*       nc_scout_scan_duration_seconds      Wall time of the scan.
+*       nc_scout_phase_seconds              Time spent in each phase (label phase).
+*       nc_scout_matches                    Entries matching their convention (labels
+*       nc_scout_violations                 convention, and policy for --policy).
+*       nc_scout_last_run_timestamp_seconds When the scan finished.
+*
+*********************************************************************************************/
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif // _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "common.h"
+#include "progress.h"
+#include "metrics.h"
+
+bool metrics_enabled = false;
+uint64_t metrics_phase_ns[N_METRICS_PHASES];
+
+static const char *const phase_names[N_METRICS_PHASES] = {"open", "read", "stat", "visit"};
+
+// The matches and violations of a convention, or of a policy.
+struct MetricsResult {
+    char *convention;
+    char *policy;                   // NULL unless the scan used --policy.
+    unsigned long matches;
+    unsigned long violations;
+};
+
+static struct MetricsResult *results = NULL;
+static int n_results = 0;
+static uint64_t scan_start;
+
+uint64_t metrics_clock (void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000 + (uint64_t)now.tv_nsec;
+}
+
+void metrics_start (void)
+{
+    metrics_enabled = true;
+    scan_start = metrics_clock();
+}
+
+void metrics_add_result (const char *convention, const char *policy, unsigned long matches, 
+                         unsigned long violations)
+{
+    results = xrealloc(results, (n_results + 1) * sizeof(struct MetricsResult));
+    results[n_results++] = (struct MetricsResult){
+        strdup(convention), (policy != NULL) ? strdup(policy) : NULL, matches, violations
+    };
+}
+
+// Writes a label value, escaping what the exposition format requires.
+static void write_label_value (FILE *file, const char *value)
+{
+    for (const char *c = value; *c != '\0'; c++)
+    {
+        if (*c == '\\' || *c == '"') {
+            fputc('\\', file);
+            fputc(*c, file);
+        }
+        else if (*c == '\n') {
+            fputs("\\n", file);
+        }
+        else {
+            fputc(*c, file);
+        }
+    }
+}
+
+static void write_header (FILE *file, const char *name, const char *help)
+{
+    fprintf(file, "# HELP %s %s\n# TYPE %s gauge\n", name, help, name);
+}
+
+static void write_labels (FILE *file, const char *command, const char *location)
+{
+    fprintf(file, "{command=\"%s\",location=\"", command);
+    write_label_value(file, location);
+    fputc('"', file);
+}
+
+static void write_result_gauge (FILE *file, const char *name, const char *command, 
+                                const char *location, bool violations)
+{
+    for (int i = 0; i < n_results; i++)
+    {
+        fputs(name, file);
+        write_labels(file, command, location);
+        fputs(",convention=\"", file);
+        write_label_value(file, results[i].convention);
+        if (results[i].policy != NULL) {
+            fputs("\",policy=\"", file);
+            write_label_value(file, results[i].policy);
+        }
+        fprintf(file, "\"} %lu\n", (violations) ? results[i].violations : results[i].matches);
+    }
+}
+
+bool metrics_write (const char *path, const char *command, const char *location)
+/**********************************************************************************************
+*
+*   Writes the metrics of the scan to path, next to it first and then renamed over it, so
+*   that the textfile collector never reads a partly written file.
+*
+*   ----------------------------------------- RETURNS -----------------------------------------
+*
+*   true if the metrics were written, otherwise false after printing an error.
+*
+**********************************************************************************************/
+{
+    double duration = (metrics_clock() - scan_start) / 1e9;
+
+    // The collector only reads files ending in .prom, so it skips the one being written.
+    size_t tmp_path_len = strlen(path) + sizeof(".tmp");
+    char *tmp_path = xrealloc(NULL, tmp_path_len);
+    snprintf(tmp_path, tmp_path_len, "%s.tmp", path);
+
+    FILE *file = fopen(tmp_path, "w");
+    if (file == NULL) {
+        printf("Error: cannot write metrics file '%s' due to Error %d (%s).\n", 
+               path, errno, strerror(errno));
+        free(tmp_path);
+        return false;
+    }
+
+    const struct {
+        const char *name;
+        const char *help;
+        unsigned long value;
+    } counters[] = {
+        {"nc_scout_entries_scanned", "Entries read from directories.", progress_counters.entries},
+        {"nc_scout_directories_scanned", "Directories read.", progress_counters.dirs},
+        {"nc_scout_errors", "Directories that could not be opened or read.", progress_counters.errors},
+        {"nc_scout_verdict_cache_hits", "Names whose verdict was cached.", 
+         progress_counters.verdict_hits},
+        {"nc_scout_verdict_cache_misses", "Names compared to their convention.", 
+         progress_counters.verdict_misses},
+    };
+    for (size_t i = 0; i < sizeof(counters) / sizeof(counters[0]); i++)
+    {
+        write_header(file, counters[i].name, counters[i].help);
+        fputs(counters[i].name, file);
+        write_labels(file, command, location);
+        fprintf(file, "} %lu\n", counters[i].value);
+    }
+
+    write_header(file, "nc_scout_scan_duration_seconds", "Wall time of the scan.");
+    fputs("nc_scout_scan_duration_seconds", file);
+    write_labels(file, command, location);
+    fprintf(file, "} %.6f\n", duration);
+
+    write_header(file, "nc_scout_phase_seconds", "Time the traversal spent in each phase.");
+    for (int phase = 0; phase < N_METRICS_PHASES; phase++)
+    {
+        fputs("nc_scout_phase_seconds", file);
+        write_labels(file, command, location);
+        fprintf(file, ",phase=\"%s\"} %.6f\n", phase_names[phase], metrics_phase_ns[phase] / 1e9);
+    }
+
+    write_header(file, "nc_scout_matches", "Entries matching their naming convention.");
+    write_result_gauge(file, "nc_scout_matches", command, location, false);
+    write_header(file, "nc_scout_violations", "Entries not matching their naming convention.");
+    write_result_gauge(file, "nc_scout_violations", command, location, true);
+
+    write_header(file, "nc_scout_last_run_timestamp_seconds", "When the scan finished.");
+    fputs("nc_scout_last_run_timestamp_seconds", file);
+    write_labels(file, command, location);
+    fprintf(file, "} %lld\n", (long long)time(NULL));
+
+    bool written = !ferror(file);
+    if (fclose(file) != 0) {
+        written = false;
+    }
+    if (!written || rename(tmp_path, path) == -1) {
+        printf("Error: cannot write metrics file '%s' due to Error %d (%s).\n", 
+               path, errno, strerror(errno));
+        unlink(tmp_path);
+        free(tmp_path);
+        return false;
+    }
+    free(tmp_path);
+    return true;
+}
@@ -60,14 +60,29 @@
 *
 *   Incorrect: "Kebab" is an incorrect lenient kebabcase name because to make it valid
 *              you must change the "K" to a "k", as well as add a "-case".
+*
+*   ------------------------------------- UNICODE MODE --------------------------------------
+*
+*   The regular expressions only accept ASCII letters and digits. In unicode mode, names are
+*   decoded as UTF-8 and matched by a hand-written matcher that follows the same structure,
+*   with [a-z] meaning any lowercase letter, [A-Z] any uppercase or titlecase letter, and
+*   [0-9] any decimal digit, caseless letter or combining mark. Character classes come from
+*   the generated two-stage tables in include/unicode_tables.h. Names that are pure ASCII
+*   skip decoding entirely, and are detected 16 bytes at a time.
 * 
 ********************************************************************************************/
 
 #include <stdio.h>
+#include <stdint.h>
 #include <string.h>
 #include <regex.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif // __SSE2__
+
 #include "naming.h"
+#include "unicode_tables.h"
 
 #define EXPR_FLATCASE_STRICT        "^\\.?[a-z0-9]+(\\.[A-Za-z0-9]+)?$"
 #define EXPR_CAMELCASE_STRICT       "^\\.?[a-z]+([A-Z][a-z0-9]+)+(\\.[A-Za-z0-9]+)?$"
@@ -85,18 +100,38 @@
 #define EXPR_KEBABCASE_LENIENT      "^\\.?[a-z0-9]+(-[a-z0-9]+)*(\\.[A-Za-z0-9]+)?$"
 #define EXPR_COBOLCASE_LENIENT      "^\\.?[A-Z0-9]+(-[A-Z0-9]+)*(\\.[A-Za-z0-9]+)?$"
 
+// Character classes of the unicode mode, as generated into include/unicode_tables.h.
+enum CharClass {
+    CLASS_OTHER     = 0,
+    CLASS_LOWER     = 1,
+    CLASS_UPPER     = 2,
+    CLASS_CASELESS  = 3,
+};
+
+// The structure of a convention's body, as followed by the unicode mode matcher.
+enum Shape {
+    SHAPE_SEPARATED,    // Words of word_class joined by separator (or a single word).
+    SHAPE_CAMEL,        // Lowercase letters followed by humps: [a-z]+([A-Z][a-z0-9]+)
+    SHAPE_PASCAL,       // Humps only: ([A-Z][a-z0-9]+)
+};
+
 static struct Convention {
     const char *name;
     const char *expr_strict;
     const char *expr_lenient;
+    enum Shape shape;
+    char separator;             // SHAPE_SEPARATED only.
+    enum CharClass word_class;  // SHAPE_SEPARATED only.
+    int min_words_strict;       // The number of words or humps a strict match requires.
+    int min_words_lenient;      // The number of words or humps a lenient match requires.
 } Conventions[] = {
-    {"flatcase", EXPR_FLATCASE_STRICT, EXPR_FLATCASE_LENIENT}, 
-    {"camelcase", EXPR_CAMELCASE_STRICT, EXPR_CAMELCASE_LENIENT},
-    {"pascalcase", EXPR_PASCALCASE_STRICT, EXPR_PASCALCASE_LENIENT},
-    {"snakecase", EXPR_SNAKECASE_STRICT, EXPR_SNAKECASE_LENIENT},
-    {"constantcase", EXPR_CONSTANTCASE_STRICT, EXPR_CONSTANTCASE_LENIENT},
-    {"kebabcase", EXPR_KEBABCASE_STRICT, EXPR_KEBABCASE_LENIENT},
-    {"cobolcase", EXPR_COBOLCASE_STRICT, EXPR_COBOLCASE_LENIENT},
+    {"flatcase", EXPR_FLATCASE_STRICT, EXPR_FLATCASE_LENIENT, SHAPE_SEPARATED, '\0', CLASS_LOWER, 1, 1}, 
+    {"camelcase", EXPR_CAMELCASE_STRICT, EXPR_CAMELCASE_LENIENT, SHAPE_CAMEL, '\0', CLASS_OTHER, 1, 0},
+    {"pascalcase", EXPR_PASCALCASE_STRICT, EXPR_PASCALCASE_LENIENT, SHAPE_PASCAL, '\0', CLASS_OTHER, 1, 1},
+    {"snakecase", EXPR_SNAKECASE_STRICT, EXPR_SNAKECASE_LENIENT, SHAPE_SEPARATED, '_', CLASS_LOWER, 2, 1},
+    {"constantcase", EXPR_CONSTANTCASE_STRICT, EXPR_CONSTANTCASE_LENIENT, SHAPE_SEPARATED, '_', CLASS_UPPER, 2, 1},
+    {"kebabcase", EXPR_KEBABCASE_STRICT, EXPR_KEBABCASE_LENIENT, SHAPE_SEPARATED, '-', CLASS_LOWER, 2, 1},
+    {"cobolcase", EXPR_COBOLCASE_STRICT, EXPR_COBOLCASE_LENIENT, SHAPE_SEPARATED, '-', CLASS_UPPER, 2, 1},
 };
 
 static const int n_members_in_Conventions = (sizeof(Conventions) / sizeof(struct Convention));
@@ -166,3 +201,338 @@ bool naming_match_regex (regex_t regex, const char *filename)
     }
     return false;
 }
+
+// Returns the name of the convention at index, or NULL if index is past the last convention.
+const char *naming_get_convention_name (int index)
+{
+    if (index < 0 || index >= n_members_in_Conventions) {
+        return NULL;
+    }
+    return Conventions[index].name;
+}
+
+// Returns true if the first len bytes of str are all ASCII, checking 16 bytes at a time.
+static bool is_ascii (const unsigned char *str, size_t len)
+{
+    size_t i = 0;
+#if defined(__SSE2__)
+    // The sign bits of 16 bytes are gathered into one mask; any set bit is a non-ASCII byte.
+    for (; i + 16 <= len; i += 16)
+    {
+        if (_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)(str + i))) != 0) {
+            return false;
+        }
+    }
+#else
+    for (; i + 8 <= len; i += 8)
+    {
+        uint64_t word;
+        memcpy(&word, str + i, sizeof(word));
+        if ((word & 0x8080808080808080ULL) != 0) {
+            return false;
+        }
+    }
+#endif // __SSE2__
+    for (; i < len; i++)
+    {
+        if (str[i] & 0x80) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static enum CharClass ascii_class (unsigned char c)
+{
+    if (c >= 'a' && c <= 'z') {
+        return CLASS_LOWER;
+    }
+    if (c >= 'A' && c <= 'Z') {
+        return CLASS_UPPER;
+    }
+    if (c >= '0' && c <= '9') {
+        return CLASS_CASELESS;
+    }
+    return CLASS_OTHER;
+}
+
+static enum CharClass unicode_class (uint32_t cp)
+{
+    unsigned char packed = unicode_stage2[unicode_stage1[cp >> UNICODE_BLOCK_SHIFT] * 64 + 
+                                          ((cp & 0xff) >> 2)];
+    return (packed >> ((cp & 3) * 2)) & 3;
+}
+
+// Returns the class of the character at *str and advances past it. Malformed UTF-8 is OTHER.
+static enum CharClass next_class (const unsigned char **str, const unsigned char *end, bool utf8)
+{
+    const unsigned char *p = *str;
+    if (!utf8 || *p < 0x80) {
+        *str = p + 1;
+        return ascii_class(*p);
+    }
+
+    int n_continuation;
+    uint32_t cp;
+    uint32_t min_cp;
+    if ((*p & 0xe0) == 0xc0) {
+        n_continuation = 1, cp = *p & 0x1f, min_cp = 0x80;
+    }
+    else if ((*p & 0xf0) == 0xe0) {
+        n_continuation = 2, cp = *p & 0x0f, min_cp = 0x800;
+    }
+    else if ((*p & 0xf8) == 0xf0) {
+        n_continuation = 3, cp = *p & 0x07, min_cp = 0x10000;
+    }
+    else {
+        *str = p + 1;
+        return CLASS_OTHER;
+    }
+    if (end - p <= n_continuation) {
+        *str = end;
+        return CLASS_OTHER;
+    }
+    for (int i = 1; i <= n_continuation; i++)
+    {
+        if ((p[i] & 0xc0) != 0x80) {
+            *str = p + i;
+            return CLASS_OTHER;
+        }
+        cp = (cp << 6) | (p[i] & 0x3f);
+    }
+    *str = p + 1 + n_continuation;
+    // Reject overlong encodings, surrogates, and code points past the last plane.
+    if (cp < min_cp || (cp >= 0xd800 && cp <= 0xdfff) || cp > 0x10ffff) {
+        return CLASS_OTHER;
+    }
+    return unicode_class(cp);
+}
+
+static enum CharClass peek_class (const unsigned char *str, const unsigned char *end, bool utf8)
+{
+    return next_class(&str, end, utf8);
+}
+
+static bool match_body (const struct Convention *convention, bool strict, bool utf8,
+                        const unsigned char *p, const unsigned char *end)
+/**********************************************************************************************
+*
+*   Matches the body of a name (the text between the optional leading period and the optional
+*   extension) against the shape of a convention, as the body of its regex would.
+*
+**********************************************************************************************/
+{
+    int min_words = (strict) ? convention->min_words_strict : convention->min_words_lenient;
+    int n_words = 0;
+
+    if (convention->shape == SHAPE_SEPARATED) {
+        int word_len = 0;
+        while (p < end)
+        {
+            if (convention->separator != '\0' && *p == convention->separator) {
+                if (word_len == 0) {
+                    return false;
+                }
+                n_words++;
+                word_len = 0;
+                p++;
+                continue;
+            }
+            enum CharClass c = next_class(&p, end, utf8);
+            if (c != CLASS_CASELESS && c != convention->word_class) {
+                return false;
+            }
+            word_len++;
+        }
+        if (word_len == 0) {
+            return false;
+        }
+        return n_words + 1 >= min_words;
+    }
+
+    // SHAPE_CAMEL starts with one or more lowercase letters, SHAPE_PASCAL with a hump.
+    int prefix_len = 0;
+    while (p < end && peek_class(p, end, utf8) == CLASS_LOWER)
+    {
+        next_class(&p, end, utf8);
+        prefix_len++;
+    }
+    if ((convention->shape == SHAPE_CAMEL) != (prefix_len > 0)) {
+        return false;
+    }
+
+    // Each hump is an uppercase letter followed by at least one lowercase letter or digit.
+    while (p < end)
+    {
+        if (next_class(&p, end, utf8) != CLASS_UPPER) {
+            return false;
+        }
+        int hump_len = 0;
+        while (p < end)
+        {
+            enum CharClass c = peek_class(p, end, utf8);
+            if (c != CLASS_LOWER && c != CLASS_CASELESS) {
+                break;
+            }
+            next_class(&p, end, utf8);
+            hump_len++;
+        }
+        if (hump_len == 0) {
+            return false;
+        }
+        n_words++;
+    }
+    return n_words >= min_words;
+}
+
+bool naming_match_native (int convention_index, bool strict, bool unicode, const char *filename)
+/**********************************************************************************************
+*
+*   Matches a filename against a convention without regex, giving the same answers as its
+*   regex for ASCII names. In unicode mode, non-ASCII names are decoded as UTF-8 and matched
+*   by Unicode character class, while pure ASCII names take the same path as without it.
+*
+*   ---------------------------------------- ARGUMENTS ----------------------------------------
+*
+*   convention_index    The index of the convention, as given by naming_get_convention_name().
+*
+*   strict              Whether to match the convention strictly or leniently.
+*
+*   unicode             Whether to decode non-ASCII names as UTF-8.
+*
+*   filename            The filename to match.
+*
+*   ----------------------------------------- RETURNS -----------------------------------------
+*
+*   True if filename matches the convention.
+*
+**********************************************************************************************/
+{
+    const struct Convention *convention = &Conventions[convention_index];
+    const unsigned char *p = (const unsigned char *)filename;
+    size_t len = strlen(filename);
+    const unsigned char *end = p + len;
+    bool utf8 = unicode && !is_ascii(p, len);
+
+    // The body cannot be empty or contain a period, so a leading period is never the body.
+    if (p < end && *p == '.') {
+        p++;
+    }
+
+    // The extension is everything after the next period, and must be one non-empty word.
+    const unsigned char *body_end = memchr(p, '.', end - p);
+    if (body_end != NULL) {
+        const unsigned char *ext = body_end + 1;
+        if (ext == end) {
+            return false;
+        }
+        while (ext < end)
+        {
+            if (*ext == '.' || next_class(&ext, end, utf8) == CLASS_OTHER) {
+                return false;
+            }
+        }
+    }
+    else {
+        body_end = end;
+    }
+    return match_body(convention, strict, utf8, p, body_end);
+}
+
+bool naming_compile_rule (struct NamingRule *rule, const char *arg_naming_convention, 
+                          bool strict_flag, bool unicode_flag)
+/**********************************************************************************************
+*
+*   Prepares a rule for naming_match_rule(). The regex of the convention is compiled unless
+*   unicode_flag is set, in which case the native matcher is used instead.
+*
+*   ---------------------------------------- ARGUMENTS ----------------------------------------
+*
+*   rule                    The rule to prepare.
+*
+*   arg_naming_convention   The name of the convention, as supplied by the user.
+*
+*   strict_flag             Whether to match the convention strictly or leniently.
+*
+*   unicode_flag            Whether to accept non-ASCII letters and digits.
+*
+*   ----------------------------------------- RETURNS -----------------------------------------
+*
+*   True if the rule was prepared, false (after printing an error) if not.
+*
+**********************************************************************************************/
+{
+    const char *expression;
+    if (!naming_set_expression(arg_naming_convention, &expression, strict_flag)) {
+        return false;
+    }
+    rule->convention = 0;
+    while (strcmp(Conventions[rule->convention].name, arg_naming_convention) != 0)
+    {
+        rule->convention++;
+    }
+    rule->strict = strict_flag;
+    rule->unicode = unicode_flag;
+    return unicode_flag || naming_compile_regex(&rule->regex, expression);
+}
+
+// Returns true if filename matches the convention of a rule prepared by naming_compile_rule().
+bool naming_match_rule (const struct NamingRule *rule, const char *filename)
+{
+    if (rule->unicode) {
+        return naming_match_native(rule->convention, rule->strict, true, filename);
+    }
+    return regexec(&rule->regex, filename, 0, NULL, 0) == 0;
+}
+
+size_t naming_normalize (const char *filename, char *buf, size_t size)
+/**********************************************************************************************
+*
+*   Writes the canonical form of a filename to buf: its filename body in lowercase, with the
+*   word separators '_', '-' and ' ' dropped, followed by its lowercased extension. Every
+*   other character is kept, so c.h and c++.h stay apart. Names that would collide on a
+*   case-insensitive filesystem, or differ only by convention (foobar, foo_bar, foo-bar,
+*   fooBar, FOO_BAR), have the same canonical form. Words are not split at camel humps, as an
+*   all-lowercase spelling of the same name has none.
+*
+*   ---------------------------------------- ARGUMENTS ----------------------------------------
+*
+*   filename    The filename to normalize.
+*
+*   buf         Where the NUL-terminated form is written.
+*
+*   size        The size of buf. The form is truncated to fit.
+*
+*   ----------------------------------------- RETURNS -----------------------------------------
+*
+*   The length of the form written to buf.
+*
+**********************************************************************************************/
+{
+    size_t len = 0;
+    const char *p = filename;
+    if (size == 0) {
+        return 0;
+    }
+    if (*p == '.') {
+        buf[len++] = *p++;
+    }
+    const char *extension = strrchr(p, '.');
+    const char *body_end = (extension != NULL) ? extension : p + strlen(p);
+
+    for (; p < body_end && len + 1 < size; p++)
+    {
+        unsigned char c = *p;
+        if (c != '_' && c != '-' && c != ' ') {
+            buf[len++] = (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+        }
+    }
+
+    for (p = extension; p != NULL && *p != '\0' && len + 1 < size; p++)
+    {
+        unsigned char c = *p;
+        buf[len++] = (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+    }
+    buf[len] = '\0';
+    return len;
+}
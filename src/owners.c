@@ -0,0 +1,226 @@
+/**********************************************************************************************
+*
+*   owners - Reading the owners of entries a directory at a time, and counting them by owner.
+*
+*   LICENSE: zlib/libpng 
+*
+*   Copyright (c) 2024-2025 Josh Hayden (@BlinkDynamo)
+*
+*   This software is provided ‘as-is’, without any express or implied
+*   warranty. In no event will the authors be held liable for any damages
+*   arising from the use of this software.
+*
+*   Permission is granted to anyone to use this software for any purpose,
+*   including commercial applications, and to alter it and redistribute it
+*   freely, subject to the following restrictions:
+*
+*   1. The origin of this software must not be misrepresented; you must not
+*   claim that you wrote the original software. If you use this software
+*   in a product, an acknowledgment in the product documentation would be
+*   appreciated but is not required.
+*
+*   2. Altered source versions must be plainly marked as such, and must not be
+*   misrepresented as being the original software.
+*
+*   3. This notice may not be removed or altered from any source
+*   distribution. 
+*
+*********************************************************************************************/
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif // _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <pwd.h>
+#include <sys/stat.h>
+
+#include "common.h"
+#include "progress.h"
+#include "throttle.h"
+#include "metrics.h"
+#include "owners.h"
+
+#define OWNERS_INITIAL_SIZE 16
+
+// The batch being sorted by owners_stat(), as qsort() passes no context.
+static const struct OwnerBatch *sorting_batch = NULL;
+
+static int compare_request_inodes (const void *a, const void *b)
+{
+    ino_t ino_a = sorting_batch->requests[*(const size_t *)a].ino;
+    ino_t ino_b = sorting_batch->requests[*(const size_t *)b].ino;
+    return (ino_a > ino_b) - (ino_a < ino_b);
+}
+
+void owners_request (struct OwnerBatch *batch, const struct TraverseEntry *entry, const char *tag)
+{
+    // Asks for the owner of an entry of the directory being read, at its owners_stat().
+    if (batch->n_requests == batch->capacity) {
+        batch->capacity = (batch->capacity == 0) ? 64 : batch->capacity * 2;
+        batch->requests = xrealloc(batch->requests, batch->capacity * sizeof(struct OwnerRequest));
+        batch->order = xrealloc(batch->order, batch->capacity * sizeof(size_t));
+    }
+    batch->requests[batch->n_requests++] = (struct OwnerRequest){
+        .name = entry->name,
+        .ino = entry->ino,
+        .tag = (tag != NULL) ? strdup(tag) : NULL,
+    };
+}
+
+void owners_stat (struct OwnerBatch *batch, const struct TraverseDir *dir)
+/**********************************************************************************************
+*
+*   Reads the owner of every entry requested in dir, which must still be open, with one
+*   statx() per entry relative to dir->fd that asks for STATX_UID alone. The calls are made in
+*   inode order, which on most filesystems is close to the order of the inodes on disk.
+*
+**********************************************************************************************/
+{
+    for (size_t i = 0; i < batch->n_requests; i++)
+    {
+        batch->order[i] = i;
+    }
+    sorting_batch = batch;
+    qsort(batch->order, batch->n_requests, sizeof(size_t), compare_request_inodes);
+
+    for (size_t k = 0; k < batch->n_requests; k++)
+    {
+        struct OwnerRequest *request = &batch->requests[batch->order[k]];
+        struct statx stx;
+        throttle_begin(false);
+        uint64_t started = METRICS_START();
+        int status = statx(dir->fd, request->name, AT_SYMLINK_NOFOLLOW, STATX_UID, &stx);
+        METRICS_STOP(METRICS_PHASE_STAT, started);
+        throttle_end();
+        request->found = (status == 0 && (stx.stx_mask & STATX_UID));
+        if (request->found) {
+            request->uid = stx.stx_uid;
+        }
+        else {
+            PROGRESS_ADD(errors, 1);
+        }
+    }
+}
+
+void owners_clear (struct OwnerBatch *batch)
+{
+    // Forgets the requests of the directory that was just answered.
+    for (size_t i = 0; i < batch->n_requests; i++)
+    {
+        free(batch->requests[i].tag);
+    }
+    batch->n_requests = 0;
+}
+
+static struct OwnerCount *find_owner (struct OwnerTable *table, uid_t uid)
+{
+    // Returns the slot of uid, adding it if it is new.
+    if ((table->used + 1) * 2 > table->size) {
+        struct OwnerCount *old_slots = table->slots;
+        size_t old_size = table->size;
+        table->size = (old_size == 0) ? OWNERS_INITIAL_SIZE : old_size * 2;
+        table->slots = xrealloc(NULL, table->size * sizeof(struct OwnerCount));
+        memset(table->slots, 0, table->size * sizeof(struct OwnerCount));
+        for (size_t i = 0; i < old_size; i++)
+        {
+            if (old_slots[i].used) {
+                size_t j = old_slots[i].uid & (table->size - 1);
+                while (table->slots[j].used)
+                {
+                    j = (j + 1) & (table->size - 1);
+                }
+                table->slots[j] = old_slots[i];
+            }
+        }
+        free(old_slots);
+    }
+
+    size_t i = uid & (table->size - 1);
+    while (table->slots[i].used && table->slots[i].uid != uid)
+    {
+        i = (i + 1) & (table->size - 1);
+    }
+    if (!table->slots[i].used) {
+        table->slots[i] = (struct OwnerCount){.used = true, .uid = uid};
+        table->used++;
+    }
+    return &table->slots[i];
+}
+
+static const char *resolve_name (struct OwnerCount *owner)
+{
+    // Looks up the name of the owner once, falling back on the uid.
+    if (owner->name == NULL) {
+        struct passwd *pw = getpwuid(owner->uid);
+        if (pw != NULL) {
+            owner->name = strdup(pw->pw_name);
+        }
+        else {
+            char uid[32];
+            snprintf(uid, sizeof(uid), "%lu", (unsigned long)owner->uid);
+            owner->name = strdup(uid);
+        }
+    }
+    return owner->name;
+}
+
+void owners_count (struct OwnerTable *table, const struct OwnerRequest *request)
+{
+    // Counts an answered request against its owner.
+    if (request->found) {
+        find_owner(table, request->uid)->count++;
+    }
+    else {
+        table->unknown++;
+    }
+}
+
+const char *owners_name (struct OwnerTable *table, const struct OwnerRequest *request)
+{
+    // Returns the name of the owner of an answered request, or "?" if it could not be read.
+    return (request->found) ? resolve_name(find_owner(table, request->uid)) : "?";
+}
+
+static int compare_owner_counts (const void *a, const void *b)
+{
+    const struct OwnerCount *owner_a = a;
+    const struct OwnerCount *owner_b = b;
+    if (owner_a->count != owner_b->count) {
+        return (owner_a->count < owner_b->count) ? 1 : -1;
+    }
+    return (owner_a->uid > owner_b->uid) - (owner_a->uid < owner_b->uid);
+}
+
+void owners_print (struct OwnerTable *table, const char *what)
+/**********************************************************************************************
+*
+*   Prints the count of every owner, most first, resolving each uid to a name once. what
+*   names the entries that were counted, such as "non-matches".
+*
+**********************************************************************************************/
+{
+    struct OwnerCount *owners = xrealloc(NULL, (table->used + 1) * sizeof(struct OwnerCount));
+    size_t n_owners = 0;
+    for (size_t i = 0; i < table->size; i++)
+    {
+        if (table->slots[i].used) {
+            resolve_name(&table->slots[i]);
+            owners[n_owners++] = table->slots[i];
+        }
+    }
+    qsort(owners, n_owners, sizeof(struct OwnerCount), compare_owner_counts);
+
+    printf("\n%-20s %12s\n", "owner", what);
+    for (size_t i = 0; i < n_owners; i++)
+    {
+        printf("%-20s %12lu\n", owners[i].name, owners[i].count);
+    }
+    if (table->unknown > 0) {
+        printf("%-20s %12lu\n", "?", table->unknown);
+    }
+    free(owners);
+}
@@ -0,0 +1,212 @@
+/**********************************************************************************************
+*
+*   partial - Partial results of one shard of a scan, combined by the merge subcommand.
+*
+*   LICENSE: zlib/libpng 
+*
+*   Copyright (c) 2024-2025 Josh Hayden (@BlinkDynamo)
+*
+*   This software is provided ‘as-is’, without any express or implied
+*   warranty. In no event will the authors be held liable for any damages
+*   arising from the use of this software.
+*
+*   Permission is granted to anyone to use this software for any purpose,
+*   including commercial applications, and to alter it and redistribute it
+*   freely, subject to the following restrictions:
+*
+*   1. The origin of this software must not be misrepresented; you must not
+*   claim that you wrote the original software. If you use this software
+*   in a product, an acknowledgment in the product documentation would be
+*   appreciated but is not required.
+*
+*   2. Altered source versions must be plainly marked as such, and must not be
+*   misrepresented as being the original software.
+*
+*   3. This notice may not be removed or altered from any source
+*   distribution. 
+*
+*   ---------------------------------- PARTIAL FILE FORMAT -----------------------------------
+*
+*   A header of one "key value" line per field, starting with:
+*
+*       nc-scout-partial 1
+*       command search|analyze
+*       shard i/N
+*       shard-depth K
+*
+*   followed by the fields of the command. A search then has an "output" line, after which
+*   every line is a line of its output. Keys can repeat, as the "policy" lines of an analyze do.
+*
+*********************************************************************************************/
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif // _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include "common.h"
+#include "partial.h"
+
+// The file being written next to the path given to partial_create().
+static char *tmp_path = NULL;
+
+FILE *partial_create (const char *path, const char *command, int shard_index, int shard_count,
+                      int shard_depth)
+/**********************************************************************************************
+*
+*   Starts writing a partial result file, with the fields every partial result has. The
+*   file is written next to path until partial_commit() renames it over path.
+*
+*   ----------------------------------------- RETURNS -----------------------------------------
+*
+*   The file to write the fields of the command to, or NULL after printing an error.
+*
+**********************************************************************************************/
+{
+    size_t tmp_path_len = strlen(path) + sizeof(".tmp");
+    tmp_path = xrealloc(tmp_path, tmp_path_len);
+    snprintf(tmp_path, tmp_path_len, "%s.tmp", path);
+
+    FILE *file = fopen(tmp_path, "w");
+    if (file == NULL) {
+        printf("Error: cannot write partial result file '%s' due to Error %d (%s).\n", 
+               path, errno, strerror(errno));
+        return NULL;
+    }
+    fprintf(file, "%s\n", PARTIAL_MAGIC);
+    fprintf(file, "command %s\n", command);
+    fprintf(file, "shard %d/%d\n", shard_index + 1, shard_count);
+    fprintf(file, "shard-depth %d\n", shard_depth);
+    return file;
+}
+
+FILE *partial_reopen (const char *path)
+/**********************************************************************************************
+*
+*   Reopens a partial result file that partial_create() started but that was never committed,
+*   to carry on writing it from a checkpoint.
+*
+*   ----------------------------------------- RETURNS -----------------------------------------
+*
+*   The file, positioned at its start, or NULL after printing an error.
+*
+**********************************************************************************************/
+{
+    size_t tmp_path_len = strlen(path) + sizeof(".tmp");
+    tmp_path = xrealloc(tmp_path, tmp_path_len);
+    snprintf(tmp_path, tmp_path_len, "%s.tmp", path);
+
+    FILE *file = fopen(tmp_path, "r+");
+    if (file == NULL) {
+        printf("Error: cannot reopen partial result file '%s' due to Error %d (%s).\n", 
+               tmp_path, errno, strerror(errno));
+    }
+    return file;
+}
+
+bool partial_commit (FILE *file, const char *path)
+{
+    bool written = !ferror(file);
+    if (fclose(file) != 0) {
+        written = false;
+    }
+    if (!written || rename(tmp_path, path) == -1) {
+        printf("Error: cannot write partial result file '%s' due to Error %d (%s).\n", 
+               path, errno, strerror(errno));
+        unlink(tmp_path);
+        return false;
+    }
+    return true;
+}
+
+static bool read_error (struct Partial *partial, const char *reason)
+{
+    printf("Error: '%s' is not a partial result file (%s).\n", partial->path, reason);
+    fclose(partial->file);
+    partial->file = NULL;
+    return false;
+}
+
+bool partial_read (struct Partial *partial, const char *path)
+/**********************************************************************************************
+*
+*   Reads the header of a partial result file, leaving the file open at its output (if any).
+*
+*   ----------------------------------------- RETURNS -----------------------------------------
+*
+*   true if the header was read, or false after printing an error.
+*
+**********************************************************************************************/
+{
+    memset(partial, 0, sizeof(*partial));
+    partial->path = path;
+    partial->file = fopen(path, "r");
+    if (partial->file == NULL) {
+        printf("Error: cannot open partial result file '%s' due to Error %d (%s).\n", 
+               path, errno, strerror(errno));
+        return false;
+    }
+
+    char *line = NULL;
+    size_t line_capacity = 0;
+    ssize_t len;
+    bool first = true;
+    while ((len = getline(&line, &line_capacity, partial->file)) != -1)
+    {
+        if (len > 0 && line[len - 1] == '\n') {
+            line[--len] = '\0';
+        }
+        if (first) {
+            first = false;
+            if (strcmp(line, PARTIAL_MAGIC) != 0) {
+                free(line);
+                return read_error(partial, "unknown first line");
+            }
+            continue;
+        }
+        if (strcmp(line, "output") == 0) {
+            break;
+        }
+
+        char *separator = strchr(line, ' ');
+        if (separator == NULL) {
+            free(line);
+            return read_error(partial, "field without a value");
+        }
+        *separator = '\0';
+        partial->fields = xrealloc(partial->fields, 
+                                   (partial->n_fields + 1) * sizeof(struct PartialField));
+        partial->fields[partial->n_fields].key = strdup(line);
+        partial->fields[partial->n_fields].value = strdup(separator + 1);
+        partial->n_fields++;
+    }
+    free(line);
+
+    const char *shard = partial_get(partial, "shard");
+    const char *shard_depth = partial_get(partial, "shard-depth");
+    if (first || partial_get(partial, "command") == NULL || shard == NULL || shard_depth == NULL ||
+        sscanf(shard, "%d/%d", &partial->shard_index, &partial->shard_count) != 2 ||
+        partial->shard_index < 1 || partial->shard_index > partial->shard_count) {
+        return read_error(partial, "missing or invalid shard");
+    }
+    partial->shard_index--;
+    partial->shard_depth = atoi(shard_depth);
+    return true;
+}
+
+// Returns the value of the first field with key, or NULL.
+const char *partial_get (const struct Partial *partial, const char *key)
+{
+    for (int i = 0; i < partial->n_fields; i++)
+    {
+        if (strcmp(partial->fields[i].key, key) == 0) {
+            return partial->fields[i].value;
+        }
+    }
+    return NULL;
+}
@@ -0,0 +1,231 @@
+/**********************************************************************************************
+*
+*   pipeline - Overlapping the reading, classifying and writing of entries on three threads.
+*
+*   LICENSE: zlib/libpng 
+*
+*   Copyright (c) 2024-2025 Josh Hayden (@BlinkDynamo)
+*
+*   This software is provided ‘as-is’, without any express or implied
+*   warranty. In no event will the authors be held liable for any damages
+*   arising from the use of this software.
+*
+*   Permission is granted to anyone to use this software for any purpose,
+*   including commercial applications, and to alter it and redistribute it
+*   freely, subject to the following restrictions:
+*
+*   1. The origin of this software must not be misrepresented; you must not
+*   claim that you wrote the original software. If you use this software
+*   in a product, an acknowledgment in the product documentation would be
+*   appreciated but is not required.
+*
+*   2. Altered source versions must be plainly marked as such, and must not be
+*   misrepresented as being the original software.
+*
+*   3. This notice may not be removed or altered from any source
+*   distribution. 
+*
+*   ---------------------------------------- PIPELINE ----------------------------------------
+*
+*   The thread running the traversal copies the entries it visits into batches. The
+*   classifier thread decides which entries are printed, and the writer thread prints them
+*   and hands the batches back to the reader:
+*
+*       reader --filled--> classifier --classified--> writer --empty--> reader
+*
+*   Each arrow is a single-producer/single-consumer ring, so passing a batch along takes no
+*   lock. A stage that finds its ring empty (or full) spins briefly, then yields, then
+*   sleeps, so the slowest stage sets the pace and the others wait on it.
+*
+*********************************************************************************************/
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif // _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sched.h>
+
+#include "common.h"
+#include "pipeline.h"
+
+// Attempts before a waiting stage yields, and then sleeps between attempts.
+#define SPINS_BEFORE_YIELD  64
+#define SPINS_BEFORE_SLEEP  128
+#define SLEEP_NS            50000
+
+static void wait_turn (unsigned *spins)
+{
+    if (++*spins < SPINS_BEFORE_YIELD) {
+        return;
+    }
+    if (*spins < SPINS_BEFORE_SLEEP) {
+        sched_yield();
+        return;
+    }
+    struct timespec sleep_time = {.tv_sec = 0, .tv_nsec = SLEEP_NS};
+    nanosleep(&sleep_time, NULL);
+}
+
+static void ring_push (struct PipelineRing *ring, struct PipelineBatch *batch)
+{
+    size_t tail = ring->tail;
+    unsigned spins = 0;
+    while (tail - __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) == PIPELINE_BATCHES)
+    {
+        wait_turn(&spins);
+    }
+    ring->slots[tail % PIPELINE_BATCHES] = batch;
+    __atomic_store_n(&ring->tail, tail + 1, __ATOMIC_RELEASE);
+}
+
+static struct PipelineBatch *ring_pop (struct PipelineRing *ring)
+{
+    size_t head = ring->head;
+    unsigned spins = 0;
+    while (__atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) == head)
+    {
+        wait_turn(&spins);
+    }
+    struct PipelineBatch *batch = ring->slots[head % PIPELINE_BATCHES];
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+    return batch;
+}
+
+static void *run_classifier (void *arg)
+{
+    struct Pipeline *pipeline = arg;
+    struct PipelineBatch *batch;
+    while ((batch = ring_pop(&pipeline->filled)) != NULL)
+    {
+        pipeline->classify(batch, pipeline->context);
+        ring_push(&pipeline->classified, batch);
+    }
+    ring_push(&pipeline->classified, NULL);
+    return NULL;
+}
+
+static void *run_writer (void *arg)
+{
+    struct Pipeline *pipeline = arg;
+    struct PipelineBatch *batch;
+    while ((batch = ring_pop(&pipeline->classified)) != NULL)
+    {
+        pipeline->write(batch, pipeline->context);
+        batch->n_entries = 0;
+        batch->n_bytes = 0;
+        ring_push(&pipeline->empty, batch);
+    }
+    return NULL;
+}
+
+bool pipeline_start (struct Pipeline *pipeline, 
+                     void (*classify)(struct PipelineBatch *batch, void *context),
+                     void (*write)(const struct PipelineBatch *batch, void *context),
+                     void *context)
+/**********************************************************************************************
+*
+*   Starts the classifier and writer threads. pipeline_visit() is then the visit function of
+*   the traversal, with the pipeline as its context.
+*
+*   ---------------------------------------- ARGUMENTS ----------------------------------------
+*
+*   classify        Sets print (and tag) on the entries of a batch, on the classifier thread.
+*
+*   write           Prints the entries of a batch that have print set, on the writer thread.
+*
+*   context         Passed to classify and write.
+*
+*   ----------------------------------------- RETURNS -----------------------------------------
+*
+*   false after printing an error if a thread could not be started, otherwise true.
+*
+**********************************************************************************************/
+{
+    memset(pipeline, 0, sizeof(*pipeline));
+    pipeline->batches = xcalloc(PIPELINE_BATCHES, sizeof(struct PipelineBatch));
+    for (int i = 0; i < PIPELINE_BATCHES; i++)
+    {
+        ring_push(&pipeline->empty, &pipeline->batches[i]);
+    }
+    pipeline->classify = classify;
+    pipeline->write = write;
+    pipeline->context = context;
+
+    if (pthread_create(&pipeline->classifier, NULL, run_classifier, pipeline) != 0) {
+        printf("Error: cannot start the classifier thread.\n");
+        free(pipeline->batches);
+        return false;
+    }
+    if (pthread_create(&pipeline->writer, NULL, run_writer, pipeline) != 0) {
+        printf("Error: cannot start the writer thread.\n");
+        ring_push(&pipeline->filled, NULL);
+        pthread_join(pipeline->classifier, NULL);
+        free(pipeline->batches);
+        return false;
+    }
+    pipeline->current = ring_pop(&pipeline->empty);
+    return true;
+}
+
+void pipeline_visit (const struct TraverseEntry *entry, const struct TraverseDir *dir, 
+                     void *pipeline)
+/**********************************************************************************************
+*
+*   Copies an entry into the batch being filled, passing the batch to the classifier once it
+*   is full. The entries of a directory are visited together, so its path is copied once per
+*   batch rather than once per entry.
+*
+**********************************************************************************************/
+{
+    struct Pipeline *p = pipeline;
+    struct PipelineBatch *batch = p->current;
+    size_t name_size = strlen(entry->name) + 1;
+    const char *last_dir_path = (batch->n_entries > 0) ? 
+                                batch->entries[batch->n_entries - 1].abs_dir_path : NULL;
+    bool same_dir = (last_dir_path != NULL && strcmp(last_dir_path, dir->abs_path) == 0);
+    size_t dir_size = (same_dir) ? 0 : strlen(dir->abs_path) + 1;
+
+    if (batch->n_entries == PIPELINE_BATCH_ENTRIES || 
+        batch->n_bytes + dir_size + name_size > PIPELINE_BATCH_BYTES) {
+        ring_push(&p->filled, batch);
+        batch = p->current = ring_pop(&p->empty);
+        same_dir = false;
+        dir_size = strlen(dir->abs_path) + 1;
+    }
+
+    struct PipelineEntry *copy = &batch->entries[batch->n_entries++];
+    if (same_dir) {
+        copy->abs_dir_path = last_dir_path;
+    }
+    else {
+        copy->abs_dir_path = memcpy(batch->bytes + batch->n_bytes, dir->abs_path, dir_size);
+        batch->n_bytes += dir_size;
+    }
+    copy->name = memcpy(batch->bytes + batch->n_bytes, entry->name, name_size);
+    batch->n_bytes += name_size;
+    copy->type = entry->type;
+    copy->print = false;
+    copy->tag = NULL;
+}
+
+void pipeline_finish (struct Pipeline *pipeline)
+/**********************************************************************************************
+*
+*   Passes on the last batch, and waits for the classifier and writer to finish with it.
+*
+**********************************************************************************************/
+{
+    if (pipeline->current->n_entries > 0) {
+        ring_push(&pipeline->filled, pipeline->current);
+    }
+    ring_push(&pipeline->filled, NULL);
+    pthread_join(pipeline->classifier, NULL);
+    pthread_join(pipeline->writer, NULL);
+    free(pipeline->batches);
+    pipeline->batches = NULL;
+    pipeline->current = NULL;
+}
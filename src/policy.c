@@ -0,0 +1,429 @@
+/**********************************************************************************************
+*
+*   policy - Loads policy files and finds the policy that applies to an entry.
+*
+*   LICENSE: zlib/libpng
+*
+*   Copyright (c) 2024-2025 Josh Hayden (@BlinkDynamo)
+*
+*   This software is provided ‘as-is’, without any express or implied
+*   warranty. In no event will the authors be held liable for any damages
+*   arising from the use of this software.
+*
+*   Permission is granted to anyone to use this software for any purpose,
+*   including commercial applications, and to alter it and redistribute it
+*   freely, subject to the following restrictions:
+*
+*   1. The origin of this software must not be misrepresented; you must not
+*   claim that you wrote the original software. If you use this software
+*   in a product, an acknowledgment in the product documentation would be
+*   appreciated but is not required.
+*
+*   2. Altered source versions must be plainly marked as such, and must not be
+*   misrepresented as being the original software.
+*
+*   3. This notice may not be removed or altered from any source
+*   distribution.
+*
+*   ----------------------------------- POLICY FILE FORMAT -----------------------------------
+*
+*   One policy per line, with '#' starting a comment:
+*
+*       NAME    TYPES   EXTENSIONS  PREFIX  CONVENTION  [strict|lenient]
+*
+*   NAME        A name for the policy, used when reporting.
+*   TYPES       file, dir, symlink, or any, or a comma separated list of them.
+*   EXTENSIONS  A comma separated list of extensions (without the period), '-' for entries
+*               without an extension, or '*' for any extension.
+*   PREFIX      A path relative to the searched directory that entries must be under, or '*'.
+*   CONVENTION  The naming convention entries of the policy must follow.
+*
+*   The first policy (in file order) that applies to an entry is the one it is checked
+*   against. Entries no policy applies to are not checked.
+*
+*********************************************************************************************/
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif // _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <dirent.h>
+
+#include "common.h"
+#include "policy.h"
+
+#define MAX_EXTENSION_LEN   64
+#define MAX_HASH_SEEDS      4096
+
+// An extension as written in a policy file, and the policies naming it.
+struct ExtensionKey {
+    char *extension;
+    bool *in_policy;
+};
+
+// Prints an error about one line of a policy file.
+static void print_line_error (const char *policy_path, int line_number, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    printf("Error: %s:%d: ", policy_path, line_number);
+    vprintf(format, args);
+    va_end(args);
+}
+
+// Hashes an extension case-insensitively, finishing with a mix so the low bits are usable.
+static uint64_t hash_extension (const char *extension, size_t len, uint64_t seed)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL ^ (seed * 0x9e3779b97f4a7c15ULL);
+    for (size_t i = 0; i < len; i++)
+    {
+        hash ^= (unsigned char)tolower((unsigned char)extension[i]);
+        hash *= 0x100000001b3ULL;
+    }
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+// Returns the extension of a name (without the period), or "" if it has none.
+static const char *get_extension (const char *name)
+{
+    const char *dot = strrchr(name, '.');
+    // A leading period starts a dotfile, not an extension.
+    return (dot == NULL || dot == name) ? "" : dot + 1;
+}
+
+static bool parse_types (const char *field, unsigned char *types)
+{
+    char *copy = strdup(field);
+    char *saveptr;
+    *types = 0;
+    for (char *type = strtok_r(copy, ",", &saveptr); type != NULL; type = strtok_r(NULL, ",", &saveptr))
+    {
+        if (strcmp(type, "file") == 0) {
+            *types |= POLICY_TYPE_FILE;
+        }
+        else if (strcmp(type, "dir") == 0) {
+            *types |= POLICY_TYPE_DIR;
+        }
+        else if (strcmp(type, "symlink") == 0) {
+            *types |= POLICY_TYPE_SYMLINK;
+        }
+        else if (strcmp(type, "any") == 0) {
+            *types |= POLICY_TYPE_FILE | POLICY_TYPE_DIR | POLICY_TYPE_SYMLINK;
+        }
+        else {
+            free(copy);
+            return false;
+        }
+    }
+    free(copy);
+    return *types != 0;
+}
+
+static bool build_perfect_hash (struct PolicyTable *table)
+/**********************************************************************************************
+*
+*   Finds a seed for which every extension of table->candidates (other than the last list,
+*   which is for all other extensions) hashes to a distinct slot, doubling the number of
+*   slots whenever no seed in MAX_HASH_SEEDS works. A lookup is then one hash and one
+*   string comparison.
+*
+**********************************************************************************************/
+{
+    int n_keys = table->n_candidates - 1;
+    uint32_t size = 8;
+    while (size < (uint32_t)n_keys * 2)
+    {
+        size *= 2;
+    }
+
+    for (; size <= (1u << 24); size *= 2)
+    {
+        free(table->slots);
+        table->slots = xcalloc(size, sizeof(int));
+        table->slots_mask = size - 1;
+        for (uint64_t seed = 1; seed <= MAX_HASH_SEEDS; seed++)
+        {
+            bool collision = false;
+            memset(table->slots, 0xff, size * sizeof(int));
+            for (int i = 0; i < n_keys && !collision; i++)
+            {
+                const char *extension = table->candidates[i].extension;
+                uint32_t slot = hash_extension(extension, strlen(extension), seed) & table->slots_mask;
+                collision = table->slots[slot] != -1;
+                table->slots[slot] = i;
+            }
+            if (!collision) {
+                table->hash_seed = seed;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+static bool parse_policy_line (struct PolicyTable *table, const char *policy_path, int line_number,
+                               char *line, struct ExtensionKey **keys, int *n_keys, 
+                               bool **any_extension, bool strict_flag, bool unicode_flag)
+/**********************************************************************************************
+*
+*   Parses one line of a policy file into a new policy of table, recording the extensions it
+*   names in keys (and whether it names any extension in any_extension).
+*
+**********************************************************************************************/
+{
+    char *fields[7];
+    int n_fields = 0;
+    char *saveptr;
+    for (char *field = strtok_r(line, " \t\r\n", &saveptr); field != NULL && n_fields < 7; 
+         field = strtok_r(NULL, " \t\r\n", &saveptr))
+    {
+        fields[n_fields++] = field;
+    }
+    if (n_fields == 0) {
+        return true;
+    }
+    if (n_fields < 5 || n_fields > 6) {
+        print_line_error(policy_path, line_number, 
+                         "expected NAME TYPES EXTENSIONS PREFIX CONVENTION [strict|lenient].\n");
+        return false;
+    }
+
+    int index = table->n_policies++;
+    table->policies = xrealloc(table->policies, table->n_policies * sizeof(struct Policy));
+    *any_extension = xrealloc(*any_extension, table->n_policies * sizeof(bool));
+    for (int k = 0; k < *n_keys; k++)
+    {
+        (*keys)[k].in_policy = xrealloc((*keys)[k].in_policy, table->n_policies * sizeof(bool));
+        (*keys)[k].in_policy[index] = false;
+    }
+    struct Policy *policy = &table->policies[index];
+    memset(policy, 0, sizeof(*policy));
+    policy->name = strdup(fields[0]);
+    policy->convention = strdup(fields[4]);
+
+    if (!parse_types(fields[1], &policy->types)) {
+        print_line_error(policy_path, line_number, 
+                         "'%s' is not a list of file, dir, symlink, or any.\n", fields[1]);
+        return false;
+    }
+
+    (*any_extension)[index] = strcmp(fields[2], "*") == 0;
+    char *ext_saveptr;
+    for (char *extension = strtok_r(fields[2], ",", &ext_saveptr); 
+         extension != NULL && !(*any_extension)[index];
+         extension = strtok_r(NULL, ",", &ext_saveptr))
+    {
+        extension += (extension[0] == '.');
+        if (strcmp(extension, "-") == 0) {
+            extension = "";
+        }
+        if (strlen(extension) > MAX_EXTENSION_LEN) {
+            print_line_error(policy_path, line_number, "extension '%s' is too long.\n", extension);
+            return false;
+        }
+        int k = 0;
+        while (k < *n_keys && strcasecmp((*keys)[k].extension, extension) != 0)
+        {
+            k++;
+        }
+        if (k == *n_keys) {
+            *keys = xrealloc(*keys, (*n_keys + 1) * sizeof(struct ExtensionKey));
+            (*keys)[k].extension = strdup(extension);
+            (*keys)[k].in_policy = xcalloc(table->n_policies, sizeof(bool));
+            (*n_keys)++;
+        }
+        (*keys)[k].in_policy[index] = true;
+    }
+
+    if (strcmp(fields[3], "*") != 0) {
+        const char *prefix = fields[3];
+        while (prefix[0] == '.' && prefix[1] == '/')
+        {
+            prefix += 2;
+        }
+        policy->prefix = strdup(prefix);
+        policy->prefix_len = strlen(prefix);
+        // "src/" and "src" name the same directory.
+        while (policy->prefix_len > 0 && prefix[policy->prefix_len - 1] == '/')
+        {
+            policy->prefix_len--;
+        }
+    }
+
+    bool strict = strict_flag;
+    if (n_fields == 6) {
+        if (strcmp(fields[5], "strict") != 0 && strcmp(fields[5], "lenient") != 0) {
+            print_line_error(policy_path, line_number, "'%s' is neither strict nor lenient.\n", 
+                             fields[5]);
+            return false;
+        }
+        strict = strcmp(fields[5], "strict") == 0;
+    }
+    if (!naming_compile_rule(&policy->rule, policy->convention, strict, unicode_flag)) {
+        print_line_error(policy_path, line_number, "policy '%s' has no valid convention.\n", 
+                         policy->name);
+        return false;
+    }
+    return true;
+}
+
+bool policy_load (struct PolicyTable *table, const char *policy_path, bool strict_flag, 
+                  bool unicode_flag)
+/**********************************************************************************************
+*
+*   Loads a policy file, compiles the convention of every policy, and builds the perfect hash
+*   used by policy_lookup().
+*
+*   ---------------------------------------- ARGUMENTS ----------------------------------------
+*
+*   table           The table to fill.
+*
+*   policy_path     The path of the policy file.
+*
+*   strict_flag     Whether policies that do not say strict or lenient are strict.
+*
+*   unicode_flag    Whether conventions accept non-ASCII letters and digits.
+*
+*   ----------------------------------------- RETURNS -----------------------------------------
+*
+*   True if the policy file was loaded, false (after printing an error) if not.
+*
+**********************************************************************************************/
+{
+    FILE *policy_file = fopen(policy_path, "r");
+    if (policy_file == NULL) {
+        printf("Error: cannot open policy file '%s'.\n", policy_path);
+        return false;
+    }
+    memset(table, 0, sizeof(*table));
+
+    struct ExtensionKey *keys = NULL;
+    int n_keys = 0;
+    bool *any_extension = NULL;
+    char *line = NULL;
+    size_t line_capacity = 0;
+    int line_number = 0;
+    bool ok = true;
+
+    while (ok && getline(&line, &line_capacity, policy_file) != -1)
+    {
+        line_number++;
+        char *comment = strchr(line, '#');
+        if (comment != NULL) {
+            *comment = '\0';
+        }
+        ok = parse_policy_line(table, policy_path, line_number, line, &keys, &n_keys, 
+                               &any_extension, strict_flag, unicode_flag);
+    }
+    free(line);
+    fclose(policy_file);
+
+    if (ok && table->n_policies == 0) {
+        printf("Error: policy file '%s' has no policies.\n", policy_path);
+        ok = false;
+    }
+
+    if (ok) {
+        // One candidate list per extension, then one for every other extension.
+        table->n_candidates = n_keys + 1;
+        table->candidates = xcalloc(table->n_candidates, sizeof(struct PolicyCandidates));
+        for (int k = 0; k < table->n_candidates; k++)
+        {
+            struct PolicyCandidates *candidates = &table->candidates[k];
+            candidates->extension = (k < n_keys) ? keys[k].extension : NULL;
+            candidates->indices = xcalloc(table->n_policies, sizeof(int));
+            for (int i = 0; i < table->n_policies; i++)
+            {
+                if (any_extension[i] || (k < n_keys && keys[k].in_policy[i])) {
+                    candidates->indices[candidates->n_indices++] = i;
+                }
+            }
+        }
+        if (!build_perfect_hash(table)) {
+            printf("Error: could not build a perfect hash of the extensions in '%s'.\n",
+                   policy_path);
+            ok = false;
+        }
+    }
+
+    for (int k = 0; k < n_keys; k++)
+    {
+        free(keys[k].in_policy);
+    }
+    free(keys);
+    free(any_extension);
+    return ok;
+}
+
+// Returns true if relative_dir is the directory prefix, or a directory below it. Matching ends
+// at a component boundary, so a prefix of src does not apply to src2.
+static bool path_has_prefix (const char *relative_dir, const char *prefix, size_t prefix_len)
+{
+    if (prefix_len == 0) {
+        return true;
+    }
+    return strncmp(relative_dir, prefix, prefix_len) == 0 && 
+           (relative_dir[prefix_len] == '\0' || relative_dir[prefix_len] == '/');
+}
+
+struct Policy *policy_lookup (const struct PolicyTable *table, const char *name, 
+                              unsigned char d_type, const char *relative_dir)
+/**********************************************************************************************
+*
+*   Finds the first policy that applies to an entry. The extension of the entry selects the
+*   candidate policies with one probe of the perfect hash, and the candidates are checked in
+*   file order against the type and path of the entry.
+*
+*   ---------------------------------------- ARGUMENTS ----------------------------------------
+*
+*   table           The loaded policies.
+*
+*   name            The name of the entry.
+*
+*   d_type          The d_type of the entry.
+*
+*   relative_dir    The path of the entry's directory relative to the searched directory.
+*
+*   ----------------------------------------- RETURNS -----------------------------------------
+*
+*   The policy that applies to the entry, or NULL if none does.
+*
+**********************************************************************************************/
+{
+    unsigned char type = (d_type == DT_DIR) ? POLICY_TYPE_DIR :
+                         (d_type == DT_LNK) ? POLICY_TYPE_SYMLINK : POLICY_TYPE_FILE;
+
+    const char *extension = get_extension(name);
+    size_t extension_len = strlen(extension);
+    const struct PolicyCandidates *candidates = &table->candidates[table->n_candidates - 1];
+    if (extension_len <= MAX_EXTENSION_LEN) {
+        uint32_t slot = hash_extension(extension, extension_len, table->hash_seed) & table->slots_mask;
+        int k = table->slots[slot];
+        if (k >= 0 && strcasecmp(table->candidates[k].extension, extension) == 0) {
+            candidates = &table->candidates[k];
+        }
+    }
+
+    for (int i = 0; i < candidates->n_indices; i++)
+    {
+        struct Policy *policy = &table->policies[candidates->indices[i]];
+        if (!(policy->types & type)) {
+            continue;
+        }
+        if (policy->prefix != NULL && 
+            !path_has_prefix(relative_dir, policy->prefix, policy->prefix_len)) {
+            continue;
+        }
+        return policy;
+    }
+    return NULL;
+}
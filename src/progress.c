@@ -0,0 +1,209 @@
+/**********************************************************************************************
+*
+*   progress - Reports the progress of a scan to stderr from a separate thread.
+*
+*   LICENSE: zlib/libpng
+*
+*   Copyright (c) 2024-2025 Josh Hayden (@BlinkDynamo)
+*
+*   This software is provided ‘as-is’, without any express or implied
+*   warranty. In no event will the authors be held liable for any damages
+*   arising from the use of this software.
+*
+*   Permission is granted to anyone to use this software for any purpose,
+*   including commercial applications, and to alter it and redistribute it
+*   freely, subject to the following restrictions:
+*
+*   1. The origin of this software must not be misrepresented; you must not
+*   claim that you wrote the original software. If you use this software
+*   in a product, an acknowledgment in the product documentation would be
+*   appreciated but is not required.
+*
+*   2. Altered source versions must be plainly marked as such, and must not be
+*   misrepresented as being the original software.
+*
+*   3. This notice may not be removed or altered from any source
+*   distribution.
+*
+*********************************************************************************************/
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif // _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/statvfs.h>
+
+#include "progress.h"
+
+struct ProgressCounters progress_counters;
+
+static pthread_t reporter;
+static pthread_mutex_t reporter_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t reporter_wake = PTHREAD_COND_INITIALIZER;
+static bool reporter_running = false;
+static bool reporter_stopping = false;
+
+static double report_interval;
+static struct timespec scan_start;
+static unsigned long used_inodes;   // 0 if the filesystem does not report inode counts.
+static bool stderr_is_tty;
+
+static double seconds_since (const struct timespec *start)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+// Formats a number of seconds as e.g. "1h02m03s" into buf.
+static void format_duration (char *buf, size_t size, double seconds)
+{
+    unsigned long total = (unsigned long)seconds;
+    if (total >= 3600) {
+        snprintf(buf, size, "%luh%02lum%02lus", total / 3600, (total / 60) % 60, total % 60);
+    }
+    else if (total >= 60) {
+        snprintf(buf, size, "%lum%02lus", total / 60, total % 60);
+    }
+    else {
+        snprintf(buf, size, "%lus", total);
+    }
+}
+
+static void print_report (unsigned long *last_entries, double *last_elapsed, bool final)
+/**********************************************************************************************
+*
+*   Prints one progress line to stderr. On a terminal, each line overwrites the previous one.
+*   The rate is measured since the previous report, while the ETA uses the average rate and
+*   the number of used inodes on the filesystem, so it is an upper bound when scanning only
+*   part of a filesystem. The final line also gives the hits and misses of the verdict cache.
+*
+**********************************************************************************************/
+{
+    unsigned long dirs = __atomic_load_n(&progress_counters.dirs, __ATOMIC_RELAXED);
+    unsigned long entries = __atomic_load_n(&progress_counters.entries, __ATOMIC_RELAXED);
+    unsigned long violations = __atomic_load_n(&progress_counters.violations, __ATOMIC_RELAXED);
+    unsigned long errors = __atomic_load_n(&progress_counters.errors, __ATOMIC_RELAXED);
+    double elapsed = seconds_since(&scan_start);
+
+    double interval = elapsed - *last_elapsed;
+    double rate = (interval > 0.0) ? (entries - *last_entries) / interval : 0.0;
+    *last_entries = entries;
+    *last_elapsed = elapsed;
+
+    char elapsed_buf[32];
+    char eta_buf[32] = "unknown";
+    format_duration(elapsed_buf, sizeof(elapsed_buf), elapsed);
+    if (final) {
+        snprintf(eta_buf, sizeof(eta_buf), "done");
+    }
+    else if (used_inodes > 0 && entries > 0) {
+        double average_rate = entries / elapsed;
+        double remaining = (used_inodes > entries) ? (double)(used_inodes - entries) : 0.0;
+        format_duration(eta_buf, sizeof(eta_buf), remaining / average_rate);
+    }
+
+    char cache_buf[64] = "";
+    if (final) {
+        snprintf(cache_buf, sizeof(cache_buf), ", %lu cache hits, %lu cache misses",
+                 __atomic_load_n(&progress_counters.verdict_hits, __ATOMIC_RELAXED),
+                 __atomic_load_n(&progress_counters.verdict_misses, __ATOMIC_RELAXED));
+    }
+
+    fprintf(stderr, "%s[nc-scout] %s: %lu dirs, %lu entries, %lu violations, %lu errors, "
+            "%.0f entries/s, ETA %s%s%s",
+            (stderr_is_tty) ? "\r\033[K" : "",
+            elapsed_buf, dirs, entries, violations, errors, rate, eta_buf, cache_buf,
+            (stderr_is_tty && !final) ? "" : "\n");
+    fflush(stderr);
+}
+
+static void *reporter_main (void *arg)
+{
+    (void)arg;
+    unsigned long last_entries = 0;
+    double last_elapsed = 0.0;
+
+    pthread_mutex_lock(&reporter_lock);
+    while (!reporter_stopping)
+    {
+        struct timespec wake_at;
+        clock_gettime(CLOCK_REALTIME, &wake_at);
+        wake_at.tv_sec += (time_t)report_interval;
+        wake_at.tv_nsec += (long)((report_interval - (time_t)report_interval) * 1e9);
+        if (wake_at.tv_nsec >= 1000000000L) {
+            wake_at.tv_sec++;
+            wake_at.tv_nsec -= 1000000000L;
+        }
+        int rc = 0;
+        while (!reporter_stopping && rc != ETIMEDOUT)
+        {
+            rc = pthread_cond_timedwait(&reporter_wake, &reporter_lock, &wake_at);
+        }
+        if (!reporter_stopping) {
+            print_report(&last_entries, &last_elapsed, false);
+        }
+    }
+    pthread_mutex_unlock(&reporter_lock);
+    print_report(&last_entries, &last_elapsed, true);
+    return NULL;
+}
+
+bool progress_start (const char *abs_root_path, double interval_seconds)
+/**********************************************************************************************
+*
+*   Starts the reporter thread, which prints the progress counters to stderr every
+*   interval_seconds until progress_stop() is called. The scanning thread only ever adds to
+*   progress_counters, so reporting adds no locking or formatting to the scan itself.
+*
+*   ---------------------------------------- ARGUMENTS ----------------------------------------
+*
+*   abs_root_path       The directory being scanned. The used inodes of its filesystem give
+*                       the ETA.
+*
+*   interval_seconds    The time between two reports.
+*
+*   ----------------------------------------- RETURNS -----------------------------------------
+*
+*   True if the reporter thread started, false (after printing an error) if not.
+*
+**********************************************************************************************/
+{
+    struct statvfs fs;
+    used_inodes = 0;
+    if (statvfs(abs_root_path, &fs) == 0 && fs.f_files > fs.f_ffree) {
+        used_inodes = fs.f_files - fs.f_ffree;
+    }
+    report_interval = interval_seconds;
+    stderr_is_tty = isatty(STDERR_FILENO);
+    clock_gettime(CLOCK_MONOTONIC, &scan_start);
+
+    reporter_stopping = false;
+    if (pthread_create(&reporter, NULL, reporter_main, NULL) != 0) {
+        printf("Error: cannot start the progress reporter.\n");
+        return false;
+    }
+    reporter_running = true;
+    return true;
+}
+
+// Stops the reporter thread after a final report, if it was started.
+void progress_stop (void)
+{
+    if (!reporter_running) {
+        return;
+    }
+    pthread_mutex_lock(&reporter_lock);
+    reporter_stopping = true;
+    pthread_cond_signal(&reporter_wake);
+    pthread_mutex_unlock(&reporter_lock);
+    pthread_join(reporter, NULL);
+    reporter_running = false;
+}
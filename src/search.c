@@ -1,6 +1,6 @@
 /**********************************************************************************************
 *
-*   search - Handles options, validation, and runtime of the nc-scout search subcommand.
+*   search - Handles options, validation, and runtime of the nc-scout search and scan subcommands.
 *
 *   LICENSE: zlib/libpng
 *
@@ -43,60 +43,628 @@
 #include "validate.h"
 #include "common.h"
 #include "naming.h"
+#include "traverse.h"
+#include "policy.h"
+#include "progress.h"
+#include "throttle.h"
+#include "baseline.h"
+#include "partial.h"
+#include "checkpoint.h"
+#include "metrics.h"
+#include "locate.h"
+#include "pipeline.h"
+#include "analyze.h"
+#include "extsort.h"
+#include "owners.h"
+#include "verdicts.h"
 #include "search.h"
 
 #define N_REQUIRED_ARGS 2
 
+// Seconds between two reports of --progress.
+#define PROGRESS_DEFAULT_INTERVAL 1.0
+
+// Long options without a short equivalent.
+enum {
+    OPT_CHANGED_SINCE = 256,
+    OPT_POLICY,
+    OPT_PROGRESS,
+    OPT_MAX_IOPS,
+    OPT_MAX_DIRS_PER_SEC,
+    OPT_ADAPTIVE,
+    OPT_BASELINE,
+    OPT_WRITE_BASELINE,
+    OPT_SHARD,
+    OPT_SHARD_DEPTH,
+    OPT_PARTIAL,
+    OPT_CHECKPOINT,
+    OPT_CHECKPOINT_INTERVAL,
+    OPT_RESUME,
+    OPT_TYPE,
+    OPT_MAX_DEPTH,
+    OPT_MIN_SIZE,
+    OPT_OWNER,
+    OPT_METRICS_FILE,
+    OPT_INODE_ORDER,
+    OPT_LOCATE_DB,
+    OPT_PIPELINE,
+    OPT_CHECK_COMPONENTS,
+    OPT_SORT,
+    OPT_SORT_MEMORY,
+    OPT_SHOW_OWNER,
+};
+
 // Flags.
 static bool full_path_flag      = false;
 static bool non_matches_flag    = false;
 static bool strict_flag         = false;
 static bool recursive_flag      = false;
+static bool changed_since_flag  = false;
+static bool unicode_flag        = false;
+
+// Set by --changed-since.
+static struct statx_timestamp changed_since;
+
+// Set by --policy.
+static const char *policy_path = NULL;
+
+// Set by --progress. 0 if progress is not reported.
+static double progress_interval = 0.0;
+
+// Set by --max-iops, --max-dirs-per-sec and --adaptive. 0 if not limited.
+static double max_iops = 0.0;
+static double max_dirs_per_sec = 0.0;
+static bool adaptive_flag = false;
+
+// Set by --baseline and --write-baseline.
+static const char *baseline_path = NULL;
+static const char *write_baseline_path = NULL;
+static struct Baseline baseline;
+static struct BaselineWriter baseline_writer;
+
+// Set by --shard, --shard-depth and --partial. The slice is counted from 0.
+static int shard_index = 0;
+static int shard_count = 1;
+static int shard_depth = 1;
+static const char *partial_path = NULL;
+
+// Set by --type, --max-depth, --min-size and --owner.
+static struct TraverseFilters filters;
+
+// Set by --inode-order.
+static bool inode_order_flag = false;
+
+// Set by --locate-db.
+static const char *locate_db_path = NULL;
+
+// Set by --pipeline.
+static bool pipeline_flag = false;
+
+// Set by --check-components.
+static bool check_components_flag = false;
+
+// Set by --sort and --sort-memory. The output is held here until the traversal is done.
+static bool sort_flag = false;
+static uint64_t sort_budget = EXTSORT_DEFAULT_BUDGET;
+static struct ExtSort sorted_output;
+
+// Set by --show-owner. The entries of a directory to display wait in owner_batch for their
+// owners, whose names are looked up once each in owner_names.
+static bool show_owner_flag = false;
+static struct OwnerBatch owner_batch;
+static struct OwnerTable owner_names;
+
+// The verdicts of names already compared, by convention or by index of the policy. Used by
+// the thread classifying entries, which is the traversal unless --pipeline is set.
+static struct VerdictCache verdict_cache;
+
+// Set by the scan subcommand, which also reports the totals of an analyze.
+static bool summary_flag = false;
+static const char *command_name = "search";
+
+// Entries no policy applies to, for the summary of a policy scan.
+static unsigned long non_policy_entries = 0;
+
+// Symlinks counted by a convention scan. They are listed as a search lists them, but left out
+// of the totals, as an analyze does not check them.
+static unsigned long symlink_matches = 0;
+static unsigned long symlink_non_matches = 0;
+
+// Set by --metrics-file.
+static const char *metrics_path = NULL;
+
+// Set by --checkpoint, --checkpoint-interval and --resume.
+static const char *checkpoint_path = NULL;
+static double checkpoint_interval = CHECKPOINT_DEFAULT_INTERVAL;
+static const char *resume_path = NULL;
+
+// Everything a checkpoint must agree on to be resumed by this search.
+static char scan_description[PATH_MAX + 256];
+static const struct PolicyTable *checkpoint_table = NULL;
+
+// Entries matching and not matching the convention, for --metrics-file.
+static unsigned long matches = 0;
+static unsigned long non_matches = 0;
+
+// Where matches or non-matches are printed: stdout, or the --partial file.
+static FILE *output = NULL;
 
 static const char *abs_initial_search_path = NULL;
 
-static void process_current_file (struct dirent *current_file, const char *abs_search_path,
-                           const char *abs_initial_search_path, regex_t regex)
+static bool is_new_violation (const char *abs_dir_path, const char *name)
+/**********************************************************************************************
+*
+*   Records a violation for --write-baseline, and checks whether it is in the --baseline.
+*   Both identify it by the hash of its path relative to the searched directory.
+*
+*   ----------------------------------------- RETURNS -----------------------------------------
+*
+*   false if the violation is in the baseline and should be suppressed, otherwise true.
+*
+**********************************************************************************************/
+{
+    if (baseline_path == NULL && write_baseline_path == NULL) {
+        return true;
+    }
+
+    const char *relative_path = get_relative_path(abs_initial_search_path, abs_dir_path);
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s%s%s", relative_path, (*relative_path) ? "/" : "", name);
+    uint64_t hash = hash_string(path);
+
+    if (write_baseline_path != NULL) {
+        baseline_add(&baseline_writer, hash);
+    }
+    return baseline_path == NULL || !baseline_contains(&baseline, hash);
+}
+
+static void print_entry (const char *abs_dir_path, const char *name, const char *tag, 
+                         const char *owner)
+{
+    // Prints an entry, followed by a tab and tag (its policy, or the component it fails on)
+    // and by a tab and owner, for those that are set. If relative_path is empty (current
+    // directory), no forward-slash is inserted between it and name.
+    const char *dir_path = (full_path_flag) ? abs_dir_path : 
+                           get_relative_path(abs_initial_search_path, abs_dir_path);
+    const char *separator = (full_path_flag || *dir_path) ? "/" : "";
+    if (sort_flag) {
+        char line[2 * PATH_MAX];
+        snprintf(line, sizeof(line), "%s%s%s%s%s%s%s", dir_path, separator, name, 
+                 (tag != NULL) ? "\t" : "", (tag != NULL) ? tag : "",
+                 (owner != NULL) ? "\t" : "", (owner != NULL) ? owner : "");
+        extsort_add(&sorted_output, line);
+        return;
+    }
+    fprintf(output, "%s%s%s%s%s%s%s\n", dir_path, separator, name, 
+            (tag != NULL) ? "\t" : "", (tag != NULL) ? tag : "",
+            (owner != NULL) ? "\t" : "", (owner != NULL) ? owner : "");
+}
+
+static void display_entry (const struct TraverseEntry *current_file, 
+                           const struct TraverseDir *current_dir, const char *tag)
+{
+    // With --show-owner, entries are printed once the owners of the whole directory are read.
+    if (show_owner_flag) {
+        owners_request(&owner_batch, current_file, tag);
+    }
+    else {
+        print_entry(current_dir->abs_path, current_file->name, tag, NULL);
+    }
+}
+
+static void finish_current_dir (const struct TraverseDir *current_dir, void *context)
+/**********************************************************************************************
+*
+*   Reads the owners of the entries of a directory to be displayed for --show-owner, then
+*   prints them, in the order they were visited. Called by traverse_tree() once every entry
+*   of the directory has been visited.
+*
+**********************************************************************************************/
+{
+    (void)context;
+    owners_stat(&owner_batch, current_dir);
+    for (size_t i = 0; i < owner_batch.n_requests; i++)
+    {
+        const struct OwnerRequest *request = &owner_batch.requests[i];
+        print_entry(current_dir->abs_path, request->name, request->tag, 
+                    owners_name(&owner_names, request));
+    }
+    owners_clear(&owner_batch);
+}
+
+static bool record_verdict (bool is_match, const char *abs_dir_path, const char *name, 
+                            unsigned char type)
+/**********************************************************************************************
+*
+*   Counts an entry as a match or a non-match, and checks a non-match against the --baseline.
+*   A scan also counts the symlinks among them, to leave them out of its totals.
+*
+*   ----------------------------------------- RETURNS -----------------------------------------
+*
+*   true if the entry should be printed, given non_matches_flag and the --baseline.
+*
+**********************************************************************************************/
+{
+    if (is_match) {
+        matches++;
+    }
+    else {
+        non_matches++;
+    }
+    if (summary_flag && type == DT_LNK) {
+        if (is_match) {
+            symlink_matches++;
+        }
+        else {
+            symlink_non_matches++;
+        }
+    }
+    if (!is_match) {
+        if (!is_new_violation(abs_dir_path, name)) {
+            return false;
+        }
+        PROGRESS_ADD(violations, 1);
+    }
+    return is_match != non_matches_flag;
+}
+
+// Compares a d_name to a regular expression, returning whether the entry should be printed.
+static bool check_current_file (const struct NamingRule *rule, const char *abs_dir_path, 
+                                const char *name, unsigned char type)
+{
+    return record_verdict(verdicts_match(&verdict_cache, 0, rule, name), abs_dir_path, name, type);
+}
+
+static unsigned int mark_component (const struct TraverseEntry *subdir, 
+                                    const struct TraverseDir *dir, void *context)
+/**********************************************************************************************
+*
+*   Works out the --check-components verdict of a subdirectory from that of its parent. Called
+*   by traverse_tree() once for every subdirectory, and by process_component_file() for every
+*   other entry, so each component of a path is compared to the convention once at most.
+*
+*   ----------------------------------------- RETURNS -----------------------------------------
+*
+*   The depth of the first component of the path that does not match (1 for an entry of the
+*   searched directory), or 0 if every component matches. The name is not compared at all
+*   once a directory above it does not match.
+*
+**********************************************************************************************/
+{
+    if (dir->mark != 0) {
+        return dir->mark;
+    }
+    bool is_match = verdicts_match(&verdict_cache, 0, context, subdir->name);
+    return (is_match) ? 0 : (unsigned int)dir->depth + 1;
+}
+
+static void component_path (char *buf, size_t size, const char *abs_dir_path, int dir_depth,
+                            const char *name, unsigned int mark)
+/**********************************************************************************************
+*
+*   Writes the path of the first component that does not match, given the mark of an entry
+*   in abs_dir_path, displayed the same way as the entry is.
+*
+**********************************************************************************************/
+{
+    const char *relative_path = get_relative_path(abs_initial_search_path, abs_dir_path);
+    const char *display_dir = (full_path_flag) ? abs_dir_path : relative_path;
+    if (mark > (unsigned int)dir_depth) {
+        // The entry is the first component that does not match.
+        snprintf(buf, size, "%s%s%s", display_dir, (*display_dir) ? "/" : "", name);
+        return;
+    }
+    // Otherwise it is a directory above the entry, mark components into relative_path.
+    const char *end = relative_path;
+    for (unsigned int depth = 1; depth <= mark; depth++)
+    {
+        end += strcspn(end, "/") + (depth < mark);
+    }
+    snprintf(buf, size, "%.*s", (int)(end - display_dir), display_dir);
+}
+
+static void process_component_file (const struct TraverseEntry *current_file,
+                                    const struct TraverseDir *current_dir, void *context)
+/**********************************************************************************************
+*
+*   Checks the whole path of an entry below the searched directory for --check-components,
+*   printing a non-match with the first component that does not match. Called by
+*   traverse_tree() for every entry it visits.
+*
+*   ---------------------------------------- ARGUMENTS ----------------------------------------
+*
+*   current_file    The current file being processed.
+*
+*   current_dir     The directory current_file is in, with the mark of its path.
+*
+*   context         The rule of the convention being searched for.
+*
+**********************************************************************************************/
+{
+    // The mark of a subdirectory was already worked out when its directory was read.
+    unsigned int mark = (current_file->type == DT_DIR) ? current_file->mark : 
+                        mark_component(current_file, current_dir, context);
+    if (!record_verdict(mark == 0, current_dir->abs_path, current_file->name, current_file->type)) {
+        return;
+    }
+    char cause[PATH_MAX];
+    if (mark != 0) {
+        component_path(cause, sizeof(cause), current_dir->abs_path, current_dir->depth, 
+                       current_file->name, mark);
+    }
+    display_entry(current_file, current_dir, (mark != 0) ? cause : NULL);
+}
+
+static const char *check_policy_file (const struct PolicyTable *table, const char *abs_dir_path, 
+                                      const char *name, unsigned char type)
+/**********************************************************************************************
+*
+*   Compares a d_name to the convention of the policy that applies to it, if any, counting it
+*   as a match or a non-match of that policy.
+*
+*   ----------------------------------------- RETURNS -----------------------------------------
+*
+*   The name of the policy if the entry should be printed, otherwise NULL.
+*
+**********************************************************************************************/
+{
+    const char *relative_path = get_relative_path(abs_initial_search_path, abs_dir_path);
+    struct Policy *policy = policy_lookup(table, name, type, relative_path);
+    if (policy == NULL) {
+        non_policy_entries++;
+        return NULL;
+    }
+
+    bool is_match = verdicts_match(&verdict_cache, (unsigned int)(policy - table->policies), 
+                                   &policy->rule, name);
+    if (is_match) {
+        policy->matches++;
+    }
+    else {
+        policy->non_matches++;
+    }
+    if (!is_match) {
+        if (!is_new_violation(abs_dir_path, name)) {
+            return NULL;
+        }
+        PROGRESS_ADD(violations, 1);
+    }
+    return (is_match != non_matches_flag) ? policy->name : NULL;
+}
+
+static void process_current_file (const struct TraverseEntry *current_file,
+                                  const struct TraverseDir *current_dir, void *context)
 /**********************************************************************************************
 *
 *   Compares a d_name to a regular expression. Will print matches or non-matches depending on 
-*   matches_flag.
+*   matches_flag. Called by traverse_tree() for every entry it visits.
 *
 *   ---------------------------------------- ARGUMENTS ----------------------------------------
 *
-*   current_file                The pointer to the current file being processed.
+*   current_file    The current file being processed.
 *
-*   abs_search_path             The absolute path of the dir current_file is searching in.
+*   current_dir     The directory current_file is in.
 *
-*   abs_initial_search_path     The absolute path to the dir where search was first called.
+*   context         The rule of the convention being searched for.
 *
-*   regex                       The compiled regex of the convention being searched for.
+**********************************************************************************************/
+{
+    if (check_current_file(context, current_dir->abs_path, current_file->name, 
+                           current_file->type)) {
+        display_entry(current_file, current_dir, NULL);
+    }
+}
+
+/**********************************************************************************************
+*
+*   The visit functions of a plain convention search, with no --sort or --show-owner and not a
+*   scan, written out once for every combination of -n and -f so neither is tested for every
+*   entry. Each compares a d_name once, only counts the entries it does not display, and prints
+*   the rest straight to the output. search_directory() picks one of them from search_kernels[].
+*
+**********************************************************************************************/
+#define DEFINE_SEARCH_KERNEL(function, display_non_matches, display_full_path) \
+static void function (const struct TraverseEntry *current_file, \
+                      const struct TraverseDir *current_dir, void *context) \
+{ \
+    const char *name = current_file->name; \
+    if (verdicts_match(&verdict_cache, 0, context, name)) { \
+        matches++; \
+        if (display_non_matches) { \
+            return; \
+        } \
+    } \
+    else { \
+        non_matches++; \
+        if (!is_new_violation(current_dir->abs_path, name)) { \
+            return; \
+        } \
+        PROGRESS_ADD(violations, 1); \
+        if (!display_non_matches) { \
+            return; \
+        } \
+    } \
+    if (display_full_path) { \
+        fprintf(output, "%s/%s\n", current_dir->abs_path, name); \
+    } \
+    else { \
+        const char *dir_path = get_relative_path(abs_initial_search_path, current_dir->abs_path); \
+        fprintf(output, "%s%s%s\n", dir_path, (*dir_path) ? "/" : "", name); \
+    } \
+}
+
+DEFINE_SEARCH_KERNEL(search_matches_relative, false, false)
+DEFINE_SEARCH_KERNEL(search_matches_full, false, true)
+DEFINE_SEARCH_KERNEL(search_non_matches_relative, true, false)
+DEFINE_SEARCH_KERNEL(search_non_matches_full, true, true)
+
+// Indexed by non_matches_flag, then full_path_flag.
+static void (*const search_kernels[2][2])(const struct TraverseEntry *, const struct TraverseDir *,
+                                          void *) = {
+    {search_matches_relative, search_matches_full},
+    {search_non_matches_relative, search_non_matches_full},
+};
+
+static void process_policy_file (const struct TraverseEntry *current_file,
+                                 const struct TraverseDir *current_dir, void *context)
+/**********************************************************************************************
+*
+*   Compares a d_name to the convention of the policy that applies to it, if any. Will print
+*   matches or non-matches depending on matches_flag, followed by the name of the policy.
+*   Called by traverse_tree() for every entry it visits.
+*
+*   ---------------------------------------- ARGUMENTS ----------------------------------------
+*
+*   current_file    The current file being processed.
+*
+*   current_dir     The directory current_file is in.
+*
+*   context         The loaded policy table.
 *
 **********************************************************************************************/
 {
-    bool should_print = (!non_matches_flag && naming_match_regex(regex, current_file->d_name)) ||
-                        (non_matches_flag && !naming_match_regex(regex, current_file->d_name));
+    const char *policy_name = check_policy_file(context, current_dir->abs_path, current_file->name,
+                                                current_file->type);
+    if (policy_name != NULL) {
+        display_entry(current_file, current_dir, policy_name);
+    }
+}
 
-    if (should_print)
+// The classifier stage of --pipeline, for a convention.
+static void classify_batch (struct PipelineBatch *batch, void *context)
+{
+    for (size_t i = 0; i < batch->n_entries; i++)
     {
-        if (full_path_flag)
-            {
-                printf("%s/%s\n", abs_search_path, current_file->d_name);
-            }
-        else
+        struct PipelineEntry *entry = &batch->entries[i];
+        entry->print = check_current_file(context, entry->abs_dir_path, entry->name, entry->type);
+    }
+}
+
+// The classifier stage of --pipeline, for a policy file.
+static void classify_policy_batch (struct PipelineBatch *batch, void *context)
+{
+    for (size_t i = 0; i < batch->n_entries; i++)
+    {
+        struct PipelineEntry *entry = &batch->entries[i];
+        entry->tag = check_policy_file(context, entry->abs_dir_path, entry->name, entry->type);
+        entry->print = (entry->tag != NULL);
+    }
+}
+
+// The writer stage of --pipeline.
+static void write_batch (const struct PipelineBatch *batch, void *context)
+{
+    (void)context;
+    for (size_t i = 0; i < batch->n_entries; i++)
+    {
+        const struct PipelineEntry *entry = &batch->entries[i];
+        if (entry->print) {
+            print_entry(entry->abs_dir_path, entry->name, entry->tag, NULL);
+        }
+    }
+}
+
+static FILE *create_partial (const char *convention)
+/**********************************************************************************************
+*
+*   Starts the --partial file of this shard, for the merge subcommand. convention is NULL for
+*   a policy search.
+*
+*   ----------------------------------------- RETURNS -----------------------------------------
+*
+*   The file to print the output to, or NULL after printing an error.
+*
+**********************************************************************************************/
+{
+    FILE *file = partial_create(partial_path, "search", shard_index, shard_count, shard_depth);
+    if (file == NULL) {
+        return NULL;
+    }
+    fprintf(file, "location %s\n", abs_initial_search_path);
+    if (convention != NULL) {
+        fprintf(file, "convention %s\n", convention);
+    }
+    else {
+        fprintf(file, "policy-file %s\n", policy_path);
+    }
+    fprintf(file, "mode %s\n", (strict_flag) ? "strict" : "lenient");
+    fprintf(file, "unicode %s\n", (unicode_flag) ? "yes" : "no");
+    char filter_description[128];
+    traverse_describe_filters(&filters, filter_description, sizeof(filter_description));
+    fprintf(file, "filters %s\n", filter_description);
+    fprintf(file, "list %s\n", (non_matches_flag) ? "non-matches" : "matches");
+    fprintf(file, "full-path %s\n", (full_path_flag) ? "yes" : "no");
+    if (changed_since_flag) {
+        fprintf(file, "changed-since %lld\n", (long long)changed_since.tv_sec);
+    }
+    if (check_components_flag) {
+        fprintf(file, "check-components yes\n");
+    }
+    if (sort_flag) {
+        fprintf(file, "sorted yes\n");
+    }
+    fprintf(file, "output\n");
+    return file;
+}
+
+static void describe_scan (const char *convention)
+{
+    char filter_description[128];
+    traverse_describe_filters(&filters, filter_description, sizeof(filter_description));
+    snprintf(scan_description, sizeof(scan_description), 
+             "search %s=%s strict=%d unicode=%d recursive=%d non-matches=%d full-path=%d "
+             "changed-since=%lld shard=%d/%d shard-depth=%d %s location=%s",
+             (convention != NULL) ? "convention" : "policy", 
+             (convention != NULL) ? convention : policy_path,
+             strict_flag, unicode_flag, recursive_flag, non_matches_flag, full_path_flag,
+             (changed_since_flag) ? (long long)changed_since.tv_sec : -1LL,
+             shard_index + 1, shard_count, shard_depth, filter_description, abs_initial_search_path);
+}
+
+// Writes the state of the search to a checkpoint. Called by checkpoint_frontier().
+static void write_checkpoint (FILE *file)
+{
+    fprintf(file, "scan %s\n", scan_description);
+    checkpoint_save_counters(file, checkpoint_table, matches, non_matches, non_policy_entries);
+    checkpoint_save_output(file, output);
+}
+
+static bool write_metrics (const char *location, const char *convention, const void *context)
+{
+    // Adds the results of the search to the metrics, then writes them to --metrics-file.
+    if (convention != NULL) {
+        metrics_add_result(convention, NULL, matches, non_matches);
+    }
+    else {
+        const struct PolicyTable *table = context;
+        for (int i = 0; i < table->n_policies; i++)
         {
-        // If relative_path is empty (current directory), insert a forward-slash between
-        // relative_path and current_file->d_name.
-        const char *relative_path = get_relative_path(abs_initial_search_path, abs_search_path);
-        printf("%s%s%s\n",
-               relative_path,
-               (strlen(relative_path) > 0) ? "/" : "",
-               current_file->d_name);
+            const struct Policy *policy = &table->policies[i];
+            metrics_add_result(policy->convention, policy->name, policy->matches, 
+                               policy->non_matches);
         }
     }
+    return metrics_write(metrics_path, command_name, location);
 }
 
-static void search_directory (const char *search_path, regex_t regex)
+static void print_summary (const char *convention, const void *context)
+{
+    // Follows the listing of a scan with the report an analyze of the same tree would print.
+    printf("\n");
+    if (convention != NULL) {
+        analyze_print_report(convention, strict_flag, abs_initial_search_path, changed_since_flag,
+                             matches - symlink_matches, non_matches - symlink_non_matches);
+    }
+    else {
+        const struct PolicyTable *table = context;
+        analyze_print_policy_report(table->policies, table->n_policies, non_policy_entries, 
+                                    policy_path, abs_initial_search_path, changed_since_flag);
+    }
+}
+
+static bool search_directory (const char *search_path, const char *convention,
+                              void (*visit)(const struct TraverseEntry *, const struct TraverseDir *, void *),
+                              void *context)
 /**********************************************************************************************
 *
 *   Searches a directory for filenames that match a regular expression.
@@ -105,57 +673,153 @@ static void search_directory (const char *search_path, regex_t regex)
 *
 *   search_path     The directory where the search will take place.
 *
-*   regex           The compiled regex of the convention being searched for.
+*   convention      The convention being searched for, or NULL for a policy search.
+*
+*   visit           The function processing every entry.
+*
+*   context         The rule of the convention, or policy table, being searched for.
+*
+*   ----------------------------------------- RETURNS -----------------------------------------
+*
+*   false if the --baseline or --resume could not be loaded or the --write-baseline or
+*   --partial written, otherwise true.
 *
 **********************************************************************************************/
 {
-    const char *abs_search_path = canonicalize_file_name(search_path);
-    
-    // If this is the first time search_directory has been called, save the absolute initial search path.
+    if (baseline_path != NULL && !baseline_load(&baseline, baseline_path)) {
+        return false;
+    }
+    abs_initial_search_path = (locate_db_path != NULL) ? locate_root(search_path)
+                                                       : canonicalize_file_name(search_path);
     if (abs_initial_search_path == NULL) {
-        abs_initial_search_path = abs_search_path;
+        return false;
     }
+    describe_scan(convention);
+    checkpoint_table = (convention == NULL) ? context : NULL;
 
-    // dir_path is known to exist at this point, but opendir() can still fail from permissions.
-    DIR *current_dir = opendir(abs_search_path);
-    if (current_dir == NULL) {
-        printf("Error: cannot access %s due to Error %d (%s).\n", abs_search_path, errno, 
-                strerror(errno));
-        return;
-    }
-   
-    // Begin reading directories/files inside current_dir.
-    struct dirent *current_file;
-    while ((current_file = readdir(current_dir)) != NULL)
-    {
-        // Skip current and parent entries.
-        if (strcmp(current_file->d_name, ".") == 0 || strcmp(current_file->d_name, "..") == 0) {
-            continue;
+    // A resumed search carries on with the counters and output it had at its checkpoint.
+    struct Checkpoint checkpoint = {0};
+    output = stdout;
+    if (resume_path != NULL) {
+        if (!checkpoint_read(&checkpoint, resume_path) ||
+            !checkpoint_expect(&checkpoint, "scan", scan_description) ||
+            !checkpoint_restore_counters(&checkpoint, (convention == NULL) ? context : NULL,
+                                         &matches, &non_matches, &non_policy_entries) ||
+            (partial_path != NULL && (output = partial_reopen(partial_path)) == NULL) ||
+            !checkpoint_restore_output(&checkpoint, output)) {
+            return false;
         }
+    }
+    else if (partial_path != NULL && (output = create_partial(convention)) == NULL) {
+        return false;
+    }
+    if (checkpoint_path != NULL && !checkpoint_save_output(NULL, output)) {
+        return false;
+    }
+    // The options are fixed by now, so a plain convention search settles on its kernel once.
+    if (check_components_flag) {
+        visit = process_component_file;
+    }
+    else if (visit == process_current_file && !sort_flag && !show_owner_flag && !summary_flag) {
+        visit = search_kernels[non_matches_flag][full_path_flag];
+    }
 
-        // If the current file is a directory...
-        if (current_file->d_type == DT_DIR) {
-
-            // Process it.
-            process_current_file(current_file, abs_search_path, abs_initial_search_path, regex);
-
-            // Then if recursive_flag is true, concatenate abs_search_path with current_file->d_name
-            // and call search_directory at that location.
-            if (recursive_flag == true) {
-                char abs_new_search_path[PATH_MAX];
-                snprintf(abs_new_search_path, sizeof(abs_new_search_path), "%s/%s", abs_search_path, 
-                         current_file->d_name);
-                search_directory(abs_new_search_path, regex);
-            }
+    struct Traversal traversal = {
+        .recursive = recursive_flag,
+        .include_symlinks = true,
+        .changed_since_flag = changed_since_flag,
+        .changed_since = changed_since,
+        .filters = filters,
+        .inode_order = inode_order_flag,
+        .visit = visit,
+        .mark_subdir = (check_components_flag) ? mark_component : NULL,
+        .finish_dir = (show_owner_flag) ? finish_current_dir : NULL,
+        .context = context,
+        .shard_index = shard_index,
+        .shard_count = shard_count,
+        .shard_depth = shard_depth,
+        .frontier = (checkpoint_path != NULL) ? checkpoint_frontier : NULL,
+        .resume = (resume_path != NULL) ? checkpoint.pending : NULL,
+        .n_resume = checkpoint.n_pending,
+    };
+    // With --pipeline, visiting an entry only copies it out for the classifier and writer.
+    struct Pipeline pipeline;
+    if (pipeline_flag) {
+        if (!pipeline_start(&pipeline, (convention != NULL) ? classify_batch : classify_policy_batch, 
+                            write_batch, context)) {
+            return false;
         }
-        // Else if the current file is a regular file or a symlink...
-        else if ((current_file->d_type == DT_REG) || (current_file->d_type == DT_LNK)) { 
+        traversal.visit = pipeline_visit;
+        traversal.context = &pipeline;
+    }
+    if (sort_flag) {
+        extsort_start(&sorted_output, sort_budget);
+    }
+    if (progress_interval > 0.0) {
+        progress_start(abs_initial_search_path, progress_interval);
+    }
+    if (checkpoint_path != NULL) {
+        checkpoint_start(checkpoint_path, checkpoint_interval, write_checkpoint);
+    }
+    if (metrics_path != NULL) {
+        metrics_start();
+    }
+    bool scanned = true;
+    if (locate_db_path != NULL) {
+        scanned = locate_scan(locate_db_path, &traversal, abs_initial_search_path);
+    }
+    else {
+        traverse_tree(&traversal, abs_initial_search_path);
+    }
+    if (pipeline_flag) {
+        pipeline_finish(&pipeline);
+    }
+    progress_stop();
+    if (!scanned) {
+        return false;
+    }
+    if (sort_flag && !extsort_finish(&sorted_output, output)) {
+        return false;
+    }
+    checkpoint_finish(true);
+    if (metrics_path != NULL && !write_metrics(abs_initial_search_path, convention, context)) {
+        return false;
+    }
 
-            // Process it.
-            process_current_file(current_file, abs_search_path, abs_initial_search_path, regex);
-        }
+    if (baseline_path != NULL) {
+        baseline_unload(&baseline);
     }
-    closedir(current_dir);
+    if (partial_path != NULL && !partial_commit(output, partial_path)) {
+        return false;
+    }
+    if (summary_flag) {
+        print_summary(convention, context);
+    }
+    return write_baseline_path == NULL || baseline_write(&baseline_writer, write_baseline_path);
+}
+
+int subc_exec_scan (int argc, char *argv[])
+/**********************************************************************************************
+*
+*   The external function called from src/main.c for the scan subcommand: a search that also
+*   totals the matches and non-matches it finds, and reports them as an analyze would, so
+*   both come from one traversal of the tree.
+*
+*   ---------------------------------------- ARGUMENTS ----------------------------------------
+*
+*   argc    The argc of main() in src/main.c with 1 removed.
+*
+*   argv    The argv of main() in src/main.c with "nc-scout" removed from the beginning.
+*
+*   ----------------------------------------- RETURNS -----------------------------------------
+*
+*   It inherrits the return of main() in src/main.c, returning EXIT_FAILURE or EXIT_SUCCESS.
+*
+**********************************************************************************************/
+{
+    summary_flag = true;
+    command_name = "scan";
+    return subc_exec_search(argc, argv);
 }
 
 int subc_exec_search (int argc, char *argv[])
@@ -186,11 +850,38 @@ int subc_exec_search (int argc, char *argv[])
             {"non-matches", no_argument, 0, 'n'},
             {"strict", no_argument, 0, 's'},
             {"recursive", no_argument, 0, 'R'},
+            {"unicode", no_argument, 0, 'u'},
+            {"policy", required_argument, 0, OPT_POLICY},
+            {"progress", optional_argument, 0, OPT_PROGRESS},
+            {"max-iops", required_argument, 0, OPT_MAX_IOPS},
+            {"max-dirs-per-sec", required_argument, 0, OPT_MAX_DIRS_PER_SEC},
+            {"adaptive", no_argument, 0, OPT_ADAPTIVE},
+            {"changed-since", required_argument, 0, OPT_CHANGED_SINCE},
+            {"baseline", required_argument, 0, OPT_BASELINE},
+            {"write-baseline", required_argument, 0, OPT_WRITE_BASELINE},
+            {"shard", required_argument, 0, OPT_SHARD},
+            {"shard-depth", required_argument, 0, OPT_SHARD_DEPTH},
+            {"partial", required_argument, 0, OPT_PARTIAL},
+            {"checkpoint", required_argument, 0, OPT_CHECKPOINT},
+            {"checkpoint-interval", required_argument, 0, OPT_CHECKPOINT_INTERVAL},
+            {"resume", required_argument, 0, OPT_RESUME},
+            {"type", required_argument, 0, OPT_TYPE},
+            {"max-depth", required_argument, 0, OPT_MAX_DEPTH},
+            {"min-size", required_argument, 0, OPT_MIN_SIZE},
+            {"owner", required_argument, 0, OPT_OWNER},
+            {"metrics-file", required_argument, 0, OPT_METRICS_FILE},
+            {"inode-order", no_argument, 0, OPT_INODE_ORDER},
+            {"locate-db", required_argument, 0, OPT_LOCATE_DB},
+            {"pipeline", no_argument, 0, OPT_PIPELINE},
+            {"check-components", no_argument, 0, OPT_CHECK_COMPONENTS},
+            {"sort", no_argument, 0, OPT_SORT},
+            {"sort-memory", required_argument, 0, OPT_SORT_MEMORY},
+            {"show-owner", no_argument, 0, OPT_SHOW_OWNER},
             {0, 0, 0, 0}
         };
         
         int option_index = 0;
-        current_opt = getopt_long (argc, argv, "+hfnsR", long_options_search, &option_index);
+        current_opt = getopt_long (argc, argv, "+hfnsRu", long_options_search, &option_index);
         // Break if at the end of the options.
         if (current_opt == -1) {
             break;
@@ -203,12 +894,18 @@ int subc_exec_search (int argc, char *argv[])
 
             case 'h':
                 // Make sure that there are no arguments supplied.
-                if (argc == 2) {
-                    printf("%s", HELP_SEARCH);
+                if (argc == 2 && summary_flag) {
+                    printf("%s%s%s", HELP_SCAN, HELP_CONVENTION_LOCATION, HELP_STRICT_LENIENT);
+                    return EXIT_SUCCESS;
+                }
+                else if (argc == 2) {
+                    printf("%s%s%s%s%s", HELP_SEARCH, HELP_SEARCH_LARGE_TREES, HELP_CONVENTION_LOCATION, 
+                           HELP_SEARCH_LOCATION_NOTE, HELP_STRICT_LENIENT);
                     return EXIT_SUCCESS;
                 }
                 else {
-                    printf("Incorrect usage.\nDo `nc-scout search --help` for more information about usage.\n");
+                    printf("Incorrect usage.\nDo `nc-scout %s --help` for more information about usage.\n",
+                           command_name);
                     return EXIT_FAILURE;
                 }
 
@@ -228,32 +925,240 @@ int subc_exec_search (int argc, char *argv[])
                 recursive_flag = true;
                 break;
 
+            case 'u':
+                unicode_flag = true;
+                break;
+
+            case OPT_CHANGED_SINCE:
+                if (!validate_timestamp(optarg, &changed_since)) {
+                    return EXIT_FAILURE;
+                }
+                changed_since_flag = true;
+                break;
+
+            case OPT_POLICY:
+                policy_path = optarg;
+                break;
+
+            case OPT_BASELINE:
+                baseline_path = optarg;
+                break;
+
+            case OPT_WRITE_BASELINE:
+                write_baseline_path = optarg;
+                break;
+
+            case OPT_SHARD:
+                if (!validate_shard(optarg, &shard_index, &shard_count)) {
+                    return EXIT_FAILURE;
+                }
+                break;
+
+            case OPT_SHARD_DEPTH:
+                if (!validate_depth(optarg, &shard_depth)) {
+                    return EXIT_FAILURE;
+                }
+                break;
+
+            case OPT_PARTIAL:
+                partial_path = optarg;
+                break;
+
+            case OPT_CHECKPOINT:
+                checkpoint_path = optarg;
+                break;
+
+            case OPT_CHECKPOINT_INTERVAL:
+            {
+                char *end;
+                checkpoint_interval = strtod(optarg, &end);
+                if (*optarg == '\0' || *end != '\0' || !(checkpoint_interval > 0.0)) {
+                    printf("Error: '%s' is not a valid number of seconds.\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            }
+
+            case OPT_RESUME:
+                resume_path = optarg;
+                break;
+
+            case OPT_TYPE:
+                if (!validate_types(optarg, &filters.types)) {
+                    return EXIT_FAILURE;
+                }
+                break;
+
+            case OPT_MAX_DEPTH:
+                if (!validate_depth(optarg, &filters.max_depth)) {
+                    return EXIT_FAILURE;
+                }
+                break;
+
+            case OPT_MIN_SIZE:
+                if (!validate_size(optarg, &filters.min_size)) {
+                    return EXIT_FAILURE;
+                }
+                filters.min_size_flag = true;
+                break;
+
+            case OPT_OWNER:
+                if (!validate_owner(optarg, &filters.owner)) {
+                    return EXIT_FAILURE;
+                }
+                filters.owner_flag = true;
+                break;
+
+            case OPT_METRICS_FILE:
+                metrics_path = optarg;
+                break;
+
+            case OPT_INODE_ORDER:
+                inode_order_flag = true;
+                break;
+
+            case OPT_LOCATE_DB:
+                locate_db_path = optarg;
+                break;
+
+            case OPT_PIPELINE:
+                pipeline_flag = true;
+                break;
+
+            case OPT_CHECK_COMPONENTS:
+                check_components_flag = true;
+                break;
+
+            case OPT_SORT:
+                sort_flag = true;
+                break;
+
+            case OPT_SORT_MEMORY:
+                if (!validate_size(optarg, &sort_budget)) {
+                    return EXIT_FAILURE;
+                }
+                break;
+
+            case OPT_SHOW_OWNER:
+                show_owner_flag = true;
+                break;
+
+            case OPT_PROGRESS:
+            {
+                char *end = NULL;
+                progress_interval = (optarg == NULL) ? PROGRESS_DEFAULT_INTERVAL : strtod(optarg, &end);
+                if (optarg != NULL && (*optarg == '\0' || *end != '\0' || !(progress_interval > 0.0))) {
+                    printf("Error: '%s' is not a valid number of seconds.\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            }
+
+            case OPT_MAX_IOPS:
+                if (!validate_rate(optarg, &max_iops)) {
+                    return EXIT_FAILURE;
+                }
+                break;
+
+            case OPT_MAX_DIRS_PER_SEC:
+                if (!validate_rate(optarg, &max_dirs_per_sec)) {
+                    return EXIT_FAILURE;
+                }
+                break;
+
+            case OPT_ADAPTIVE:
+                adaptive_flag = true;
+                break;
+
             default:
                 abort();
         }
     }
+    throttle_configure(max_iops, max_dirs_per_sec, adaptive_flag);
+
+    if (write_baseline_path != NULL && (checkpoint_path != NULL || resume_path != NULL)) {
+        printf("Error: `--write-baseline` cannot be combined with `--checkpoint` or `--resume`.\n");
+        return EXIT_FAILURE;
+    }
+    // A locate database records neither change times, sizes nor owners, and is read in one pass.
+    if (locate_db_path != NULL &&
+        (changed_since_flag || filters.min_size_flag || filters.owner_flag || shard_count > 1 ||
+         checkpoint_path != NULL || resume_path != NULL)) {
+        printf("Error: `--locate-db` cannot be combined with `--changed-since`, `--min-size`, `--owner`, "
+               "`--shard`, `--checkpoint` or `--resume`.\n");
+        return EXIT_FAILURE;
+    }
 
+    // The output of a pipelined search lags behind the traversal, so a checkpoint could not
+    // record how much of it belongs to the directories already read.
+    if (pipeline_flag && (checkpoint_path != NULL || resume_path != NULL)) {
+        printf("Error: `--pipeline` cannot be combined with `--checkpoint` or `--resume`.\n");
+        return EXIT_FAILURE;
+    }
+
+    // The verdicts of directories are kept on the traversal stack, which a locate database,
+    // a pipeline and a checkpoint do not carry them through.
+    if (check_components_flag && (policy_path != NULL || locate_db_path != NULL || pipeline_flag ||
+                                  checkpoint_path != NULL || resume_path != NULL)) {
+        printf("Error: `--check-components` cannot be combined with `--policy`, `--locate-db`, "
+               "`--pipeline`, `--checkpoint` or `--resume`.\n");
+        return EXIT_FAILURE;
+    }
+
+    // Owners are read from the open directory, which neither a locate database nor the
+    // writer thread of a pipeline has.
+    if (show_owner_flag && (locate_db_path != NULL || pipeline_flag)) {
+        printf("Error: `--show-owner` cannot be combined with `--locate-db` or `--pipeline`.\n");
+        return EXIT_FAILURE;
+    }
+
+    // Sorted output is only written once the traversal is done.
+    if (sort_flag && (checkpoint_path != NULL || resume_path != NULL)) {
+        printf("Error: `--sort` cannot be combined with `--checkpoint` or `--resume`.\n");
+        return EXIT_FAILURE;
+    }
+
+    // The totals of a scan are printed once the whole tree has been read, by this process.
+    if (summary_flag && (partial_path != NULL || checkpoint_path != NULL || resume_path != NULL)) {
+        printf("Error: `scan` cannot be used with `--partial`, `--checkpoint` or `--resume`.\n");
+        return EXIT_FAILURE;
+    }
+
+    // A policy file takes the place of the convention.
     int non_option_argc = argc - optind;
-    if (non_option_argc < N_REQUIRED_ARGS) {
-        printf("Insufficient arguments.\nDo `nc-scout search --help` for more information about usage.\n");
+    if (non_option_argc < N_REQUIRED_ARGS - (policy_path != NULL)) {
+        printf("Insufficient arguments.\nDo `nc-scout %s --help` for more information about usage.\n",
+               command_name);
+        return EXIT_FAILURE;
+    }
+
+    if (policy_path != NULL) {
+        const char *arg_target_dirname = argv[optind];
+        struct PolicyTable policy_table;
+        if ((policy_load(&policy_table, policy_path, strict_flag, unicode_flag)) &&
+            (locate_db_path != NULL ||
+             (validate_file_exists(arg_target_dirname) && validate_file_is_dir(arg_target_dirname))))
+        {
+            if (search_directory(arg_target_dirname, NULL, process_policy_file, &policy_table)) {
+                return EXIT_SUCCESS;
+            }
+        }
         return EXIT_FAILURE;
     }
 
     const char *arg_naming_convention = argv[optind];
     const char *arg_target_dirname = argv[optind + 1]; 
 
-    // Set to Conventions[i].regex if arg_naming_convention is valid, otherwise it remains NULL.
-    const char *search_expression;
-    // Set by naming_compile_regex() after search_expression is known to be set.
-    regex_t search_regex;
+    // Set by naming_compile_rule() if arg_naming_convention is valid.
+    struct NamingRule search_rule;
 
-    if ((naming_set_expression(arg_naming_convention, &search_expression, strict_flag)) &&
-        (validate_file_exists(arg_target_dirname)) && 
-        (validate_file_is_dir(arg_target_dirname)) && 
-        (naming_compile_regex(&search_regex, search_expression)))
+    if ((naming_compile_rule(&search_rule, arg_naming_convention, strict_flag, unicode_flag)) &&
+        (locate_db_path != NULL ||
+         (validate_file_exists(arg_target_dirname) && validate_file_is_dir(arg_target_dirname))))
     {     
-        search_directory(arg_target_dirname, search_regex); 
-        return EXIT_SUCCESS;
+        if (search_directory(arg_target_dirname, arg_naming_convention, process_current_file, &search_rule)) {
+            return EXIT_SUCCESS;
+        }
     }
     return EXIT_FAILURE;
 }
@@ -0,0 +1,311 @@
+/**********************************************************************************************
+*
+*   stats - Detailed statistics of an analyze (--stats-detail), collected in fixed memory.
+*
+*   LICENSE: zlib/libpng 
+*
+*   Copyright (c) 2024-2025 Josh Hayden (@BlinkDynamo)
+*
+*   This software is provided ‘as-is’, without any express or implied
+*   warranty. In no event will the authors be held liable for any damages
+*   arising from the use of this software.
+*
+*   Permission is granted to anyone to use this software for any purpose,
+*   including commercial applications, and to alter it and redistribute it
+*   freely, subject to the following restrictions:
+*
+*   1. The origin of this software must not be misrepresented; you must not
+*   claim that you wrote the original software. If you use this software
+*   in a product, an acknowledgment in the product documentation would be
+*   appreciated but is not required.
+*
+*   2. Altered source versions must be plainly marked as such, and must not be
+*   misrepresented as being the original software.
+*
+*   3. This notice may not be removed or altered from any source
+*   distribution. 
+*
+*
+*   Every statistic is bounded no matter how large the tree is: name lengths and depths are
+*   counted in fixed histograms, extensions are interned into a fixed table (with the ones that
+*   do not fit counted together), and the directories with the most non-matches are kept in a
+*   min-heap of at most K entries.
+*
+*********************************************************************************************/
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif // _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <ctype.h>
+#include <linux/limits.h>
+
+#include "common.h"
+#include "progress.h"
+#include "stats.h"
+
+// Depths past the last bucket are counted in it.
+#define MAX_DEPTH_BUCKETS       32
+
+// Extensions are lowercased and interned into a table of EXTENSION_SLOTS slots, at most half
+// of which are used. Extensions that are too long or do not fit are counted as "(other)".
+#define EXTENSION_SLOTS         512
+#define MAX_EXTENSIONS          (EXTENSION_SLOTS / 2)
+#define MAX_EXTENSION_LEN       15
+
+struct ExtensionCount {
+    char extension[MAX_EXTENSION_LEN + 1];
+    bool used;
+    unsigned long matches;
+    unsigned long non_matches;
+};
+
+struct DirCount {
+    unsigned long non_matches;
+    char *relative_path;
+};
+
+// Name lengths, in bytes, and depths of every entry analyzed.
+static unsigned long name_lengths[NAME_MAX + 1];
+static unsigned long depths[MAX_DEPTH_BUCKETS + 1];
+static unsigned long total_entries = 0;
+
+static struct ExtensionCount extensions[EXTENSION_SLOTS];
+static int n_extensions = 0;
+static struct ExtensionCount no_extension = {"(none)", true, 0, 0};
+static struct ExtensionCount other_extension = {"(other)", true, 0, 0};
+
+// Min-heap of the directories with the most non-matches, ordered by non_matches.
+static struct DirCount *top_dirs = NULL;
+static int n_top_dirs = 0;
+static int max_top_dirs = 0;
+static unsigned long current_dir_non_matches = 0;
+
+void stats_start (int top_dirs_wanted)
+{
+    max_top_dirs = top_dirs_wanted;
+    top_dirs = xcalloc(max_top_dirs, sizeof(struct DirCount));
+}
+
+static struct ExtensionCount *intern_extension (const char *name)
+{
+    // Like the conventions, a leading period does not start an extension.
+    const char *period = strrchr(name + 1, '.');
+    if (name[0] == '\0' || period == NULL) {
+        return &no_extension;
+    }
+
+    char extension[MAX_EXTENSION_LEN + 1];
+    size_t len = strlen(period + 1);
+    if (len == 0 || len > MAX_EXTENSION_LEN) {
+        return &other_extension;
+    }
+    for (size_t i = 0; i <= len; i++)
+    {
+        extension[i] = tolower((unsigned char)period[1 + i]);
+    }
+
+    uint32_t i = hash_string(extension) & (EXTENSION_SLOTS - 1);
+    while (extensions[i].used && strcmp(extensions[i].extension, extension) != 0)
+    {
+        i = (i + 1) & (EXTENSION_SLOTS - 1);
+    }
+    if (!extensions[i].used) {
+        if (n_extensions == MAX_EXTENSIONS) {
+            return &other_extension;
+        }
+        memcpy(extensions[i].extension, extension, len + 1);
+        extensions[i].used = true;
+        n_extensions++;
+    }
+    return &extensions[i];
+}
+
+void stats_record (const char *name, int depth, bool is_match)
+/**********************************************************************************************
+*
+*   Counts one analyzed entry in every statistic.
+*
+*   ---------------------------------------- ARGUMENTS ----------------------------------------
+*
+*   name        The d_name of the entry.
+*
+*   depth       The depth of the entry, 1 for entries of the analyzed directory.
+*
+*   is_match    Whether the entry matches its convention.
+*
+**********************************************************************************************/
+{
+    size_t len = strlen(name);
+    name_lengths[(len > NAME_MAX) ? NAME_MAX : len]++;
+    depths[(depth > MAX_DEPTH_BUCKETS) ? MAX_DEPTH_BUCKETS : depth]++;
+    total_entries++;
+
+    struct ExtensionCount *count = intern_extension(name);
+    if (is_match) {
+        count->matches++;
+    }
+    else {
+        count->non_matches++;
+        current_dir_non_matches++;
+    }
+}
+
+static void sift_down (int i)
+{
+    while (true)
+    {
+        int smallest = i;
+        int left = 2 * i + 1;
+        int right = 2 * i + 2;
+        if (left < n_top_dirs && top_dirs[left].non_matches < top_dirs[smallest].non_matches) {
+            smallest = left;
+        }
+        if (right < n_top_dirs && top_dirs[right].non_matches < top_dirs[smallest].non_matches) {
+            smallest = right;
+        }
+        if (smallest == i) {
+            return;
+        }
+        struct DirCount swap = top_dirs[i];
+        top_dirs[i] = top_dirs[smallest];
+        top_dirs[smallest] = swap;
+        i = smallest;
+    }
+}
+
+static void sift_up (int i)
+{
+    while (i > 0 && top_dirs[(i - 1) / 2].non_matches > top_dirs[i].non_matches)
+    {
+        struct DirCount swap = top_dirs[i];
+        top_dirs[i] = top_dirs[(i - 1) / 2];
+        top_dirs[(i - 1) / 2] = swap;
+        i = (i - 1) / 2;
+    }
+}
+
+void stats_finish_dir (const char *relative_path)
+/**********************************************************************************************
+*
+*   Ends the directory whose entries were just recorded, keeping it if it has more non-matches
+*   than the least of the directories kept so far.
+*
+**********************************************************************************************/
+{
+    unsigned long non_matches = current_dir_non_matches;
+    current_dir_non_matches = 0;
+    if (non_matches == 0) {
+        return;
+    }
+
+    if (n_top_dirs < max_top_dirs) {
+        top_dirs[n_top_dirs] = (struct DirCount){non_matches, strdup(relative_path)};
+        sift_up(n_top_dirs++);
+    }
+    else if (non_matches > top_dirs[0].non_matches) {
+        free(top_dirs[0].relative_path);
+        top_dirs[0] = (struct DirCount){non_matches, strdup(relative_path)};
+        sift_down(0);
+    }
+}
+
+static int compare_extensions (const void *a, const void *b)
+{
+    const struct ExtensionCount *count_a = a;
+    const struct ExtensionCount *count_b = b;
+    unsigned long total_a = count_a->matches + count_a->non_matches;
+    unsigned long total_b = count_b->matches + count_b->non_matches;
+    if (total_a != total_b) {
+        return (total_a < total_b) ? 1 : -1;
+    }
+    return strcmp(count_a->extension, count_b->extension);
+}
+
+static int compare_dirs (const void *a, const void *b)
+{
+    const struct DirCount *dir_a = a;
+    const struct DirCount *dir_b = b;
+    if (dir_a->non_matches != dir_b->non_matches) {
+        return (dir_a->non_matches < dir_b->non_matches) ? 1 : -1;
+    }
+    return strcmp(dir_a->relative_path, dir_b->relative_path);
+}
+
+void stats_print (void)
+/**********************************************************************************************
+*
+*   Prints every statistic: name lengths in power of two ranges, depths, extensions by number
+*   of entries, the directories with the most non-matches, and the hits and misses of the
+*   verdict cache.
+*
+**********************************************************************************************/
+{
+    printf("\n%-24s %12s %12s\n", "name length (bytes)", "entries", "percentage");
+    for (size_t low = 1; low <= NAME_MAX; low *= 2)
+    {
+        size_t high = (low * 2 - 1 > NAME_MAX) ? NAME_MAX : low * 2 - 1;
+        unsigned long count = 0;
+        for (size_t len = low; len <= high; len++)
+        {
+            count += name_lengths[len];
+        }
+        char range[32];
+        snprintf(range, sizeof(range), "%zu-%zu", low, high);
+        printf("%-24s %12lu %11.3f%%\n", (low == high) ? "1" : range, count,
+               percentage(count, total_entries));
+    }
+
+    printf("\n%-24s %12s %12s\n", "depth", "entries", "percentage");
+    for (int depth = 1; depth <= MAX_DEPTH_BUCKETS; depth++)
+    {
+        if (depths[depth] == 0) {
+            continue;
+        }
+        char label[32];
+        snprintf(label, sizeof(label), "%d%s", depth, (depth == MAX_DEPTH_BUCKETS) ? "+" : "");
+        printf("%-24s %12lu %11.3f%%\n", label, depths[depth], 
+               percentage(depths[depth], total_entries));
+    }
+
+    struct ExtensionCount sorted[MAX_EXTENSIONS + 2];
+    int n_sorted = 0;
+    for (int i = 0; i < EXTENSION_SLOTS; i++)
+    {
+        if (extensions[i].used) {
+            sorted[n_sorted++] = extensions[i];
+        }
+    }
+    qsort(sorted, n_sorted, sizeof(struct ExtensionCount), compare_extensions);
+    sorted[n_sorted++] = no_extension;
+    sorted[n_sorted++] = other_extension;
+
+    printf("\n%-24s %12s %12s %12s\n", "extension", "matches", "non-matches", "percentage");
+    for (int i = 0; i < n_sorted; i++)
+    {
+        unsigned long total = sorted[i].matches + sorted[i].non_matches;
+        if (total == 0) {
+            continue;
+        }
+        printf("%-24s %12lu %12lu %11.3f%%\n", sorted[i].extension, sorted[i].matches,
+               sorted[i].non_matches, percentage(sorted[i].matches, total));
+    }
+
+    qsort(top_dirs, n_top_dirs, sizeof(struct DirCount), compare_dirs);
+    printf("\n%12s  %s\n", "non-matches", "directory");
+    for (int i = 0; i < n_top_dirs; i++)
+    {
+        printf("%12lu  %s\n", top_dirs[i].non_matches,
+               (top_dirs[i].relative_path[0] != '\0') ? top_dirs[i].relative_path : ".");
+    }
+
+    unsigned long hits = progress_counters.verdict_hits;
+    unsigned long misses = progress_counters.verdict_misses;
+    printf("\n%-24s %12s %12s\n", "verdict cache", "names", "percentage");
+    printf("%-24s %12lu %11.3f%%\n", "hits", hits, percentage(hits, hits + misses));
+    printf("%-24s %12lu %11.3f%%\n", "misses", misses, percentage(misses, hits + misses));
+}
@@ -0,0 +1,235 @@
+/**********************************************************************************************
+*
+*   throttle - Rate limits and adaptive pacing of the filesystem operations of a traversal.
+*
+*   LICENSE: zlib/libpng 
+*
+*   Copyright (c) 2024-2025 Josh Hayden (@BlinkDynamo)
+*
+*   This software is provided ‘as-is’, without any express or implied
+*   warranty. In no event will the authors be held liable for any damages
+*   arising from the use of this software.
+*
+*   Permission is granted to anyone to use this software for any purpose,
+*   including commercial applications, and to alter it and redistribute it
+*   freely, subject to the following restrictions:
+*
+*   1. The origin of this software must not be misrepresented; you must not
+*   claim that you wrote the original software. If you use this software
+*   in a product, an acknowledgment in the product documentation would be
+*   appreciated but is not required.
+*
+*   2. Altered source versions must be plainly marked as such, and must not be
+*   misrepresented as being the original software.
+*
+*   3. This notice may not be removed or altered from any source
+*   distribution. 
+*
+*********************************************************************************************/
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif // _GNU_SOURCE
+
+#include <time.h>
+#include <errno.h>
+
+#include "throttle.h"
+
+// Adaptive pacing looks at the mean latency of operations over windows of at least this long,
+// and this many operations.
+#define WINDOW_SECONDS      0.1
+#define WINDOW_MIN_OPS      8
+
+// A window whose mean latency is above SPIKE_RATIO times the baseline halves the rate, and
+// one below CALM_RATIO times the baseline raises it by a tenth.
+#define SPIKE_RATIO         2.0
+#define CALM_RATIO          1.25
+#define BACKOFF_FACTOR      0.5
+#define RAMP_UP_FACTOR      1.1
+#define MIN_ADAPTIVE_IOPS   10.0
+
+// The baseline latency is the lowest window mean seen, rising by this factor per window so
+// that a filesystem that got slower for good is not treated as stalled forever.
+#define BASELINE_DRIFT      1.01
+
+// Tokens are added at rate per second, up to burst. A rate of 0 is unlimited.
+struct TokenBucket {
+    double rate;
+    double burst;
+    double tokens;
+    double last_refill;
+};
+
+static bool throttle_enabled = false;
+static bool adaptive_flag = false;
+static struct TokenBucket iops_bucket;
+static struct TokenBucket dirs_bucket;
+static double max_iops_ceiling;     // --max-iops, which --adaptive never exceeds. 0 if unset.
+
+static double op_start;
+static double window_start;
+static unsigned long window_ops;
+static double window_latency;
+static double baseline_latency;
+
+static double now_seconds (void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static void sleep_seconds (double seconds)
+{
+    struct timespec duration;
+    duration.tv_sec = (time_t)seconds;
+    duration.tv_nsec = (long)((seconds - duration.tv_sec) * 1e9);
+    while (nanosleep(&duration, &duration) == -1 && errno == EINTR);
+}
+
+static void bucket_set_rate (struct TokenBucket *bucket, double rate)
+{
+    bucket->rate = rate;
+    // Bursts are limited to a tenth of a second of operations, so that the operations saved
+    // up during a slow directory are not all spent at once on the next one.
+    bucket->burst = (rate / 10.0 > 1.0) ? rate / 10.0 : 1.0;
+    if (bucket->tokens > bucket->burst) {
+        bucket->tokens = bucket->burst;
+    }
+}
+
+static void bucket_take (struct TokenBucket *bucket)
+{
+    if (bucket->rate <= 0.0) {
+        return;
+    }
+
+    double now = now_seconds();
+    bucket->tokens += (now - bucket->last_refill) * bucket->rate;
+    if (bucket->tokens > bucket->burst) {
+        bucket->tokens = bucket->burst;
+    }
+    bucket->last_refill = now;
+
+    if (bucket->tokens < 1.0) {
+        double wait = (1.0 - bucket->tokens) / bucket->rate;
+        sleep_seconds(wait);
+        // Any oversleeping is credited by the next refill.
+        bucket->tokens = 1.0;
+        bucket->last_refill = now + wait;
+    }
+    bucket->tokens -= 1.0;
+}
+
+void throttle_configure (double max_iops, double max_dirs_per_sec, bool adaptive)
+/**********************************************************************************************
+*
+*   Sets the limits applied by throttle_begin(). Does nothing (and throttle_begin() and
+*   throttle_end() return immediately) unless one of them is set.
+*
+*   ---------------------------------------- ARGUMENTS ----------------------------------------
+*
+*   max_iops            Filesystem operations per second, or 0 for no limit.
+*
+*   max_dirs_per_sec    Directories opened per second, or 0 for no limit.
+*
+*   adaptive            Adjust the operations per second to the latency of the operations,
+*                       never above max_iops if it is set.
+*
+**********************************************************************************************/
+{
+    double now = now_seconds();
+    throttle_enabled = (max_iops > 0.0) || (max_dirs_per_sec > 0.0) || adaptive;
+    adaptive_flag = adaptive;
+    max_iops_ceiling = max_iops;
+
+    bucket_set_rate(&iops_bucket, max_iops);
+    bucket_set_rate(&dirs_bucket, max_dirs_per_sec);
+    iops_bucket.tokens = iops_bucket.burst;
+    dirs_bucket.tokens = dirs_bucket.burst;
+    iops_bucket.last_refill = now;
+    dirs_bucket.last_refill = now;
+
+    window_start = now;
+    window_ops = 0;
+    window_latency = 0.0;
+    baseline_latency = 0.0;
+}
+
+void throttle_begin (bool opens_dir)
+/**********************************************************************************************
+*
+*   Waits until a filesystem operation is allowed, and starts timing it for --adaptive. Every
+*   call must be followed by throttle_end() once the operation returns.
+*
+*   ---------------------------------------- ARGUMENTS ----------------------------------------
+*
+*   opens_dir   The operation opens a directory, so it also counts against max_dirs_per_sec.
+*
+**********************************************************************************************/
+{
+    if (!throttle_enabled) {
+        return;
+    }
+    if (opens_dir) {
+        bucket_take(&dirs_bucket);
+    }
+    bucket_take(&iops_bucket);
+    if (adaptive_flag) {
+        op_start = now_seconds();
+    }
+}
+
+void throttle_end (void)
+/**********************************************************************************************
+*
+*   Ends the operation started by throttle_begin(). With --adaptive, closes the window once it
+*   is long enough and adjusts the operations per second, raising them by a tenth while the
+*   latency stays near its baseline and halving them on a latency spike. The walk has one
+*   operation in flight at a time, so the rate of operations is what controls the load it puts
+*   on the filesystem.
+*
+**********************************************************************************************/
+{
+    if (!adaptive_flag) {
+        return;
+    }
+
+    double now = now_seconds();
+    window_latency += now - op_start;
+    window_ops++;
+    if (now - window_start < WINDOW_SECONDS || window_ops < WINDOW_MIN_OPS) {
+        return;
+    }
+
+    double mean_latency = window_latency / window_ops;
+    double observed_rate = window_ops / (now - window_start);
+    if (baseline_latency == 0.0 || mean_latency < baseline_latency) {
+        baseline_latency = mean_latency;
+    }
+    else {
+        baseline_latency *= BASELINE_DRIFT;
+    }
+
+    if (mean_latency > SPIKE_RATIO * baseline_latency) {
+        // Back off from what the filesystem was actually doing, not from a limit it never hit.
+        double rate = observed_rate;
+        if (iops_bucket.rate > 0.0 && iops_bucket.rate < rate) {
+            rate = iops_bucket.rate;
+        }
+        rate *= BACKOFF_FACTOR;
+        bucket_set_rate(&iops_bucket, (rate > MIN_ADAPTIVE_IOPS) ? rate : MIN_ADAPTIVE_IOPS);
+    }
+    else if (mean_latency < CALM_RATIO * baseline_latency && iops_bucket.rate > 0.0) {
+        double rate = iops_bucket.rate * RAMP_UP_FACTOR;
+        if (max_iops_ceiling > 0.0 && rate > max_iops_ceiling) {
+            rate = max_iops_ceiling;
+        }
+        bucket_set_rate(&iops_bucket, rate);
+    }
+
+    window_start = now;
+    window_ops = 0;
+    window_latency = 0.0;
+}
@@ -0,0 +1,512 @@
+/**********************************************************************************************
+*
+*   traverse - Reads directories and walks trees for the nc-scout subcommands.
+*
+*   LICENSE: zlib/libpng
+*
+*   Copyright (c) 2024-2025 Josh Hayden (@BlinkDynamo)
+*
+*   This software is provided ‘as-is’, without any express or implied
+*   warranty. In no event will the authors be held liable for any damages
+*   arising from the use of this software.
+*
+*   Permission is granted to anyone to use this software for any purpose,
+*   including commercial applications, and to alter it and redistribute it
+*   freely, subject to the following restrictions:
+*
+*   1. The origin of this software must not be misrepresented; you must not
+*   claim that you wrote the original software. If you use this software
+*   in a product, an acknowledgment in the product documentation would be
+*   appreciated but is not required.
+*
+*   2. Altered source versions must be plainly marked as such, and must not be
+*   misrepresented as being the original software.
+*
+*   3. This notice may not be removed or altered from any source
+*   distribution.
+*
+*********************************************************************************************/
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif // _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <linux/limits.h>
+
+#include "common.h"
+#include "progress.h"
+#include "throttle.h"
+#include "metrics.h"
+#include "traverse.h"
+
+// An entry of the directory being traversed, for sorting entries by inode with --inode-order.
+struct EntryOrder {
+    ino_t ino;
+    size_t index;
+};
+
+static bool timestamp_before (struct statx_timestamp a, struct statx_timestamp b)
+{
+    return (a.tv_sec < b.tv_sec) || (a.tv_sec == b.tv_sec && a.tv_nsec < b.tv_nsec);
+}
+
+// Joins a directory path and an entry name into buf, returning false if it does not fit.
+bool traverse_join_path (char *buf, size_t size, const char *abs_dir_path, const char *name)
+{
+    // Avoid a double slash when the directory is the root directory.
+    const char *separator = (strcmp(abs_dir_path, "/") == 0) ? "" : "/";
+    int len = snprintf(buf, size, "%s%s%s", abs_dir_path, separator, name);
+    return len >= 0 && (size_t)len < size;
+}
+
+bool traverse_open_dir (const char *abs_path, int depth, struct TraverseDir *dir)
+/**********************************************************************************************
+*
+*   Opens a directory and reads all of its entries (except '.' and '..') into dir. The
+*   directory is kept open so that callers can issue metadata calls relative to dir->fd while
+*   visiting the entries, and must be closed with traverse_close_dir().
+*
+*   ---------------------------------------- ARGUMENTS ----------------------------------------
+*
+*   abs_path    The absolute path of the directory to read.
+*
+*   depth       The depth of the directory, stored in dir.
+*
+*   dir         The directory to fill. Its buffers are reused if it has been filled before.
+*
+*   ----------------------------------------- RETURNS -----------------------------------------
+*
+*   True if the directory was read, false (after printing an error) if it could not be opened.
+*
+**********************************************************************************************/
+{
+    size_t path_len = strlen(abs_path) + 1;
+    if (path_len > dir->abs_path_capacity) {
+        dir->abs_path_capacity = path_len;
+        dir->abs_path_buf = xrealloc(dir->abs_path_buf, path_len);
+    }
+    memcpy(dir->abs_path_buf, abs_path, path_len);
+    dir->abs_path = dir->abs_path_buf;
+    dir->depth = depth;
+    dir->changed = true;
+    dir->n_entries = 0;
+    dir->names_len = 0;
+
+    // The path is known to exist, but opening it can still fail from permissions.
+    throttle_begin(true);
+    uint64_t started = METRICS_START();
+    dir->fd = open(abs_path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    METRICS_STOP(METRICS_PHASE_OPEN, started);
+    throttle_end();
+    if (dir->fd == -1) {
+        printf("Error: cannot access %s due to Error %d (%s).\n", abs_path, errno, 
+                strerror(errno));
+        PROGRESS_ADD(errors, 1);
+        return false;
+    }
+    if (dir->readahead) {
+        posix_fadvise(dir->fd, 0, 0, POSIX_FADV_WILLNEED);
+    }
+    if (dir->dirents == NULL) {
+        dir->dirents = xrealloc(NULL, TRAVERSE_DIRENTS_SIZE);
+    }
+
+    // Entries are read with getdents64() rather than readdir(), so that every read of the
+    // directory goes through the throttle. Names are copied into one growing buffer, so
+    // entries are pointed at them once it is final.
+    ssize_t n_read;
+    while (true)
+    {
+        throttle_begin(false);
+        started = METRICS_START();
+        n_read = getdents64(dir->fd, dir->dirents, TRAVERSE_DIRENTS_SIZE);
+        METRICS_STOP(METRICS_PHASE_READ, started);
+        throttle_end();
+        if (n_read <= 0) {
+            break;
+        }
+
+        for (ssize_t offset = 0; offset < n_read; )
+        {
+            struct dirent64 *current_file = (struct dirent64 *)(dir->dirents + offset);
+            offset += current_file->d_reclen;
+
+            // Skip current and parent entries.
+            if (strcmp(current_file->d_name, ".") == 0 || strcmp(current_file->d_name, "..") == 0) {
+                continue;
+            }
+
+            size_t name_len = strlen(current_file->d_name) + 1;
+            if (dir->names_len + name_len > dir->names_capacity) {
+                dir->names_capacity = (dir->names_capacity + name_len) * 2;
+                dir->names = xrealloc(dir->names, dir->names_capacity);
+            }
+            if (dir->n_entries == dir->entries_capacity) {
+                dir->entries_capacity = (dir->entries_capacity == 0) ? 64 : dir->entries_capacity * 2;
+                dir->entries = xrealloc(dir->entries, 
+                                        dir->entries_capacity * sizeof(struct TraverseEntry));
+            }
+
+            struct TraverseEntry *entry = &dir->entries[dir->n_entries++];
+            memcpy(dir->names + dir->names_len, current_file->d_name, name_len);
+            entry->type = current_file->d_type;
+            entry->ino = current_file->d_ino;
+            entry->mark = 0;
+            dir->names_len += name_len;
+        }
+    }
+    if (n_read == -1) {
+        printf("Error: cannot read %s due to Error %d (%s).\n", abs_path, errno, 
+                strerror(errno));
+        PROGRESS_ADD(errors, 1);
+    }
+
+    const char *name = dir->names;
+    for (size_t i = 0; i < dir->n_entries; i++)
+    {
+        dir->entries[i].name = name;
+        name += strlen(name) + 1;
+    }
+    PROGRESS_ADD(dirs, 1);
+    PROGRESS_ADD(entries, dir->n_entries);
+    return true;
+}
+
+void traverse_close_dir (struct TraverseDir *dir)
+{
+    if (dir->fd != -1) {
+        close(dir->fd);
+        dir->fd = -1;
+    }
+}
+
+void traverse_free_dir (struct TraverseDir *dir)
+{
+    traverse_close_dir(dir);
+    free(dir->abs_path_buf);
+    free(dir->entries);
+    free(dir->names);
+    free(dir->dirents);
+    memset(dir, 0, sizeof(*dir));
+    dir->fd = -1;
+}
+
+// Returns the slice of shard_count that the entry name of relative_dir ("" for the root) is in.
+static int shard_of (const char *relative_dir, const char *name, int shard_count)
+{
+    char relative_path[PATH_MAX];
+    snprintf(relative_path, sizeof(relative_path), "%s%s%s", relative_dir, 
+             (*relative_dir) ? "/" : "", name);
+    // The low bits of the hash barely depend on the last characters of the path, so map the
+    // high bits onto the slices instead of taking the hash modulo shard_count.
+    return (int)(((hash_string(relative_path) >> 32) * (uint64_t)shard_count) >> 32);
+}
+
+// Whether an entry of dir is in the slice of the traversal. Directories deeper than
+// shard_depth are only entered when they are in the slice, so all of their entries are.
+static bool in_shard (const struct Traversal *traversal, const struct TraverseDir *dir,
+                      const char *relative_dir, const char *name)
+{
+    if (traversal->shard_count <= 1 || dir->depth + 1 > traversal->shard_depth) {
+        return true;
+    }
+    if (dir->depth + 1 < traversal->shard_depth) {
+        return traversal->shard_index == 0;
+    }
+    return shard_of(relative_dir, name, traversal->shard_count) == traversal->shard_index;
+}
+
+static bool is_visited_type (const struct Traversal *traversal, unsigned char type)
+{
+    unsigned char type_bit = (type == DT_REG) ? TRAVERSE_TYPE_FILE :
+                             (type == DT_DIR) ? TRAVERSE_TYPE_DIR :
+                             (type == DT_LNK && traversal->include_symlinks) ? TRAVERSE_TYPE_SYMLINK : 0;
+    if (type_bit == 0 || (traversal->filters.types != 0 && !(traversal->filters.types & type_bit))) {
+        return false;
+    }
+    // Only regular files have a meaningful size, so --min-size needs no call for the others.
+    return !traversal->filters.min_size_flag || type == DT_REG;
+}
+
+static void read_dir_ctime (const struct Traversal *traversal, struct TraverseDir *dir)
+/**********************************************************************************************
+*
+*   Reads the ctime of a directory, marking it as unchanged if it is older than
+*   traversal->changed_since. The call is made on the open directory and requests nothing
+*   but STATX_CTIME, so only the inode times have to be fetched.
+*
+*   Creating, renaming, or removing an entry updates the ctime of its directory. A directory
+*   whose ctime is older than changed_since therefore has no new or renamed entries, and is
+*   marked as unchanged without a call per entry.
+*
+*   ---------------------------------------- ARGUMENTS ----------------------------------------
+*
+*   traversal   The traversal, which has changed_since_flag set.
+*
+*   dir         The open directory. Sets dir->changed.
+*
+**********************************************************************************************/
+{
+    struct statx stx;
+    throttle_begin(false);
+    uint64_t started = METRICS_START();
+    int status = statx(dir->fd, "", AT_EMPTY_PATH, STATX_CTIME, &stx);
+    METRICS_STOP(METRICS_PHASE_STAT, started);
+    throttle_end();
+    if (status == 0 && timestamp_before(stx.stx_ctime, traversal->changed_since)) {
+        dir->changed = false;
+    }
+}
+
+// The fields statx() has to read for each visited entry, or 0 if no call is needed.
+static unsigned int metadata_mask (const struct Traversal *traversal)
+{
+    return ((traversal->changed_since_flag) ? STATX_CTIME : 0) |
+           ((traversal->filters.min_size_flag) ? STATX_SIZE : 0) |
+           ((traversal->filters.owner_flag) ? STATX_UID : 0);
+}
+
+static int compare_entry_order (const void *a, const void *b)
+{
+    const struct EntryOrder *ea = a;
+    const struct EntryOrder *eb = b;
+    return (ea->ino > eb->ino) - (ea->ino < eb->ino);
+}
+
+static bool read_entry_metadata (const struct Traversal *traversal, const struct TraverseDir *dir,
+                                 struct TraverseEntry *entry)
+/**********************************************************************************************
+*
+*   Reads what the traversal filters on from the inode of an entry, with one statx() relative
+*   to the open directory that requests only those fields, and checks the entry against them.
+*   Makes no call if nothing is filtered on.
+*
+*   ----------------------------------------- RETURNS -----------------------------------------
+*
+*   true if the entry is to be visited, otherwise false.
+*
+**********************************************************************************************/
+{
+    const struct TraverseFilters *filters = &traversal->filters;
+    unsigned int mask = metadata_mask(traversal);
+    if (mask == 0) {
+        return true;
+    }
+
+    struct statx stx;
+    throttle_begin(false);
+    uint64_t started = METRICS_START();
+    int status = statx(dir->fd, entry->name, AT_SYMLINK_NOFOLLOW, mask, &stx);
+    METRICS_STOP(METRICS_PHASE_STAT, started);
+    throttle_end();
+    if (status == 0) {
+        entry->ctime = stx.stx_ctime;
+        entry->size = stx.stx_size;
+        entry->uid = stx.stx_uid;
+    }
+    else {
+        // Report entries that vanished or cannot be read rather than silently losing them,
+        // unless they are filtered on what could not be read.
+        entry->ctime = traversal->changed_since;
+        if (filters->min_size_flag || filters->owner_flag) {
+            return false;
+        }
+    }
+
+    if (traversal->changed_since_flag && timestamp_before(entry->ctime, traversal->changed_since)) {
+        return false;
+    }
+    if (filters->min_size_flag && entry->size < filters->min_size) {
+        return false;
+    }
+    return !filters->owner_flag || entry->uid == filters->owner;
+}
+
+void traverse_describe_filters (const struct TraverseFilters *filters, char *buf, size_t size)
+{
+    // Describes the filters as one line, to tell whether two scans filtered alike.
+    snprintf(buf, size, "types=%d max-depth=%d min-size=%lld owner=%lld", filters->types, 
+             filters->max_depth, 
+             (filters->min_size_flag) ? (long long)filters->min_size : -1LL,
+             (filters->owner_flag) ? (long long)filters->owner : -1LL);
+}
+
+void traverse_tree (const struct Traversal *traversal, const char *abs_root_path)
+/**********************************************************************************************
+*
+*   Walks a tree depth-first, visiting every directory, regular file and (if requested)
+*   symlink inside of it that passes traversal->filters. Each directory is read in full and
+*   all of its entries are visited before any of its subdirectories are entered, so only one
+*   directory is open at a time. Subdirectories are entered in the order they were read.
+*
+*   With traversal->inode_order, subdirectories are entered, and the metadata of entries read,
+*   in the order of their inode numbers instead, which on most filesystems is close to the
+*   order of the inodes on disk. The same entries are visited, in the same order within a
+*   directory.
+*
+*   Between directories, the directories still to be read are passed to traversal->frontier,
+*   and a traversal given them as traversal->resume carries on from there.
+*
+*   ---------------------------------------- ARGUMENTS ----------------------------------------
+*
+*   traversal       How to traverse the tree, and the function visiting each entry.
+*
+*   abs_root_path   The absolute path of the directory to traverse. It is not visited itself.
+*
+**********************************************************************************************/
+{
+    size_t root_len = strlen(abs_root_path);
+    struct TraversePending *stack = NULL;
+    size_t stack_len = 0;
+    size_t stack_capacity = 0;
+    struct TraverseDir dir = {.fd = -1, .readahead = traversal->inode_order};
+    struct EntryOrder *order = NULL;
+    size_t order_capacity = 0;
+    bool *passes = NULL;
+
+    if (traversal->resume != NULL) {
+        stack_capacity = (traversal->n_resume > 0) ? traversal->n_resume : 1;
+        stack = xrealloc(stack, stack_capacity * sizeof(struct TraversePending));
+        for (; stack_len < traversal->n_resume; stack_len++)
+        {
+            stack[stack_len].abs_path = strdup(traversal->resume[stack_len].abs_path);
+            stack[stack_len].depth = traversal->resume[stack_len].depth;
+            stack[stack_len].mark = 0;
+        }
+    }
+    else {
+        stack = xrealloc(stack, sizeof(struct TraversePending));
+        stack_capacity = 1;
+        stack[stack_len++] = (struct TraversePending){strdup(abs_root_path), 0, 0};
+    }
+
+    while (stack_len > 0)
+    {
+        struct TraversePending current = stack[--stack_len];
+
+        if (traverse_open_dir(current.abs_path, current.depth, &dir)) {
+            const char *relative_dir = dir.abs_path + root_len + (dir.abs_path[root_len] == '/');
+            if (traversal->changed_since_flag) {
+                read_dir_ctime(traversal, &dir);
+            }
+            dir.mark = current.mark;
+            for (size_t i = 0; traversal->mark_subdir != NULL && i < dir.n_entries; i++)
+            {
+                if (dir.entries[i].type == DT_DIR) {
+                    dir.entries[i].mark = traversal->mark_subdir(&dir.entries[i], &dir, 
+                                                                 traversal->context);
+                }
+            }
+
+            // The cheapest checks come first, so metadata is only read for entries that could
+            // still be visited. The loop is timed as a whole, less its statx() calls, so that
+            // metrics read no clock per entry.
+            uint64_t visit_started = METRICS_START();
+            uint64_t stat_ns = metrics_phase_ns[METRICS_PHASE_STAT];
+            if (dir.n_entries > order_capacity) {
+                order_capacity = dir.n_entries * 2;
+                order = xrealloc(order, order_capacity * sizeof(struct EntryOrder));
+                passes = xrealloc(passes, order_capacity * sizeof(bool));
+            }
+
+            // With --inode-order, read the metadata of the entries that need it in inode order
+            // first, then visit them in the order they were read.
+            bool prefetched = traversal->inode_order && dir.changed && metadata_mask(traversal) != 0;
+            if (prefetched) {
+                size_t n_order = 0;
+                for (size_t i = 0; i < dir.n_entries; i++)
+                {
+                    passes[i] = false;
+                    if (is_visited_type(traversal, dir.entries[i].type) &&
+                        in_shard(traversal, &dir, relative_dir, dir.entries[i].name)) {
+                        order[n_order++] = (struct EntryOrder){dir.entries[i].ino, i};
+                    }
+                }
+                qsort(order, n_order, sizeof(struct EntryOrder), compare_entry_order);
+                for (size_t k = 0; k < n_order; k++)
+                {
+                    passes[order[k].index] = read_entry_metadata(traversal, &dir, 
+                                                                 &dir.entries[order[k].index]);
+                }
+            }
+
+            for (size_t i = 0; i < dir.n_entries && dir.changed; i++)
+            {
+                struct TraverseEntry *entry = &dir.entries[i];
+                if (prefetched) {
+                    if (!passes[i]) {
+                        continue;
+                    }
+                }
+                else if (!is_visited_type(traversal, entry->type) ||
+                         !in_shard(traversal, &dir, relative_dir, entry->name) ||
+                         !read_entry_metadata(traversal, &dir, entry)) {
+                    continue;
+                }
+                traversal->visit(entry, &dir, traversal->context);
+            }
+            METRICS_STOP(METRICS_PHASE_VISIT, 
+                         visit_started + (metrics_phase_ns[METRICS_PHASE_STAT] - stat_ns));
+            if (traversal->finish_dir != NULL && dir.changed) {
+                traversal->finish_dir(&dir, traversal->context);
+            }
+            traverse_close_dir(&dir);
+
+            // Directories at max_depth have had their entries visited, and hold none to visit.
+            bool descend = traversal->recursive && 
+                           (traversal->filters.max_depth == 0 || 
+                            dir.depth + 1 < traversal->filters.max_depth);
+            size_t n_subdirs = 0;
+            for (size_t i = 0; descend && i < dir.n_entries; i++)
+            {
+                if (dir.entries[i].type != DT_DIR) {
+                    continue;
+                }
+                // Directories above shard_depth are entered by every slice, to reach the
+                // entries at shard_depth under them.
+                if (dir.depth + 1 >= traversal->shard_depth &&
+                    !in_shard(traversal, &dir, relative_dir, dir.entries[i].name)) {
+                    continue;
+                }
+                order[n_subdirs++] = (struct EntryOrder){dir.entries[i].ino, i};
+            }
+            if (traversal->inode_order) {
+                qsort(order, n_subdirs, sizeof(struct EntryOrder), compare_entry_order);
+            }
+
+            // Push subdirectories in reverse, so that they are popped in order.
+            for (size_t k = n_subdirs; k-- > 0; )
+            {
+                size_t i = order[k].index;
+                char abs_new_path[PATH_MAX];
+                if (!traverse_join_path(abs_new_path, sizeof(abs_new_path), dir.abs_path, 
+                                        dir.entries[i].name)) {
+                    printf("Error: path of %s/%s is too long.\n", dir.abs_path, dir.entries[i].name);
+                    continue;
+                }
+                if (stack_len == stack_capacity) {
+                    stack_capacity *= 2;
+                    stack = xrealloc(stack, stack_capacity * sizeof(struct TraversePending));
+                }
+                stack[stack_len++] = (struct TraversePending){strdup(abs_new_path), current.depth + 1,
+                                                              dir.entries[i].mark};
+            }
+        }
+        free(current.abs_path);
+        if (traversal->frontier != NULL) {
+            traversal->frontier(stack, stack_len);
+        }
+    }
+    traverse_free_dir(&dir);
+    free(stack);
+    free(order);
+    free(passes);
+}
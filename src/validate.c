@@ -27,11 +27,20 @@
 *
 *********************************************************************************************/
 
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif // _GNU_SOURCE
+
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <time.h>
+#include <errno.h>
 #include <unistd.h>
+#include <pwd.h>
 #include <sys/stat.h>
 
+#include "traverse.h"
 #include "validate.h"
 
 bool validate_file_exists (const char *filepath)
@@ -55,3 +64,140 @@ bool validate_file_is_dir (const char *filepath)
     }
     return true;
 }
+
+bool validate_timestamp (const char *arg, struct statx_timestamp *timestamp)
+{
+    // Seconds since the epoch, optionally prefixed with '@' (as with `date +@%s`).
+    const char *seconds_arg = (arg[0] == '@') ? arg + 1 : arg;
+    char *end;
+    errno = 0;
+    long long seconds = strtoll(seconds_arg, &end, 10);
+    if (errno == 0 && end != seconds_arg && *end == '\0') {
+        timestamp->tv_sec = seconds;
+        timestamp->tv_nsec = 0;
+        return true;
+    }
+
+    // Otherwise a local date, with an optional time of day.
+    const char *formats[] = {"%Y-%m-%dT%H:%M:%S", "%Y-%m-%d %H:%M:%S", "%Y-%m-%d"};
+    for (size_t i = 0; i < sizeof(formats) / sizeof(formats[0]); i++)
+    {
+        struct tm tm = {0};
+        end = strptime(arg, formats[i], &tm);
+        if (end != NULL && *end == '\0') {
+            tm.tm_isdst = -1;
+            timestamp->tv_sec = mktime(&tm);
+            timestamp->tv_nsec = 0;
+            return true;
+        }
+    }
+    printf("Error: '%s' is not a valid timestamp (expected seconds since the epoch or "
+           "YYYY-MM-DD[THH:MM:SS]).\n", arg);
+    return false;
+}
+
+bool validate_rate (const char *arg, double *rate)
+{
+    char *end;
+    *rate = strtod(arg, &end);
+    if (*arg == '\0' || *end != '\0' || !(*rate > 0.0)) {
+        printf("Error: '%s' is not a valid rate (expected a number of operations per second).\n", arg);
+        return false;
+    }
+    return true;
+}
+
+bool validate_shard (const char *arg, int *index, int *count)
+{
+    // The slice is given from 1, as in "2/4", and returned from 0.
+    char *end;
+    long i = strtol(arg, &end, 10);
+    if (end != arg && *end == '/') {
+        const char *count_arg = end + 1;
+        long n = strtol(count_arg, &end, 10);
+        if (end != count_arg && *end == '\0' && n >= 1 && n <= MAX_SHARDS && i >= 1 && i <= n) {
+            *index = (int)(i - 1);
+            *count = (int)n;
+            return true;
+        }
+    }
+    printf("Error: '%s' is not a valid shard (expected i/N, with 1 <= i <= N <= %d).\n", arg,
+           MAX_SHARDS);
+    return false;
+}
+
+bool validate_types (const char *arg, unsigned char *types)
+{
+    // A comma-separated list of f (regular files), d (directories) and l (symlinks).
+    *types = 0;
+    for (const char *c = arg; *c != '\0'; c++)
+    {
+        if (*c == 'f' || *c == 'd' || *c == 'l') {
+            *types |= (*c == 'f') ? TRAVERSE_TYPE_FILE : 
+                      (*c == 'd') ? TRAVERSE_TYPE_DIR : TRAVERSE_TYPE_SYMLINK;
+            if (c[1] == ',' && c[2] != '\0') {
+                c++;
+                continue;
+            }
+            if (c[1] == '\0') {
+                return true;
+            }
+        }
+        break;
+    }
+    printf("Error: '%s' is not a valid type (expected f, d, l, or a list such as f,l).\n", arg);
+    return false;
+}
+
+bool validate_size (const char *arg, uint64_t *size)
+{
+    // A number of bytes, optionally followed by K, M, G or T (powers of 1024).
+    char *end;
+    errno = 0;
+    unsigned long long value = strtoull(arg, &end, 10);
+    int shift = 0;
+    switch (*end)
+    {
+        case 'K': shift = 10; end++; break;
+        case 'M': shift = 20; end++; break;
+        case 'G': shift = 30; end++; break;
+        case 'T': shift = 40; end++; break;
+    }
+    if (end == arg || *end != '\0' || errno != 0 || arg[0] == '-' || (value << shift >> shift) != value) {
+        printf("Error: '%s' is not a valid size (expected bytes, or a number followed by K, M, G or T).\n", 
+               arg);
+        return false;
+    }
+    *size = (uint64_t)value << shift;
+    return true;
+}
+
+bool validate_owner (const char *arg, uid_t *owner)
+{
+    // A user name, or a numeric user ID.
+    struct passwd *user = getpwnam(arg);
+    if (user != NULL) {
+        *owner = user->pw_uid;
+        return true;
+    }
+    char *end;
+    unsigned long uid = strtoul(arg, &end, 10);
+    if (end != arg && *end == '\0' && arg[0] != '-' && uid < (uid_t)-1) {
+        *owner = (uid_t)uid;
+        return true;
+    }
+    printf("Error: '%s' is not a known user or user ID.\n", arg);
+    return false;
+}
+
+bool validate_depth (const char *arg, int *depth)
+{
+    char *end;
+    long value = strtol(arg, &end, 10);
+    if (*arg == '\0' || *end != '\0' || value < 1 || value > 4096) {
+        printf("Error: '%s' is not a valid depth (expected a number from 1 to 4096).\n", arg);
+        return false;
+    }
+    *depth = (int)value;
+    return true;
+}
@@ -0,0 +1,113 @@
+/**********************************************************************************************
+*
+*   verdicts - A fixed-size cache of the verdicts of names seen before.
+*
+*   LICENSE: zlib/libpng 
+*
+*   Copyright (c) 2024-2025 Josh Hayden (@BlinkDynamo)
+*
+*   This software is provided ‘as-is’, without any express or implied
+*   warranty. In no event will the authors be held liable for any damages
+*   arising from the use of this software.
+*
+*   Permission is granted to anyone to use this software for any purpose,
+*   including commercial applications, and to alter it and redistribute it
+*   freely, subject to the following restrictions:
+*
+*   1. The origin of this software must not be misrepresented; you must not
+*   claim that you wrote the original software. If you use this software
+*   in a product, an acknowledgment in the product documentation would be
+*   appreciated but is not required.
+*
+*   2. Altered source versions must be plainly marked as such, and must not be
+*   misrepresented as being the original software.
+*
+*   3. This notice may not be removed or altered from any source
+*   distribution. 
+*
+*********************************************************************************************/
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif // _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+#include "progress.h"
+#include "verdicts.h"
+
+#define VERDICT_CACHE_LINE 64
+
+bool verdicts_match (struct VerdictCache *cache, unsigned int rule_index, 
+                     const struct NamingRule *rule, const char *name)
+/**********************************************************************************************
+*
+*   Compares a name to a rule, or looks up the verdict of the last time the same name was
+*   compared to it. A repeated name (index.js, Makefile, __init__.py) costs one hash and one
+*   compare. The hits and misses are counted in progress_counters.
+*
+*   ---------------------------------------- ARGUMENTS ----------------------------------------
+*
+*   cache       The cache to look the name up in. Only one thread may use it.
+*
+*   rule_index  Which of the rules being searched for rule is, such as the index of a policy.
+*
+*   rule        The rule to compare name to on a miss.
+*
+*   name        The name to compare.
+*
+*   ----------------------------------------- RETURNS -----------------------------------------
+*
+*   Whether name matches rule, as naming_match_rule() would return.
+*
+**********************************************************************************************/
+{
+    if (cache->slots == NULL) {
+        if (posix_memalign((void **)&cache->slots, VERDICT_CACHE_LINE, 
+                           VERDICT_CACHE_SLOTS * sizeof(struct VerdictSlot)) != 0) {
+            out_of_memory();
+        }
+        memset(cache->slots, 0, VERDICT_CACHE_SLOTS * sizeof(struct VerdictSlot));
+    }
+
+    // FNV-1a over the name, stopping once it is too long to be cached.
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    size_t length = 0;
+    for (; name[length] != '\0' && length <= VERDICT_NAME_MAX; length++)
+    {
+        hash ^= (unsigned char)name[length];
+        hash *= 0x100000001b3ULL;
+    }
+    if (length > VERDICT_NAME_MAX || rule_index >= VERDICT_RULES) {
+        PROGRESS_ADD(verdict_misses, 1);
+        return naming_match_rule(rule, name);
+    }
+    hash ^= length;
+
+    struct VerdictSlot *slot = &cache->slots[hash & (VERDICT_CACHE_SLOTS - 1)];
+    uint32_t bit = (uint32_t)1 << rule_index;
+    bool same_name = (slot->hash == (uint32_t)(hash >> 32) && slot->length == length && 
+                      memcmp(slot->name, name, length) == 0);
+    if (same_name && (slot->known & bit)) {
+        PROGRESS_ADD(verdict_hits, 1);
+        return (slot->matches & bit) != 0;
+    }
+
+    PROGRESS_ADD(verdict_misses, 1);
+    bool is_match = naming_match_rule(rule, name);
+    if (!same_name) {
+        slot->hash = (uint32_t)(hash >> 32);
+        slot->length = (uint16_t)length;
+        memcpy(slot->name, name, length);
+        slot->known = 0;
+        slot->matches = 0;
+    }
+    slot->known |= bit;
+    if (is_match) {
+        slot->matches |= bit;
+    }
+    return is_match;
+}
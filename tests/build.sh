@@ -79,4 +79,10 @@ build_test_directory "cobolcase_lenient_matches" 10
 build_test_directory "snakecase_lenient_matches" 10
 build_test_directory "constantcase_lenient_matches" 10
 
+# Unicode matches.
+build_test_directory "snakecase_unicode_matches" 10
+
+# Collisions.
+build_test_directory "collisions" 10
+
 printf "\nBuild step completed.\n\n"
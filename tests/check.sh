@@ -164,4 +164,270 @@ check_analyze "./$BUILD_DIR/nc-scout analyze -R kebabcase $TESTS_DIR/kebabcase_l
 check_analyze "./$BUILD_DIR/nc-scout analyze -R cobolcase $TESTS_DIR/cobolcase_lenient_matches" 100.000
 printf "\n"
 
+printf "${ORANGE}Estimate tests for strict matches:${RESET}\n"
+check_analyze "./$BUILD_DIR/nc-scout analyze -e --seed 1 flatcase $TESTS_DIR/flatcase_strict_matches" 100.000
+check_analyze "./$BUILD_DIR/nc-scout analyze -e --seed 1 snakecase $TESTS_DIR/snakecase_strict_matches" 100.000
+check_analyze "./$BUILD_DIR/nc-scout analyze -e --seed 1 --deadline 5 kebabcase $TESTS_DIR/kebabcase_strict_matches" 100.000
+printf "\n"
+
+# An unbalanced tree where 9 of 12 names match, so walks disagree and the interval has width.
+mkdir -p "$BUILD_DIR/estimate_mixed/left_dir" "$BUILD_DIR/estimate_mixed/Right-Dir"
+touch "$BUILD_DIR/estimate_mixed/good_root" "$BUILD_DIR/estimate_mixed/Bad-Root" \
+      "$BUILD_DIR/estimate_mixed/Right-Dir/Bad-A" "$BUILD_DIR/estimate_mixed/Right-Dir/good_b"
+for name in a_one a_two a_three a_four a_five a_six; do
+    touch "$BUILD_DIR/estimate_mixed/left_dir/$name"
+done
+
+# Prints 'covered' if the estimate is within a point of the exact percentage and the
+# interval is not empty and contains it, 'missed' otherwise.
+function estimate_coverage()
+{
+    local exact="$1"
+    sed -n 's/.*make up \([0-9.]*\)% .*CI \([0-9.]*\)% - \([0-9.]*\)%).*/\1 \2 \3/p' \
+        | awk -v exact="$exact" '{
+              near = ($1 - exact) ^ 2 < 1
+              print (near && $2 < $3 && $2 <= exact && exact <= $3) ? "covered" : "missed"
+          }'
+}
+
+./$BUILD_DIR/nc-scout analyze -e --seed 1 snakecase $BUILD_DIR/estimate_mixed \
+    | estimate_coverage 75 > "$BUILD_DIR/estimate-interval.txt"
+./$BUILD_DIR/nc-scout analyze -e --seed 1 --deadline 0.05 --probes 100000000 snakecase \
+    $BUILD_DIR/estimate_mixed > "$BUILD_DIR/estimate-deadline.txt"
+estimate_coverage 75 < "$BUILD_DIR/estimate-deadline.txt" > "$BUILD_DIR/estimate-deadline-interval.txt"
+
+printf "${ORANGE}Estimate tests for partial matches:${RESET}\n"
+check_analyze "./$BUILD_DIR/nc-scout analyze -R snakecase $BUILD_DIR/estimate_mixed" 75.000
+check_analyze "./$BUILD_DIR/nc-scout analyze -e --seed 1 snakecase $BUILD_DIR/estimate_mixed" 75.199
+check_analyze "./$BUILD_DIR/nc-scout analyze -e --seed 1 snakecase $TESTS_DIR/collisions" 54.545
+check_search "grep -x covered $BUILD_DIR/estimate-interval.txt" 1
+check_search "grep -o stopped.by.the.deadline $BUILD_DIR/estimate-deadline.txt" 1
+check_search "grep -x covered $BUILD_DIR/estimate-deadline-interval.txt" 1
+printf "\n"
+
+printf "${ORANGE}Changed-since tests for strict matches:${RESET}\n"
+check_search "./$BUILD_DIR/nc-scout search -sR --changed-since 0 snakecase $TESTS_DIR/snakecase_strict_matches" 100
+check_search "./$BUILD_DIR/nc-scout search -sR --changed-since 4102444800 snakecase $TESTS_DIR/snakecase_strict_matches" 0
+check_analyze "./$BUILD_DIR/nc-scout analyze -R --changed-since 1970-01-02 kebabcase $TESTS_DIR/kebabcase_strict_matches" 100.000
+printf "\n"
+
+printf "${ORANGE}Unicode tests for lenient matches:${RESET}\n"
+check_search "./$BUILD_DIR/nc-scout search -uR snakecase $TESTS_DIR/snakecase_unicode_matches" 100
+check_search "./$BUILD_DIR/nc-scout search -R snakecase $TESTS_DIR/snakecase_unicode_matches" 0
+check_search "./$BUILD_DIR/nc-scout search -uR snakecase $TESTS_DIR/snakecase_lenient_matches" 100
+check_analyze "./$BUILD_DIR/nc-scout analyze -uR snakecase $TESTS_DIR/snakecase_unicode_matches" 100.000
+printf "\n"
+
+printf "${ORANGE}Policy tests:${RESET}\n"
+check_search "./$BUILD_DIR/nc-scout search -R --policy tests/policy.conf $TESTS_DIR/snakecase_strict_matches" 100
+check_search "./$BUILD_DIR/nc-scout search -nR --policy tests/policy.conf $TESTS_DIR/snakecase_strict_matches" 0
+check_analyze "./$BUILD_DIR/nc-scout analyze -R --policy tests/policy.conf $TESTS_DIR/snakecase_strict_matches" 100.000
+check_analyze "./$BUILD_DIR/nc-scout analyze -R --policy tests/policy.conf $TESTS_DIR/kebabcase_strict_matches" 0.000
+# A prefix of src applies to src/Bad-One and src/lib/Bad-Three, but not to src2/Bad-Two.
+mkdir -p "$BUILD_DIR/policy_prefix/src/lib" "$BUILD_DIR/policy_prefix/src2"
+touch "$BUILD_DIR/policy_prefix/src/Bad-One" "$BUILD_DIR/policy_prefix/src2/Bad-Two" \
+      "$BUILD_DIR/policy_prefix/src/lib/Bad-Three"
+printf "sources file * src snakecase\n" > "$BUILD_DIR/policy_prefix.conf"
+check_search "./$BUILD_DIR/nc-scout search -nR --policy $BUILD_DIR/policy_prefix.conf $BUILD_DIR/policy_prefix" 2
+check_search "./$BUILD_DIR/nc-scout search -nR --policy $BUILD_DIR/policy_prefix.conf $BUILD_DIR/policy_prefix/src2" 0
+printf "\n"
+
+# Reports go to stderr, ending with a final one once the scan is done.
+./$BUILD_DIR/nc-scout search -sR --progress=0.01 camelcase $TESTS_DIR/camelcase_strict_matches \
+    > "$BUILD_DIR/progress-search.txt" 2> "$BUILD_DIR/progress-search.err"
+./$BUILD_DIR/nc-scout analyze -R --progress camelcase $TESTS_DIR/camelcase_strict_matches \
+    > "$BUILD_DIR/progress-analyze.txt" 2> "$BUILD_DIR/progress-analyze.err"
+
+printf "${ORANGE}Progress tests:${RESET}\n"
+check_search "cat $BUILD_DIR/progress-search.txt" 100
+check_search "grep -x \[nc-scout\].*.11.dirs,.100.entries,.0.violations,.0.errors,.*ETA.done,.* $BUILD_DIR/progress-search.err" 1
+check_search "grep -o make.up.100.000% $BUILD_DIR/progress-analyze.txt" 1
+check_search "grep -x \[nc-scout\].*.11.dirs,.100.entries,.0.violations,.0.errors,.*ETA.done,.* $BUILD_DIR/progress-analyze.err" 1
+printf "\n"
+
+printf "${ORANGE}Collisions tests:${RESET}\n"
+check_search "./$BUILD_DIR/nc-scout collisions -R $TESTS_DIR/collisions" 30
+check_search "./$BUILD_DIR/nc-scout collisions -f $TESTS_DIR/collisions" 3
+# examplefile.txt has no hump, and still collides with ExampleFile.txt.
+./$BUILD_DIR/nc-scout collisions -f $TESTS_DIR/collisions > "$BUILD_DIR/collisions.txt"
+check_search "grep -w examplefile.txt $BUILD_DIR/collisions.txt" 1
+# Only word separators are dropped, so only 'foo bar.txt' and 'foo_bar.txt' collide here.
+mkdir -p "$BUILD_DIR/collisions_kept"
+touch "$BUILD_DIR/collisions_kept/"{c.h,c++.h,a@b,ab,"report (1).txt",report1.txt,v1.2.txt,v12.txt} \
+      "$BUILD_DIR/collisions_kept/foo bar.txt" "$BUILD_DIR/collisions_kept/foo_bar.txt"
+./$BUILD_DIR/nc-scout collisions $BUILD_DIR/collisions_kept > "$BUILD_DIR/collisions_kept.txt"
+check_search "cat $BUILD_DIR/collisions_kept.txt" 1
+check_search "grep -o foo_bar.txt $BUILD_DIR/collisions_kept.txt" 1
+check_search "./$BUILD_DIR/nc-scout collisions -R $TESTS_DIR/camelcase_strict_matches" 0
+printf "\n"
+
+printf "${ORANGE}Baseline tests:${RESET}\n"
+check_search "./$BUILD_DIR/nc-scout search -nR --write-baseline $BUILD_DIR/baseline snakecase $TESTS_DIR/camelcase_strict_matches" 100
+check_search "./$BUILD_DIR/nc-scout search -nR --baseline $BUILD_DIR/baseline snakecase $TESTS_DIR/camelcase_strict_matches" 0
+check_search "./$BUILD_DIR/nc-scout search -nR --baseline $BUILD_DIR/baseline snakecase $TESTS_DIR/pascalcase_strict_matches" 100
+printf "\n"
+
+printf "${ORANGE}Throttle tests:${RESET}\n"
+check_search "./$BUILD_DIR/nc-scout search -sR --max-dirs-per-sec 100 flatcase $TESTS_DIR/flatcase_strict_matches" 100
+check_search "./$BUILD_DIR/nc-scout search -sR --max-iops 500 --adaptive flatcase $TESTS_DIR/flatcase_strict_matches" 100
+check_analyze "./$BUILD_DIR/nc-scout analyze -R --adaptive flatcase $TESTS_DIR/flatcase_strict_matches" 100.000
+printf "\n"
+
+printf "${ORANGE}Detailed statistics tests:${RESET}\n"
+check_analyze "./$BUILD_DIR/nc-scout analyze -R --stats-detail snakecase $TESTS_DIR/snakecase_strict_matches" 100.000
+./$BUILD_DIR/nc-scout analyze -R --stats-detail snakecase $TESTS_DIR/snakecase_strict_matches > "$BUILD_DIR/stats.txt"
+check_search "grep -x hits.*81.*81.000% $BUILD_DIR/stats.txt" 1
+check_analyze "./$BUILD_DIR/nc-scout analyze -R --stats-detail=3 --policy tests/policy.conf $TESTS_DIR/kebabcase_strict_matches" 0.000
+printf "\n"
+
+printf "${ORANGE}Shard tests:${RESET}\n"
+check_search "./$BUILD_DIR/nc-scout search -nR --shard 1/2 --partial $BUILD_DIR/search1.part snakecase $TESTS_DIR/camelcase_strict_matches" 0
+# Shards name the location as they like, as long as it is the same directory.
+check_search "./$BUILD_DIR/nc-scout search -nR --shard 2/2 --partial $BUILD_DIR/search2.part snakecase ./$TESTS_DIR/camelcase_strict_matches/" 0
+check_search "./$BUILD_DIR/nc-scout merge $BUILD_DIR/search2.part $BUILD_DIR/search1.part" 100
+check_search "./$BUILD_DIR/nc-scout analyze -R --shard 1/3 --shard-depth 2 --partial $BUILD_DIR/analyze1.part pascalcase $TESTS_DIR/pascalcase_strict_matches" 0
+check_search "./$BUILD_DIR/nc-scout analyze -R --shard 2/3 --shard-depth 2 --partial $BUILD_DIR/analyze2.part pascalcase $TESTS_DIR/pascalcase_strict_matches" 0
+check_search "./$BUILD_DIR/nc-scout analyze -R --shard 3/3 --shard-depth 2 --partial $BUILD_DIR/analyze3.part pascalcase $TESTS_DIR/pascalcase_strict_matches" 0
+check_analyze "./$BUILD_DIR/nc-scout merge $BUILD_DIR/analyze1.part $BUILD_DIR/analyze2.part $BUILD_DIR/analyze3.part" 100.000
+printf "\n"
+
+printf "${ORANGE}Checkpoint tests:${RESET}\n"
+check_analyze "./$BUILD_DIR/nc-scout analyze -R --checkpoint $BUILD_DIR/analyze.checkpoint --checkpoint-interval 0.001 snakecase $TESTS_DIR/snakecase_strict_matches" 100.000
+# A checkpoint taken with the whole tree still pending, after 50 matches and 50 non-matches.
+resume_dir="$(realpath "$TESTS_DIR/snakecase_strict_matches")"
+printf "%s\n" "nc-scout-checkpoint 1" \
+       "scan analyze convention=snakecase strict=0 unicode=0 recursive=1 changed-since=-1 shard=1/1 shard-depth=1 types=0 max-depth=0 min-size=-1 owner=-1 location=$resume_dir" \
+       "matches 50" "non-matches 50" "progress 5 100 50 0 0 100" "pending 1" "0 ${#resume_dir} $resume_dir" > "$BUILD_DIR/analyze.checkpoint"
+check_analyze "./$BUILD_DIR/nc-scout analyze -R --resume $BUILD_DIR/analyze.checkpoint --metrics-file $BUILD_DIR/resume.prom snakecase $TESTS_DIR/snakecase_strict_matches" 75.000
+# The 100 entries read after resuming add to the 100 read before the checkpoint.
+check_search "grep -x nc_scout_entries_scanned{.*}.200 $BUILD_DIR/resume.prom" 1
+# The same for a search, whose checkpoint also holds the length of its output.
+printf "%s\n" "nc-scout-checkpoint 1" \
+       "scan search convention=snakecase strict=0 unicode=0 recursive=1 non-matches=0 full-path=0 changed-since=-1 shard=1/1 shard-depth=1 types=0 max-depth=0 min-size=-1 owner=-1 location=$resume_dir" \
+       "matches 50" "non-matches 50" "progress 5 100 50 0 0 100" "output-offset 0" "pending 1" "0 ${#resume_dir} $resume_dir" > "$BUILD_DIR/search.checkpoint"
+./$BUILD_DIR/nc-scout search -R --resume $BUILD_DIR/search.checkpoint --metrics-file $BUILD_DIR/resume.prom snakecase $TESTS_DIR/snakecase_strict_matches > "$BUILD_DIR/resume.txt"
+check_search "cat $BUILD_DIR/resume.txt" 100
+check_search "grep -x nc_scout_matches{.*snakecase.*}.150 $BUILD_DIR/resume.prom" 1
+check_search "grep -x nc_scout_violations{.*snakecase.*}.50 $BUILD_DIR/resume.prom" 1
+check_search "grep -x nc_scout_entries_scanned{.*}.200 $BUILD_DIR/resume.prom" 1
+printf "\n"
+
+printf "${ORANGE}Filter tests:${RESET}\n"
+check_search "./$BUILD_DIR/nc-scout search -R --max-depth 3 camelcase $TESTS_DIR/camelcase_strict_matches" 30
+check_search "./$BUILD_DIR/nc-scout search -R --type d camelcase $TESTS_DIR/camelcase_strict_matches" 10
+check_search "./$BUILD_DIR/nc-scout search -R --type f,l --max-depth 2 camelcase $TESTS_DIR/camelcase_strict_matches" 18
+check_search "./$BUILD_DIR/nc-scout search -R --min-size 1 camelcase $TESTS_DIR/camelcase_strict_matches" 0
+check_analyze "./$BUILD_DIR/nc-scout analyze -R --owner $(id -u) --type f camelcase $TESTS_DIR/camelcase_strict_matches" 100.000
+printf "\n"
+
+printf "${ORANGE}Inode order tests:${RESET}\n"
+check_search "./$BUILD_DIR/nc-scout search -R --inode-order snakecase $TESTS_DIR/snakecase_strict_matches" 100
+check_analyze "./$BUILD_DIR/nc-scout analyze -R --inode-order --owner $(id -u) snakecase $TESTS_DIR/snakecase_strict_matches" 100.000
+printf "\n"
+
+printf "${ORANGE}Metrics tests:${RESET}\n"
+check_analyze "./$BUILD_DIR/nc-scout analyze -R --metrics-file $BUILD_DIR/analyze.prom kebabcase $TESTS_DIR/kebabcase_strict_matches" 100.000
+check_search "grep -v ^# $BUILD_DIR/analyze.prom" 13
+check_search "grep -x nc_scout_matches{.*kebabcase.*}.100 $BUILD_DIR/analyze.prom" 1
+# Every name but the one too long to cache is read in all 10 directories, missing only once.
+check_search "grep -x nc_scout_verdict_cache_hits{.*}.81 $BUILD_DIR/analyze.prom" 1
+printf "\n"
+
+printf "${ORANGE}Sort tests:${RESET}\n"
+check_search "./$BUILD_DIR/nc-scout search -R -n --sort kebabcase $TESTS_DIR/collisions" 70
+check_search "./$BUILD_DIR/nc-scout search -R -n --sort --sort-memory 1K kebabcase $TESTS_DIR/collisions" 70
+check_search "./$BUILD_DIR/nc-scout search -R --sort --shard 1/2 --partial $BUILD_DIR/sort-1.part camelcase $TESTS_DIR/camelcase_strict_matches" 0
+check_search "./$BUILD_DIR/nc-scout search -R --sort --shard 2/2 --partial $BUILD_DIR/sort-2.part camelcase $TESTS_DIR/camelcase_strict_matches" 0
+check_search "./$BUILD_DIR/nc-scout merge $BUILD_DIR/sort-2.part $BUILD_DIR/sort-1.part" 100
+# The output must be in byte order, the same whether it fit in memory or was spilled to runs.
+./$BUILD_DIR/nc-scout search -R -n kebabcase $TESTS_DIR/collisions | LC_ALL=C sort > "$BUILD_DIR/sort-expected.txt"
+./$BUILD_DIR/nc-scout search -R -n --sort kebabcase $TESTS_DIR/collisions > "$BUILD_DIR/sort-memory.txt"
+./$BUILD_DIR/nc-scout search -R -n --sort --sort-memory 1K kebabcase $TESTS_DIR/collisions > "$BUILD_DIR/sort-spilled.txt"
+# A run per line, merged over two levels.
+./$BUILD_DIR/nc-scout search -R -n --sort --sort-memory 0 kebabcase $TESTS_DIR/collisions > "$BUILD_DIR/sort-levels.txt"
+check_search "diff $BUILD_DIR/sort-expected.txt $BUILD_DIR/sort-memory.txt" 0
+check_search "diff $BUILD_DIR/sort-expected.txt $BUILD_DIR/sort-spilled.txt" 0
+check_search "diff $BUILD_DIR/sort-memory.txt $BUILD_DIR/sort-spilled.txt" 0
+check_search "diff $BUILD_DIR/sort-expected.txt $BUILD_DIR/sort-levels.txt" 0
+./$BUILD_DIR/nc-scout search -R camelcase $TESTS_DIR/camelcase_strict_matches | LC_ALL=C sort > "$BUILD_DIR/sort-merge-expected.txt"
+./$BUILD_DIR/nc-scout merge $BUILD_DIR/sort-2.part $BUILD_DIR/sort-1.part > "$BUILD_DIR/sort-merge.txt"
+check_search "diff $BUILD_DIR/sort-merge-expected.txt $BUILD_DIR/sort-merge.txt" 0
+# A name holding a newline stays whole when every line is spilled.
+mkdir -p "$BUILD_DIR/sort_newline"
+touch "$BUILD_DIR/sort_newline/b-name" "$BUILD_DIR/sort_newline/a-line"$'\n'"z-break" "$BUILD_DIR/sort_newline/m-name"
+./$BUILD_DIR/nc-scout search -n --sort snakecase $BUILD_DIR/sort_newline > "$BUILD_DIR/sort-newline-memory.txt"
+./$BUILD_DIR/nc-scout search -n --sort --sort-memory 0 snakecase $BUILD_DIR/sort_newline > "$BUILD_DIR/sort-newline-spilled.txt"
+check_search "cat $BUILD_DIR/sort-newline-spilled.txt" 4
+check_search "diff $BUILD_DIR/sort-newline-memory.txt $BUILD_DIR/sort-newline-spilled.txt" 0
+printf "\n"
+
+printf "${ORANGE}Owner tests:${RESET}\n"
+check_search "./$BUILD_DIR/nc-scout search -R -n --show-owner snakecase $TESTS_DIR/collisions" 50
+check_analyze "./$BUILD_DIR/nc-scout analyze -R --by-owner snakecase $TESTS_DIR/collisions" 54.545
+check_search "./$BUILD_DIR/nc-scout analyze -R --by-owner kebabcase $TESTS_DIR/kebabcase_strict_matches" 8
+printf "\n"
+
+printf "${ORANGE}Scan tests:${RESET}\n"
+check_search "./$BUILD_DIR/nc-scout scan -R -n snakecase $TESTS_DIR/collisions" 57
+check_analyze "./$BUILD_DIR/nc-scout scan -R -n snakecase $TESTS_DIR/collisions" 54.545
+check_analyze "./$BUILD_DIR/nc-scout scan -R --policy tests/policy.conf $TESTS_DIR/snakecase_strict_matches" 100.000
+# A scan lists symlinks as a search does, but leaves them out of its totals as an analyze does.
+mkdir -p "$BUILD_DIR/scan_links"
+touch "$BUILD_DIR/scan_links/Bad-Name" "$BUILD_DIR/scan_links/good_name"
+ln -sf Bad-Name "$BUILD_DIR/scan_links/Link-Two"
+./$BUILD_DIR/nc-scout search -n snakecase $BUILD_DIR/scan_links > "$BUILD_DIR/scan_links_search.txt"
+./$BUILD_DIR/nc-scout scan -n snakecase $BUILD_DIR/scan_links | sed '/^$/,$d' > "$BUILD_DIR/scan_links_scan.txt"
+check_search "cat $BUILD_DIR/scan_links_scan.txt" 2
+check_search "diff $BUILD_DIR/scan_links_search.txt $BUILD_DIR/scan_links_scan.txt" 0
+check_analyze "./$BUILD_DIR/nc-scout scan -n snakecase $BUILD_DIR/scan_links" 50.000
+printf "\n"
+
+printf "${ORANGE}Kernel tests:${RESET}\n"
+check_search "./$BUILD_DIR/nc-scout search -R -f snakecase $TESTS_DIR/collisions" 60
+check_search "./$BUILD_DIR/nc-scout search -R -n -f snakecase $TESTS_DIR/collisions" 50
+check_search "./$BUILD_DIR/nc-scout search -R -n -f camelcase $TESTS_DIR/camelcase_strict_matches" 0
+printf "\n"
+
+printf "${ORANGE}Pipeline tests:${RESET}\n"
+check_search "./$BUILD_DIR/nc-scout search -R --pipeline camelcase $TESTS_DIR/camelcase_strict_matches" 100
+check_search "./$BUILD_DIR/nc-scout search -R -n -f --pipeline kebabcase $TESTS_DIR/camelcase_strict_matches" 100
+check_search "./$BUILD_DIR/nc-scout search -R --pipeline --policy tests/policy.conf $TESTS_DIR/snakecase_strict_matches" 100
+printf "\n"
+
+printf "${ORANGE}Component tests:${RESET}\n"
+check_search "./$BUILD_DIR/nc-scout search -R --check-components kebabcase $TESTS_DIR/collisions" 4
+check_search "./$BUILD_DIR/nc-scout search -R -n --check-components kebabcase $TESTS_DIR/collisions" 106
+check_search "./$BUILD_DIR/nc-scout search -R --check-components snakecase $TESTS_DIR/snakecase_strict_matches" 100
+printf "\n"
+
+printf "${ORANGE}Locate database tests:${RESET}\n"
+# /nc-scout-locate holds fooBar.txt, foo_bar.txt, other_dir/ and someDir/, which holds
+# nestedFile.c and nested_file.c. /elsewhere/ignoredFile is outside of the location.
+dir_header='\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0'
+printf "\0mlocate\0\0\0\0\0\0\0\0/\0" > "$BUILD_DIR/mlocate.db"
+printf "$dir_header/nc-scout-locate\0\0fooBar.txt\0\0foo_bar.txt\0\1other_dir\0\1someDir\0\2" >> "$BUILD_DIR/mlocate.db"
+printf "$dir_header/elsewhere\0\0ignoredFile\0\2" >> "$BUILD_DIR/mlocate.db"
+printf "$dir_header/nc-scout-locate/someDir\0\0nestedFile.c\0\0nested_file.c\0\2" >> "$BUILD_DIR/mlocate.db"
+printf "$dir_header/nc-scout-locate/other_dir\0\2" >> "$BUILD_DIR/mlocate.db"
+# The same paths front-coded: each starts with the change to the length of the shared prefix.
+printf "\0LOCATE02\0\0/elsewhere\0\012/ignoredFile\0\367nc-scout-locate\0\017/fooBar.txt\0" > "$BUILD_DIR/locate02.db"
+printf "\004_bar.txt\0\375other_dir\0\0someDir\0\007/nestedFile.c\0\007_file.c\0" >> "$BUILD_DIR/locate02.db"
+check_search "./$BUILD_DIR/nc-scout search -R --locate-db $BUILD_DIR/mlocate.db snakecase /nc-scout-locate" 3
+check_search "./$BUILD_DIR/nc-scout search --locate-db $BUILD_DIR/mlocate.db snakecase /nc-scout-locate/" 2
+check_search "./$BUILD_DIR/nc-scout search -R -n --type d --locate-db $BUILD_DIR/mlocate.db snakecase /nc-scout-locate" 1
+check_analyze "./$BUILD_DIR/nc-scout analyze -R --locate-db $BUILD_DIR/mlocate.db snakecase /nc-scout-locate" 50.000
+check_search "./$BUILD_DIR/nc-scout search -R -f --locate-db $BUILD_DIR/locate02.db snakecase /nc-scout-locate" 3
+check_analyze "./$BUILD_DIR/nc-scout analyze -R --locate-db $BUILD_DIR/locate02.db camelcase /nc-scout-locate" 50.000
+# The first path cannot share 5 bytes with the empty path before it.
+printf "\0LOCATE02\0\005/nc-scout-locate\0" > "$BUILD_DIR/corrupt.db"
+./$BUILD_DIR/nc-scout search -R --locate-db $BUILD_DIR/corrupt.db snakecase /nc-scout-locate > "$BUILD_DIR/corrupt.txt"
+check_search "grep -x Error:.*corrupt.db.*corrupt\. $BUILD_DIR/corrupt.txt" 1
+printf "\n"
+
+printf "${ORANGE}Identifier tests:${RESET}\n"
+check_search "./$BUILD_DIR/nc-scout lint-identifiers snakecase tests/lint" 20
+check_analyze "./$BUILD_DIR/nc-scout lint-identifiers snakecase tests/lint" 64.286
+check_analyze "./$BUILD_DIR/nc-scout lint-identifiers -q -j 2 --macros constantcase snakecase tests/lint" 67.857
+printf "\n"
+
 printf "\nTesting completed. %s/%s tests were successful.\n\n" "$tests_passed" "$tests_executed"
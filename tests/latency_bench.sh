@@ -0,0 +1,99 @@
+#!/usr/bin/env bash
+
+# Copyright (c) 2024-2025 Josh Hayden (@BlinkDynamo)
+
+# This file should only be executed by the Makefile because it defines these variables.
+if [ -z "${BUILD_DIR}" ] && [ -z "${TESTS_DIR}" ]; then
+    printf "%s\n%s\n" \
+           "Error: latency_bench.sh is a child script of the Makefile." \
+           "It should not be executed manually."
+    exit 1
+fi
+
+#----------------------------------------------------------------------------------------------#
+# Definitions 
+#----------------------------------------------------------------------------------------------#
+ORANGE="\033[0;33m"
+RESET="\033[0m"
+
+# The shape of the generated tree, and the latency every call into it is given.
+LATENCY_US="${LATENCY_US:-500}"
+JITTER_US="${JITTER_US:-250}"
+BENCH_FANOUT="${BENCH_FANOUT:-6}"
+BENCH_DEPTH="${BENCH_DEPTH:-3}"
+BENCH_FILES="${BENCH_FILES:-20}"
+
+BENCH_TREE="${BUILD_DIR}/bench/tree-${BENCH_FANOUT}-${BENCH_DEPTH}-${BENCH_FILES}"
+SHIM="${BUILD_DIR}/latency-shim.so"
+
+# Fills a directory with BENCH_FILES files, half snake_case and half camelCase, then recurses
+# into BENCH_FANOUT subdirectories until BENCH_DEPTH.
+build_bench_directory()
+{
+    local cwd="$1"      # The directory to fill.
+    local depth="$2"    # The depth of cwd below the tree.
+
+    mkdir -p "${cwd}"
+    local files=()
+    for i in $(seq 1 "${BENCH_FILES}"); do
+        if (( i % 2 )); then
+            files+=("${cwd}/data_file_${i}.txt")
+        else
+            files+=("${cwd}/dataFile${i}.txt")
+        fi
+    done
+    touch "${files[@]}"
+
+    if (( depth < BENCH_DEPTH )); then
+        for i in $(seq 1 "${BENCH_FANOUT}"); do
+            build_bench_directory "${cwd}/sub_dir_${i}" $(( depth + 1 ))
+        done
+    fi
+}
+
+# Runs test_command with the shim loaded, printing its wall time and the calls it made.
+function bench_command()
+{
+    local test_command="$1"     # The command to time, its output is discarded.
+
+    local report
+    local seconds
+    report=$(mktemp)
+    TIMEFORMAT="%R"
+    seconds=$( { time SHIM_LATENCY_US="${LATENCY_US}" SHIM_JITTER_US="${JITTER_US}" \
+                      SHIM_ROOT="${abs_bench_tree}" LD_PRELOAD="./${SHIM}" \
+                      ${test_command} > /dev/null 2> "${report}"; } 2>&1 )
+
+    printf "%8ss  %s\n" "${seconds}" "${test_command}"
+    printf "           %s\n" "$(grep "^latency-shim:" "${report}")"
+    rm -f "${report}"
+}
+
+#----------------------------------------------------------------------------------------------#
+# Benchmark Execution
+#----------------------------------------------------------------------------------------------#
+if [ -d "${BENCH_TREE}" ]; then
+    printf "\nBenchmark tree '%s' has already been built.\n" "${BENCH_TREE}"
+else
+    build_bench_directory "${BENCH_TREE}" 0
+    printf "\nBuilt benchmark tree '%s'.\n" "${BENCH_TREE}"
+fi
+abs_bench_tree=$(realpath "${BENCH_TREE}")
+
+printf "%s directories and %s files, %sus latency with %sus jitter per call.\n\n" \
+       "$(find "${BENCH_TREE}" -type d | wc -l)" "$(find "${BENCH_TREE}" -type f | wc -l)" \
+       "${LATENCY_US}" "${JITTER_US}"
+
+printf "${ORANGE}Search:${RESET}\n"
+bench_command "./$BUILD_DIR/nc-scout search -R snakecase ${abs_bench_tree}"
+bench_command "./$BUILD_DIR/nc-scout search -R -n snakecase ${abs_bench_tree}"
+bench_command "./$BUILD_DIR/nc-scout search -R --inode-order snakecase ${abs_bench_tree}"
+bench_command "./$BUILD_DIR/nc-scout search -R --pipeline snakecase ${abs_bench_tree}"
+bench_command "./$BUILD_DIR/nc-scout search -R -n --show-owner snakecase ${abs_bench_tree}"
+printf "\n"
+
+printf "${ORANGE}Analyze:${RESET}\n"
+bench_command "./$BUILD_DIR/nc-scout analyze -R snakecase ${abs_bench_tree}"
+bench_command "./$BUILD_DIR/nc-scout analyze -R --stats-detail snakecase ${abs_bench_tree}"
+bench_command "./$BUILD_DIR/nc-scout analyze -R --by-owner snakecase ${abs_bench_tree}"
+printf "\n"
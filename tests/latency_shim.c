@@ -0,0 +1,270 @@
+/**********************************************************************************************
+*
+*   latency_shim - LD_PRELOAD shim that makes a local tree answer like a remote mount.
+*
+*   LICENSE: zlib/libpng
+*
+*   Copyright (c) 2024-2025 Josh Hayden (@BlinkDynamo)
+*
+*   This software is provided ‘as-is’, without any express or implied
+*   warranty. In no event will the authors be held liable for any damages
+*   arising from the use of this software.
+*
+*   Permission is granted to anyone to use this software for any purpose,
+*   including commercial applications, and to alter it and redistribute it
+*   freely, subject to the following restrictions:
+*
+*   1. The origin of this software must not be misrepresented; you must not
+*   claim that you wrote the original software. If you use this software
+*   in a product, an acknowledgment in the product documentation would be
+*   appreciated but is not required.
+*
+*   2. Altered source versions must be plainly marked as such, and must not be
+*   misrepresented as being the original software.
+*
+*   3. This notice may not be removed or altered from any source
+*   distribution.
+*
+*
+*   ---------------------------------------- OVERVIEW ---------------------------------------
+*
+*   Loaded with LD_PRELOAD, wraps the calls nc-scout reads a tree with (opendir(), open(),
+*   openat(), getdents64() and statx()) and sleeps before each one that reaches into
+*   SHIM_ROOT, so a traversal of a local tree pays the latency of a remote filesystem. Every
+*   wrapped call is counted, and the counts are printed to stderr when the process exits.
+*
+*   Environment:
+*
+*   SHIM_LATENCY_US     Microseconds added to every call (default 0, counting only).
+*   SHIM_JITTER_US      Each delay is moved up to this many microseconds either way.
+*   SHIM_ROOT           Only calls on paths below this directory, or on directories opened
+*                       below it, are delayed (default: every call).
+*   SHIM_SEED           Seeds the jitter (default 1), so runs can be repeated exactly.
+*
+*   Build: cc -O2 -fPIC -shared tests/latency_shim.c -o latency-shim.so -ldl
+*
+*********************************************************************************************/
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif // _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <dlfcn.h>
+#include <sys/stat.h>
+
+// Descriptors below this are tracked as being below SHIM_ROOT, any others are always delayed.
+#define TRACKED_FDS 65536
+
+enum ShimCall {
+    SHIM_OPENDIR,
+    SHIM_OPEN,
+    SHIM_OPENAT,
+    SHIM_GETDENTS64,
+    SHIM_STATX,
+    SHIM_N_CALLS
+};
+
+static const char *call_names[SHIM_N_CALLS] = {"opendir", "open", "openat", "getdents64", "statx"};
+
+static DIR *(*real_opendir)(const char *);
+static int (*real_open)(const char *, int, ...);
+static int (*real_openat)(int, const char *, int, ...);
+static ssize_t (*real_getdents64)(int, void *, size_t);
+static int (*real_statx)(int, const char *, int, unsigned int, struct statx *);
+
+static uint64_t latency_ns;
+static uint64_t jitter_ns;
+static uint64_t seed = 1;
+static const char *root;
+static size_t root_len;
+
+// Updated with __atomic builtins, as the pipeline and throttle can call from several threads.
+static uint64_t calls[SHIM_N_CALLS];
+static uint64_t delayed_calls;
+static uint64_t delayed_ns;
+static unsigned char tracked[TRACKED_FDS];
+
+static uint64_t env_number (const char *name, uint64_t fallback)
+{
+    const char *value = getenv(name);
+    return (value != NULL && *value != '\0') ? strtoull(value, NULL, 10) : fallback;
+}
+
+static void resolve (void)
+{
+    // dlsym() returns an object pointer, so it is stored through one to stay within ISO C.
+    *(void **)&real_opendir = dlsym(RTLD_NEXT, "opendir");
+    *(void **)&real_open = dlsym(RTLD_NEXT, "open");
+    *(void **)&real_openat = dlsym(RTLD_NEXT, "openat");
+    *(void **)&real_getdents64 = dlsym(RTLD_NEXT, "getdents64");
+    *(void **)&real_statx = dlsym(RTLD_NEXT, "statx");
+}
+
+__attribute__((constructor)) static void shim_init (void)
+{
+    resolve();
+    latency_ns = env_number("SHIM_LATENCY_US", 0) * 1000;
+    jitter_ns = env_number("SHIM_JITTER_US", 0) * 1000;
+    seed = env_number("SHIM_SEED", 1);
+    root = getenv("SHIM_ROOT");
+    if (root != NULL && *root == '\0') {
+        root = NULL;
+    }
+    root_len = (root != NULL) ? strlen(root) : 0;
+    while (root_len > 1 && root[root_len - 1] == '/')
+    {
+        root_len--;
+    }
+}
+
+__attribute__((destructor)) static void shim_report (void)
+{
+    fprintf(stderr, "latency-shim:");
+    for (int i = 0; i < SHIM_N_CALLS; i++)
+    {
+        fprintf(stderr, " %s %llu", call_names[i], (unsigned long long)calls[i]);
+    }
+    fprintf(stderr, ", %llu delayed for %.3f s\n", (unsigned long long)delayed_calls, 
+            (double)delayed_ns / 1e9);
+}
+
+static bool below_root (const char *path)
+{
+    if (root == NULL) {
+        return true;
+    }
+    return strncmp(path, root, root_len) == 0 && 
+           (path[root_len] == '/' || path[root_len] == '\0' || root_len == 1);
+}
+
+static bool fd_below_root (int fd)
+{
+    if (root == NULL || fd < 0 || fd >= TRACKED_FDS) {
+        return root == NULL || fd == AT_FDCWD;
+    }
+    return __atomic_load_n(&tracked[fd], __ATOMIC_RELAXED);
+}
+
+static void track (int fd, bool is_below_root)
+{
+    // Every new descriptor is (re)marked, so a number reused after close() is not stale.
+    if (fd >= 0 && fd < TRACKED_FDS) {
+        __atomic_store_n(&tracked[fd], is_below_root, __ATOMIC_RELAXED);
+    }
+}
+
+static bool at_below_root (int dirfd, const char *path)
+{
+    // An absolute path ignores dirfd, and a relative one is resolved from it.
+    if (*path == '/') {
+        return below_root(path);
+    }
+    return (dirfd == AT_FDCWD) ? root == NULL : fd_below_root(dirfd);
+}
+
+static void delay (enum ShimCall call, bool is_below_root)
+{
+    // Counts a call, then sleeps for the latency, moved by a jitter drawn with splitmix64.
+    uint64_t n = __atomic_fetch_add(&calls[call], 1, __ATOMIC_RELAXED);
+    if (!is_below_root || (latency_ns == 0 && jitter_ns == 0)) {
+        return;
+    }
+    uint64_t z = seed + (n * SHIM_N_CALLS + call + 1) * 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    z ^= z >> 31;
+    uint64_t ns = latency_ns;
+    if (jitter_ns != 0) {
+        uint64_t offset = z % (2 * jitter_ns + 1);
+        ns = (ns + offset > jitter_ns) ? ns + offset - jitter_ns : 0;
+    }
+    __atomic_fetch_add(&delayed_calls, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&delayed_ns, ns, __ATOMIC_RELAXED);
+    struct timespec sleep_time = {.tv_sec = (time_t)(ns / 1000000000), 
+                                  .tv_nsec = (long)(ns % 1000000000)};
+    while (nanosleep(&sleep_time, &sleep_time) != 0)
+    {
+        // Interrupted by a signal, so sleep for what is left.
+    }
+}
+
+DIR *opendir (const char *path)
+{
+    if (real_opendir == NULL) {
+        resolve();
+    }
+    bool is_below_root = below_root(path);
+    delay(SHIM_OPENDIR, is_below_root);
+    DIR *dir = real_opendir(path);
+    if (dir != NULL) {
+        track(dirfd(dir), is_below_root);
+    }
+    return dir;
+}
+
+int open (const char *path, int flags, ...)
+{
+    if (real_open == NULL) {
+        resolve();
+    }
+    mode_t mode = 0;
+    if (flags & (O_CREAT | O_TMPFILE)) {
+        va_list args;
+        va_start(args, flags);
+        mode = va_arg(args, mode_t);
+        va_end(args);
+    }
+    bool is_below_root = at_below_root(AT_FDCWD, path);
+    delay(SHIM_OPEN, is_below_root);
+    int fd = real_open(path, flags, mode);
+    track(fd, is_below_root);
+    return fd;
+}
+
+int openat (int dirfd, const char *path, int flags, ...)
+{
+    if (real_openat == NULL) {
+        resolve();
+    }
+    mode_t mode = 0;
+    if (flags & (O_CREAT | O_TMPFILE)) {
+        va_list args;
+        va_start(args, flags);
+        mode = va_arg(args, mode_t);
+        va_end(args);
+    }
+    bool is_below_root = at_below_root(dirfd, path);
+    delay(SHIM_OPENAT, is_below_root);
+    int fd = real_openat(dirfd, path, flags, mode);
+    track(fd, is_below_root);
+    return fd;
+}
+
+ssize_t getdents64 (int fd, void *buffer, size_t length)
+{
+    if (real_getdents64 == NULL) {
+        resolve();
+    }
+    delay(SHIM_GETDENTS64, fd_below_root(fd));
+    return real_getdents64(fd, buffer, length);
+}
+
+int statx (int dirfd, const char *path, int flags, unsigned int mask, struct statx *buffer)
+{
+    if (real_statx == NULL) {
+        resolve();
+    }
+    // An empty path with AT_EMPTY_PATH is a statx() of dirfd itself.
+    bool is_below_root = (*path == '\0') ? fd_below_root(dirfd) : at_below_root(dirfd, path);
+    delay(SHIM_STATX, is_below_root);
+    return real_statx(dirfd, path, flags, mask, buffer);
+}
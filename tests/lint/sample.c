@@ -0,0 +1,25 @@
+#define MAX_ITEMS 16
+#define maxSize 32
+
+struct item_list {
+    int count;
+    char *itemNames[MAX_ITEMS];
+};
+
+typedef struct item_list ItemList;
+
+static int total_count = 0;
+
+static int add_item (struct item_list *list, const char *name)
+{
+    // Comments are skipped: int fakeName = 1;
+    const char *label = "and so are strings: int fakeName = 2;";
+    list->itemNames[list->count++] = (char *)name;
+    total_count += 1;
+    return (int)(label != NULL);
+}
+
+int getTotal (void)
+{
+    return total_count;
+}
@@ -0,0 +1,14 @@
+"""Docstrings are skipped: fakeName = 1"""
+
+MAX_ITEMS = 16
+
+
+class item_list:
+    def __init__(self, itemNames):
+        self.names = itemNames
+
+    def addItem(self, name):
+        # Comments are skipped: fakeName = 2
+        total = len(self.names)
+        for index in range(total):
+            print("and so are strings: fakeName = %d" % index)
@@ -0,0 +1,19 @@
+#!/usr/bin/env bash
+
+# Comments are skipped: fakeName=1
+max_items=16
+itemCount=0
+
+add_item() {
+    local name="$1"
+    echo 'and so are strings: fakeName=2'
+    cat <<EOT
+heredocs too: fakeName=3
+EOT
+}
+
+function listItems {
+    for item in "$@"; do
+        add_item "$item"
+    done
+}
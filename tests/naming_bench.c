@@ -0,0 +1,386 @@
+/**********************************************************************************************
+*
+*   naming_bench - Microbenchmark and differential fuzzer for the naming conventions.
+*
+*   LICENSE: zlib/libpng
+*
+*   Copyright (c) 2024-2025 Josh Hayden (@BlinkDynamo)
+*
+*   This software is provided ‘as-is’, without any express or implied
+*   warranty. In no event will the authors be held liable for any damages
+*   arising from the use of this software.
+*
+*   Permission is granted to anyone to use this software for any purpose,
+*   including commercial applications, and to alter it and redistribute it
+*   freely, subject to the following restrictions:
+*
+*   1. The origin of this software must not be misrepresented; you must not
+*   claim that you wrote the original software. If you use this software
+*   in a product, an acknowledgment in the product documentation would be
+*   appreciated but is not required.
+*
+*   2. Altered source versions must be plainly marked as such, and must not be
+*   misrepresented as being the original software.
+*
+*   3. This notice may not be removed or altered from any source
+*   distribution.
+*
+*   ---------------------------------------- OVERVIEW ---------------------------------------
+*
+*   Times every naming convention, strictly and leniently, over a corpus of filenames, and
+*   checks every alternative matcher in Matchers[] against naming_match_regex() (the oracle),
+*   failing on the first disagreement. Only src/naming.c is linked, and no filesystem I/O is
+*   done other than reading the corpus.
+*
+*   Usage: naming-bench [--corpus FILE] [--count N] [--seed N] [--rounds N]
+*
+*   With --corpus, FILE is read as one filename per line, such as the output of
+*   `find / -printf '%f\n'`. Otherwise --count filenames are generated from --seed.
+*
+*********************************************************************************************/
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif // _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <regex.h>
+
+#include "naming.h"
+
+#define DEFAULT_COUNT   200000
+#define DEFAULT_SEED    1
+#define DEFAULT_ROUNDS  3
+#define MAX_NAME_LEN    255
+
+// An alternative to naming_match_regex(). init() is called once per convention and mode.
+struct Matcher {
+    const char *name;
+    bool (*init)(void **state, const char *convention, const char *expression, bool strict);
+    bool (*match)(void *state, const char *filename);
+    bool ascii_only;    // Only compared against the oracle on pure ASCII names.
+};
+
+// The state of the native matchers: the convention index and mode.
+struct NativeState {
+    int convention;
+    bool strict;
+};
+
+static bool nosub_init (void **state, const char *convention, const char *expression, bool strict)
+{
+    (void)convention;
+    (void)strict;
+    regex_t *regex = malloc(sizeof(regex_t));
+    if (regex == NULL || regcomp(regex, expression, REG_EXTENDED | REG_NOSUB) != 0) {
+        free(regex);
+        return false;
+    }
+    *state = regex;
+    return true;
+}
+
+static bool nosub_match (void *state, const char *filename)
+{
+    return regexec(state, filename, 0, NULL, 0) == 0;
+}
+
+static bool native_init (void **state, const char *convention, const char *expression, bool strict)
+{
+    (void)expression;
+    struct NativeState *native = malloc(sizeof(struct NativeState));
+    if (native == NULL) {
+        return false;
+    }
+    native->convention = 0;
+    while (strcmp(naming_get_convention_name(native->convention), convention) != 0)
+    {
+        native->convention++;
+    }
+    native->strict = strict;
+    *state = native;
+    return true;
+}
+
+static bool native_match (void *state, const char *filename)
+{
+    struct NativeState *native = state;
+    return naming_match_native(native->convention, native->strict, false, filename);
+}
+
+static bool native_unicode_match (void *state, const char *filename)
+{
+    struct NativeState *native = state;
+    return naming_match_native(native->convention, native->strict, true, filename);
+}
+
+static struct Matcher Matchers[] = {
+    {"regex-nosub", nosub_init, nosub_match, false},
+    {"native", native_init, native_match, false},
+    {"native-utf8", native_init, native_unicode_match, true},
+};
+
+static bool is_ascii_name (const char *name)
+{
+    for (; *name != '\0'; name++)
+    {
+        if ((unsigned char)*name >= 0x80) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static const int n_matchers = sizeof(Matchers) / sizeof(Matchers[0]);
+
+static uint64_t rng_state;
+
+static uint64_t rng_next (void)
+{
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 0x2545f4914f6cdd1dULL;
+}
+
+static const char *pick (const char **options, size_t n_options)
+{
+    return options[rng_next() % n_options];
+}
+
+static char *generate_name (void)
+/**********************************************************************************************
+*
+*   Generates a filename resembling real-world ones: a few words joined in a random style,
+*   sometimes with a leading period, digits, an extension, or stray characters mixed in to
+*   reach the edges of the expressions.
+*
+**********************************************************************************************/
+{
+    static const char *words[] = {
+        "index", "main", "readme", "make", "file", "test", "config", "data", "init", "util",
+        "a", "x", "v2", "2024", "backup", "IMG", "final", "new", "ui", "api", "Q", "0",
+    };
+    static const char *separators[] = {"", "", "_", "-", ".", " ", "__", "_-"};
+    static const char *extensions[] = {
+        "", "", "", ".txt", ".c", ".h", ".JPEG", ".tar.gz", ".md", ".7z", ".", ".py3", "..",
+    };
+    static const char stray[] = "._- +~#@()[]{}'AZaz09\xc3\xbc";
+
+    char name[MAX_NAME_LEN + 1];
+    size_t len = 0;
+    int style = rng_next() % 5;
+    const char *separator = pick(separators, sizeof(separators) / sizeof(separators[0]));
+    int n_words = 1 + rng_next() % 4;
+
+    if (rng_next() % 8 == 0) {
+        name[len++] = '.';
+    }
+    for (int i = 0; i < n_words && len < MAX_NAME_LEN - 32; i++)
+    {
+        const char *word = pick(words, sizeof(words) / sizeof(words[0]));
+        if (i > 0) {
+            len += snprintf(name + len, sizeof(name) - len, "%s", separator);
+        }
+        for (size_t j = 0; word[j] != '\0'; j++)
+        {
+            char c = word[j];
+            switch (style)
+            {
+                case 0: c = (c >= 'A' && c <= 'Z') ? c + 32 : c; break;        // lower
+                case 1: c = (c >= 'a' && c <= 'z') ? c - 32 : c; break;        // upper
+                case 2:                                                         // camel
+                case 3:                                                         // pascal
+                    if (j == 0 && (i > 0 || style == 3) && c >= 'a' && c <= 'z') {
+                        c -= 32;
+                    }
+                    break;
+                default: break;                                                 // as is
+            }
+            name[len++] = c;
+        }
+    }
+    if (rng_next() % 6 == 0) {
+        name[len++] = stray[rng_next() % (sizeof(stray) - 1)];
+    }
+    len += snprintf(name + len, sizeof(name) - len, "%s", 
+                    pick(extensions, sizeof(extensions) / sizeof(extensions[0])));
+    name[len] = '\0';
+    return strdup(name);
+}
+
+static char **load_corpus (const char *corpus_path, size_t *n_names)
+{
+    FILE *corpus = fopen(corpus_path, "r");
+    if (corpus == NULL) {
+        printf("Error: cannot open corpus '%s'.\n", corpus_path);
+        return NULL;
+    }
+    char **names = NULL;
+    size_t capacity = 0;
+    char *line = NULL;
+    size_t line_capacity = 0;
+    ssize_t line_len;
+    *n_names = 0;
+    while ((line_len = getline(&line, &line_capacity, corpus)) != -1)
+    {
+        if (line_len > 0 && line[line_len - 1] == '\n') {
+            line[--line_len] = '\0';
+        }
+        if (line_len == 0) {
+            continue;
+        }
+        if (*n_names == capacity) {
+            capacity = (capacity == 0) ? 4096 : capacity * 2;
+            names = realloc(names, capacity * sizeof(char *));
+        }
+        names[(*n_names)++] = strdup(line);
+    }
+    free(line);
+    fclose(corpus);
+    return names;
+}
+
+static double seconds_between (struct timespec start, struct timespec end)
+{
+    return (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+int main (int argc, char *argv[])
+{
+    const char *corpus_path = NULL;
+    size_t count = DEFAULT_COUNT;
+    int rounds = DEFAULT_ROUNDS;
+    rng_state = DEFAULT_SEED;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--corpus") == 0 && i + 1 < argc) {
+            corpus_path = argv[++i];
+        }
+        else if (strcmp(argv[i], "--count") == 0 && i + 1 < argc) {
+            count = strtoul(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            rng_state = strtoull(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--rounds") == 0 && i + 1 < argc) {
+            rounds = atoi(argv[++i]);
+        }
+        else {
+            printf("Usage: %s [--corpus FILE] [--count N] [--seed N] [--rounds N]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (rng_state == 0) {
+        rng_state = DEFAULT_SEED;
+    }
+
+    size_t n_names = count;
+    char **names;
+    if (corpus_path != NULL) {
+        names = load_corpus(corpus_path, &n_names);
+        if (names == NULL) {
+            return EXIT_FAILURE;
+        }
+    }
+    else {
+        names = malloc(n_names * sizeof(char *));
+        for (size_t i = 0; i < n_names; i++)
+        {
+            names[i] = generate_name();
+        }
+    }
+    if (n_names == 0 || rounds < 1) {
+        printf("Error: nothing to benchmark.\n");
+        return EXIT_FAILURE;
+    }
+    printf("%zu names, %d rounds, best round reported in ns/name.\n\n", n_names, rounds);
+    printf("%-14s %-8s %-14s %10s %9s\n", "convention", "mode", "matcher", "ns/name", "matches");
+
+    bool *oracle = malloc(n_names * sizeof(bool));
+    for (int c = 0; naming_get_convention_name(c) != NULL; c++)
+    {
+        const char *convention = naming_get_convention_name(c);
+        for (int strict = 0; strict <= 1; strict++)
+        {
+            const char *expression;
+            regex_t regex;
+            if (!naming_set_expression(convention, &expression, strict) ||
+                !naming_compile_regex(&regex, expression)) {
+                return EXIT_FAILURE;
+            }
+
+            // The oracle: the matcher used by nc-scout itself.
+            size_t n_matches = 0;
+            double best = -1.0;
+            for (int r = 0; r < rounds; r++)
+            {
+                struct timespec start, end;
+                clock_gettime(CLOCK_MONOTONIC, &start);
+                for (size_t i = 0; i < n_names; i++)
+                {
+                    oracle[i] = naming_match_regex(regex, names[i]);
+                }
+                clock_gettime(CLOCK_MONOTONIC, &end);
+                double elapsed = seconds_between(start, end);
+                best = (best < 0.0 || elapsed < best) ? elapsed : best;
+            }
+            for (size_t i = 0; i < n_names; i++)
+            {
+                n_matches += oracle[i];
+            }
+            printf("%-14s %-8s %-14s %10.1f %9zu\n", convention, strict ? "strict" : "lenient",
+                   "regex", best * 1e9 / n_names, n_matches);
+
+            for (int m = 0; m < n_matchers; m++)
+            {
+                void *state = NULL;
+                if (!Matchers[m].init(&state, convention, expression, strict)) {
+                    printf("Error: matcher '%s' failed to initialize for %s.\n", Matchers[m].name,
+                           convention);
+                    return EXIT_FAILURE;
+                }
+
+                // Check every answer before timing, stopping at the first disagreement.
+                for (size_t i = 0; i < n_names; i++)
+                {
+                    if (Matchers[m].ascii_only && !is_ascii_name(names[i])) {
+                        continue;
+                    }
+                    if (Matchers[m].match(state, names[i]) != oracle[i]) {
+                        printf("\nMismatch: matcher '%s' says %s for '%s' (%s %s), regex says %s.\n",
+                               Matchers[m].name, oracle[i] ? "false" : "true", names[i],
+                               strict ? "strict" : "lenient", convention,
+                               oracle[i] ? "true" : "false");
+                        return EXIT_FAILURE;
+                    }
+                }
+
+                best = -1.0;
+                volatile size_t sink = 0;
+                for (int r = 0; r < rounds; r++)
+                {
+                    struct timespec start, end;
+                    clock_gettime(CLOCK_MONOTONIC, &start);
+                    for (size_t i = 0; i < n_names; i++)
+                    {
+                        sink += Matchers[m].match(state, names[i]);
+                    }
+                    clock_gettime(CLOCK_MONOTONIC, &end);
+                    double elapsed = seconds_between(start, end);
+                    best = (best < 0.0 || elapsed < best) ? elapsed : best;
+                }
+                printf("%-14s %-8s %-14s %10.1f %9s\n", "", "", Matchers[m].name,
+                       best * 1e9 / n_names, Matchers[m].ascii_only ? "-" : "same");
+            }
+            regfree(&regex);
+        }
+    }
+    printf("\nAll matchers agree with regex on every name.\n");
+    return EXIT_SUCCESS;
+}
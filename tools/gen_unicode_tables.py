@@ -0,0 +1,67 @@
+#!/usr/bin/env python3
+
+# Copyright (c) 2024-2025 Josh Hayden (@BlinkDynamo)
+
+# Generates include/unicode_tables.h, the two-stage character class tables used by the
+# --unicode mode of src/naming.c. Run from the root of the repository:
+#
+#   python3 tools/gen_unicode_tables.py > include/unicode_tables.h
+#
+# Every code point is given one of four 2-bit classes, packed four to a byte:
+#
+#   0  OTHER     Not allowed in any convention body (punctuation, symbols, spaces, ...).
+#   1  LOWER     Lowercase letters (Ll).
+#   2  UPPER     Uppercase and titlecase letters (Lu, Lt).
+#   3  CASELESS  Decimal digits (Nd), letters without case (Lo, Lm) and combining marks
+#                (Mn, Mc). These behave like the digits 0-9 do in the ASCII conventions.
+#
+# Stage 1 maps the high bits of a code point (cp >> 8) to a block of stage 2, which holds the
+# classes of the 256 code points of that block. Identical blocks are shared.
+
+import sys
+import unicodedata
+
+BLOCK_SHIFT = 8
+BLOCK_SIZE = 1 << BLOCK_SHIFT
+N_CODE_POINTS = 0x110000
+CLASSES = {"Ll": 1, "Lu": 2, "Lt": 2, "Nd": 3, "Lo": 3, "Lm": 3, "Mn": 3, "Mc": 3}
+
+
+def block_bytes(first):
+    packed = bytearray(BLOCK_SIZE // 4)
+    for offset in range(BLOCK_SIZE):
+        cls = CLASSES.get(unicodedata.category(chr(first + offset)), 0)
+        packed[offset // 4] |= cls << ((offset % 4) * 2)
+    return bytes(packed)
+
+
+def main():
+    stage1 = []
+    blocks = {}
+    for first in range(0, N_CODE_POINTS, BLOCK_SIZE):
+        data = block_bytes(first)
+        if data not in blocks:
+            blocks[data] = len(blocks)
+        stage1.append(blocks[data])
+
+    stage1_type = "uint8_t" if len(blocks) <= 256 else "uint16_t"
+    stage2 = b"".join(sorted(blocks, key=blocks.get))
+
+    out = sys.stdout
+    out.write("// Generated by tools/gen_unicode_tables.py from Unicode %s. Do not edit.\n\n"
+              % unicodedata.unidata_version)
+    out.write("#ifndef UNICODE_TABLES_H\n#define UNICODE_TABLES_H\n\n#include <stdint.h>\n\n")
+    out.write("#define UNICODE_TABLES_VERSION \"%s\"\n" % unicodedata.unidata_version)
+    out.write("#define UNICODE_BLOCK_SHIFT %d\n\n" % BLOCK_SHIFT)
+    out.write("static const %s unicode_stage1[%d] = {\n" % (stage1_type, len(stage1)))
+    for i in range(0, len(stage1), 16):
+        out.write("    " + ", ".join("%d" % v for v in stage1[i:i + 16]) + ",\n")
+    out.write("};\n\n")
+    out.write("static const uint8_t unicode_stage2[%d] = {\n" % len(stage2))
+    for i in range(0, len(stage2), 16):
+        out.write("    " + ", ".join("0x%02x" % v for v in stage2[i:i + 16]) + ",\n")
+    out.write("};\n\n#endif // UNICODE_TABLES_H\n")
+
+
+if __name__ == "__main__":
+    main()